@@ -2,9 +2,22 @@
 
 import subprocess
 import argparse
+import hashlib
+import os
 import shutil
+import struct
 from pathlib import Path
 
+# Indexed bundle layout, read by src/common/bundle.cpp.  All integers are
+# little endian, payloads start on page boundaries and identical files are
+# stored once.
+BUNDLE_MAGIC = b'VTDBND01'
+BUNDLE_VERSION = 1
+BUNDLE_PAGE = 4096
+BUNDLE_HEADER = struct.Struct('<8sIIIIQQQQQ')  # magic, version, page, entries, blobs, 3 offsets, strings size, file size
+BUNDLE_ENTRY = struct.Struct('<IIII')          # path offset, path size, blob, reserved
+BUNDLE_BLOB = struct.Struct('<QQ32s')          # payload offset, size, sha256
+
 def check_ar_utility():
     if not shutil.which('ar'):
         print("Error: 'ar' utility not found. Please install binutils package.")
@@ -16,6 +29,108 @@ def get_archive_contents(archive_path):
     result = subprocess.run(['ar', 't', str(archive_path)], capture_output=True, text=True)
     return set(f.strip() for f in result.stdout.strip().split('\n') if f.strip()) if result.returncode == 0 else set()
 
+def get_bundle_contents(bundle_path):
+    """Path -> sha256 of every entry of an existing bundle"""
+    if not bundle_path.exists():
+        return {}
+    data = bundle_path.read_bytes()
+    if len(data) < BUNDLE_HEADER.size or data[:8] != BUNDLE_MAGIC:
+        return {}
+    _, _, _, entry_count, blob_count, entries, blobs, strings, _, _ = BUNDLE_HEADER.unpack_from(data)
+    hashes = [BUNDLE_BLOB.unpack_from(data, blobs + i * BUNDLE_BLOB.size)[2] for i in range(blob_count)]
+    contents = {}
+    for i in range(entry_count):
+        path_offset, path_size, blob, _ = BUNDLE_ENTRY.unpack_from(data, entries + i * BUNDLE_ENTRY.size)
+        path = data[strings + path_offset:strings + path_offset + path_size].decode('utf-8')
+        contents[path] = hashes[blob]
+    return contents
+
+def align(offset, page=BUNDLE_PAGE):
+    return (offset + page - 1) // page * page
+
+def create_bundle(folder_path):
+    if not folder_path.exists():
+        print(f"Error: Folder {folder_path} does not exist")
+        return False, [], []
+
+    # Paths keep the tree, so files of the same name in different tests
+    # stay apart.  Sorted bytewise for the reader's binary search.
+    files = [f for f in folder_path.rglob('*') if f.is_file() and f.suffix not in ('.a', '.bundle')]
+    if not files:
+        print(f"Error: Folder {folder_path} has no files")
+        return False, [], []
+    entries = sorted((f.relative_to(folder_path).as_posix().encode('utf-8'), f) for f in files)
+
+    output_name = f"xrt_smi_{folder_path.name}.bundle"
+    output_path = folder_path / output_name
+    old_contents, bundle_existed = get_bundle_contents(output_path), output_path.exists()
+    print(f"{'Updating' if bundle_existed else 'Creating'} {output_name} from {len(files)} files...")
+
+    # One blob per distinct content
+    blob_index, blobs, entry_blobs = {}, [], []
+    for _, f in entries:
+        data = f.read_bytes()
+        digest = hashlib.sha256(data).digest()
+        if digest not in blob_index:
+            blob_index[digest] = len(blobs)
+            blobs.append((digest, data))
+        entry_blobs.append(blob_index[digest])
+
+    strings = b''.join(path for path, _ in entries)
+    entries_offset = BUNDLE_HEADER.size
+    blobs_offset = entries_offset + len(entries) * BUNDLE_ENTRY.size
+    strings_offset = blobs_offset + len(blobs) * BUNDLE_BLOB.size
+    offset = align(strings_offset + len(strings))
+    payload_offsets = []
+    for _, data in blobs:
+        payload_offsets.append(offset)
+        offset = align(offset + len(data))
+    file_size = payload_offsets[-1] + len(blobs[-1][1])
+
+    tmp_path = output_path.with_suffix('.bundle.tmp')
+    with open(tmp_path, 'wb') as out:
+        out.write(BUNDLE_HEADER.pack(BUNDLE_MAGIC, BUNDLE_VERSION, BUNDLE_PAGE, len(entries), len(blobs),
+                                     entries_offset, blobs_offset, strings_offset, len(strings), file_size))
+        path_offset = 0
+        for (path, _), blob in zip(entries, entry_blobs):
+            out.write(BUNDLE_ENTRY.pack(path_offset, len(path), blob, 0))
+            path_offset += len(path)
+        for (digest, data), payload_offset in zip(blobs, payload_offsets):
+            out.write(BUNDLE_BLOB.pack(payload_offset, len(data), digest))
+        out.write(strings)
+        for (_, data), payload_offset in zip(blobs, payload_offsets):
+            out.write(b'\0' * (payload_offset - out.tell()))
+            out.write(data)
+    os.replace(tmp_path, output_path)
+
+    stored = sum(len(data) for _, data in blobs)
+    total = sum(f.stat().st_size for _, f in entries)
+    print(f"✓ {'Updated' if bundle_existed else 'Created'}: {output_path}")
+    print(f"  {len(entries)} files in {len(blobs)} blobs, {total - stored} bytes shared, {file_size} bytes")
+
+    new_contents = {path.decode('utf-8'): digest for (path, _), digest in
+                    zip(entries, (blobs[b][0] for b in entry_blobs))}
+    added = sorted(set(new_contents) - set(old_contents))
+    removed = sorted(set(old_contents) - set(new_contents))
+    updated = sorted(p for p in new_contents if p in old_contents and old_contents[p] != new_contents[p])
+    if bundle_existed:
+        for files_list, symbol, label, emoji in [
+            (added, "+", "New files added", "➕"),
+            (removed, "-", "Files removed", "➖"),
+            (updated, "~", "Files updated", "🔄")
+        ]:
+            if files_list:
+                print(f"  {emoji} {label} ({len(files_list)}):")
+                [print(f"    {symbol} {file}") for file in files_list]
+
+        if not added and not removed and not updated:
+            print(f"  📄 No changes detected")
+        return True, added, updated
+    else:
+        print(f"  📦 Files added to new bundle ({len(new_contents)}):")
+        [print(f"    + {file}") for file in sorted(new_contents)]
+        return True, list(new_contents), []
+
 def create_archive(folder_path):
     if not folder_path.exists():
         print(f"Error: Folder {folder_path} does not exist")
@@ -23,7 +138,7 @@ def create_archive(folder_path):
     
     # Get all files recursively from the folder and its subdirectories, excluding .a files
     files = list(folder_path.rglob('*'))
-    files = [f for f in files if f.is_file() and f.suffix != '.a']
+    files = [f for f in files if f.is_file() and f.suffix not in ('.a', '.bundle')]
     
     if not files:
         print(f"Error: Folder {folder_path} has no files")
@@ -84,28 +199,33 @@ def create_archive(folder_path):
         return True, list(new_files_set), []
 
 def print_help():
-    print("""Archive Builder - Create .a archives from folders
+    print("""Archive Builder - Create .a archives or indexed bundles from folders
 
-USAGE: python build_archives.py [folders...]
+USAGE: python build_archives.py [--format ar|bundle] [folders...]
 ARGUMENTS: folders - List of folder names (default: all folders in current directory)
+OPTIONS: --format - ar (default) for flat ar archives, bundle for indexed bundles
 
 EXAMPLES:
     python build_archives.py          # Create archives for all folders
     python build_archives.py phx      # Create archive for specific folder
     python build_archives.py phx ve2  # Create archives for multiple folders
+    python build_archives.py --format bundle strx  # Create an indexed bundle
 
-OUTPUT: Archives created as xrt_smi_<foldername>.a""")
+OUTPUT: Archives created as xrt_smi_<foldername>.a, bundles as xrt_smi_<foldername>.bundle""")
 
 def main():
-    check_ar_utility()
     parser = argparse.ArgumentParser(add_help=False)
     parser.add_argument('-h', '--help', action='store_true')
+    parser.add_argument('--format', choices=['ar', 'bundle'], default='ar')
     parser.add_argument('folders', nargs='*', help='Folder names to create archives for')
     args = parser.parse_args()
     
     if args.help:
         print_help()
         return 0
+    if args.format == 'ar':
+        check_ar_utility()
+    suffix = 'a' if args.format == 'ar' else 'bundle'
     
     current_dir = Path(".")
     folder_names = args.folders or [d.name for d in current_dir.iterdir() if d.is_dir()]
@@ -123,12 +243,13 @@ def main():
     success, total_new, total_updated, archives_info = 0, 0, 0, []
     
     for folder in folders:
-        success_status, new_files, updated_files = create_archive(folder)
+        create = create_archive if args.format == 'ar' else create_bundle
+        success_status, new_files, updated_files = create(folder)
         if success_status:
             success += 1
             total_new += len(new_files)
             total_updated += len(updated_files)
-            archives_info.append((f"xrt_smi_{folder.name}.a", new_files, updated_files))
+            archives_info.append((f"xrt_smi_{folder.name}.{suffix}", new_files, updated_files))
         print()
     
     print("=" * 60)
@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Measures the cost of reconfiguring the AIE array with the recipes in
+ * archive/strx/aie_reconfig_overhead.  The reconfiguration ELF and the nop
+ * ELF, taken from the sibling latency/ test when the recipe directory lacks
+ * it, run in one hw_context over the same ifm/ofm/inter BOs, which are
+ * allocated and synced once.  Every sample runs --iterations runs of each,
+ * alternating which goes first like preempt does, and the difference of the
+ * mean run latencies is the reconfiguration overhead of that sample.
+ *
+ * Besides the overhead distribution the report shows how many back to back
+ * runs of one configuration it takes to keep reconfiguration below a share
+ * of the time: with overhead R and run time T, N runs per reconfiguration
+ * spend R / (R + N T) of the time reconfiguring.  The run time is the nop run
+ * and every --run-us value, e.g. the inference time of a model.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_elf.h"
+#include "experimental/xrt_module.h"
+#include "experimental/xrt_ext.h"
+
+#include "cmdline.h"
+#include "latency_histogram.h"
+#include "recipe.h"
+#include "results.h"
+#include "sample_stats.h"
+
+// Kernel and bound run of one of the two recipes
+struct reconfig_config
+{
+  xrt::kernel kernel;
+  xrt::run run;
+};
+
+// The recipes hold one kernel with its ctrlcode and one run each
+void
+check_recipe(const vtd::recipe &rcp, const std::string &fname)
+{
+  if (rcp.xclbin.empty() || rcp.kernels.size() != 1 || rcp.kernels[0].ctrlcode.empty() || rcp.runs.size() != 1)
+    throw std::runtime_error("Error: " + fname + " must have an xclbin, one kernel with ctrlcode and one run\n");
+}
+
+reconfig_config
+load_config(const xrt::hw_context &hwctx, const vtd::recipe &rcp, const std::string &elf_path)
+{
+  xrt::elf elf(elf_path);
+  xrt::module mod(elf);
+  reconfig_config config;
+  config.kernel = xrt::ext::kernel(hwctx, mod, rcp.kernels[0].instance);
+  return config;
+}
+
+// Bind the constants and buffers of the recipe run
+void
+bind_run(reconfig_config &config, const vtd::recipe &rcp, std::vector<xrt::bo> &buffers)
+{
+  auto &r = rcp.runs[0];
+  config.run = xrt::run(config.kernel);
+  for (auto &c : r.constants) {
+    if (c.type == "int")
+      config.run.set_arg(c.argidx, static_cast<int32_t>(c.value));
+    else if (c.type == "uint")
+      config.run.set_arg(c.argidx, static_cast<uint32_t>(c.value));
+    else if (c.type == "int64")
+      config.run.set_arg(c.argidx, static_cast<int64_t>(c.value));
+    else
+      config.run.set_arg(c.argidx, static_cast<uint64_t>(c.value));
+  }
+  for (auto &arg : r.arguments)
+    config.run.set_arg(arg.argidx, buffers[arg.buffer]);
+}
+
+// Mean latency in us over 'iterations' runs, each run is also recorded in 'latency'
+double
+sample(xrt::run &run, int iterations, vtd::latency_histogram &latency)
+{
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    run.start();
+    run.wait2();
+    latency.record(std::chrono::steady_clock::now() - start);
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / iterations;
+}
+
+// Runs per reconfiguration that keep it below 'share' of the time
+uint64_t
+amortization_runs(double overhead_us, double run_us, double share)
+{
+  if (overhead_us <= 0)
+    return 0;
+  return static_cast<uint64_t>(std::ceil(overhead_us * (1 - share) / (share * run_us)));
+}
+
+void
+run(int argc, char **argv)
+{
+  std::string dir = "../archive/strx/aie_reconfig_overhead";
+  std::string nop_elf;
+  std::string histogram_json;
+  std::string results_json;
+  int samples = 10;
+  int iterations = 0;
+  int warmup = 1;
+  std::vector<int> shares = {10, 5, 1};
+  std::vector<int> run_us;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--samples" && i + 1 < argc)
+      samples = std::stoi(argv[++i]);
+    else if (arg == "--iterations" && i + 1 < argc)
+      iterations = std::stoi(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::stoi(argv[++i]);
+    else if (arg == "--nop-elf" && i + 1 < argc)
+      nop_elf = argv[++i];
+    else if (arg == "--amortize" && i + 1 < argc)
+      shares = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--run-us" && i + 1 < argc)
+      run_us = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else if (i == 1 && arg.rfind("--", 0) != 0)
+      dir = arg;
+    else
+      throw std::runtime_error("Usage: " + std::string(argv[0]) + " [<recipe dir>] [--samples <n>]"
+                               " [--iterations <n>] [--warmup <n>] [--nop-elf <file>] [--amortize <pct>[,<pct>...]]"
+                               " [--run-us <us>[,<us>...]] [--histogram-json <file>] [--results-json <file>]\n");
+  }
+  if (samples < 1 || iterations < 0 || warmup < 0)
+    throw std::runtime_error("Error: --samples must be positive, --iterations and --warmup not negative\n");
+
+  auto path = std::filesystem::path(dir);
+  auto reconfig_file = (path / "recipe_aie_reconfig.json").string();
+  auto nop_file = (path / "recipe_aie_reconfig_nop.json").string();
+  auto reconfig = vtd::load_recipe(reconfig_file);
+  auto nop = vtd::load_recipe(nop_file);
+  auto prf = vtd::load_profile((path / "profile_aie_reconfig.json").string(), reconfig);
+  check_recipe(reconfig, reconfig_file);
+  check_recipe(nop, nop_file);
+  if (!iterations)
+    iterations = static_cast<int>(prf.iterations);
+
+  // Both runs bind the same buffers by index
+  bool same_buffers = reconfig.buffers.size() == nop.buffers.size();
+  for (size_t b = 0; same_buffers && b < reconfig.buffers.size(); b++)
+    same_buffers = reconfig.buffers[b].name == nop.buffers[b].name && reconfig.buffers[b].size == nop.buffers[b].size;
+  if (!same_buffers)
+    throw std::runtime_error("Error: " + reconfig_file + " and " + nop_file + " must declare the same buffers\n");
+
+  // The archive ships nop.elf with the latency test only, the sibling of the
+  // recipe directory
+  if (nop_elf.empty()) {
+    nop_elf = nop.kernels[0].ctrlcode;
+    auto sibling = path / ".." / "latency" / std::filesystem::path(nop_elf).filename();
+    if (!std::filesystem::exists(nop_elf) && std::filesystem::exists(sibling))
+      nop_elf = sibling.lexically_normal().string();
+  }
+  if (!std::filesystem::exists(nop_elf))
+    throw std::runtime_error("Error: Nop ELF " + nop_elf + " not found, pass --nop-elf <file>\n");
+
+  auto device = xrt::device(0);
+  auto xclbin = xrt::xclbin(reconfig.xclbin);
+  device.register_xclbin(xclbin);
+  xrt::hw_context hwctx(device, xclbin.get_uuid());
+
+  auto reconfig_cfg = load_config(hwctx, reconfig, reconfig.kernels[0].ctrlcode);
+  auto nop_cfg = load_config(hwctx, nop, nop_elf);
+
+  // Buffers are allocated and synced once, in the memory group of the first
+  // argument they are bound to
+  std::vector<xrt::bo> buffers;
+  for (size_t b = 0; b < reconfig.buffers.size(); b++) {
+    auto arg = std::find_if(reconfig.runs[0].arguments.begin(), reconfig.runs[0].arguments.end(),
+                            [b](const vtd::recipe_argument &a) { return a.buffer == b; });
+    auto grp = arg == reconfig.runs[0].arguments.end() ? 0 : reconfig_cfg.kernel.group_id(arg->argidx);
+    buffers.emplace_back(device, reconfig.buffers[b].size, XRT_BO_FLAGS_HOST_ONLY, grp);
+    if (reconfig.buffers[b].type != "output")
+      buffers.back().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  }
+
+  bind_run(reconfig_cfg, reconfig, buffers);
+  bind_run(nop_cfg, nop, buffers);
+
+  std::cout << "AIE reconfiguration: " << samples << " samples of " << iterations << " runs per configuration"
+            << std::endl;
+  vtd::latency_histogram discard;
+  for (int i = 0; i < warmup; i++) {
+    sample(reconfig_cfg.run, iterations, discard);
+    sample(nop_cfg.run, iterations, discard);
+  }
+
+  // Alternate the order of the configurations, the one that ran last goes
+  // first in the next sample
+  vtd::latency_histogram reconfig_latency;
+  vtd::latency_histogram nop_latency;
+  std::vector<double> overhead_ms;
+  bool reconfig_first = true;
+  for (int s = 0; s < samples; s++) {
+    double latency_us[2];
+    for (int k = 0; k < 2; k++) {
+      bool is_reconfig = reconfig_first == (k == 0);
+      latency_us[is_reconfig] = is_reconfig ? sample(reconfig_cfg.run, iterations, reconfig_latency)
+                                            : sample(nop_cfg.run, iterations, nop_latency);
+    }
+    overhead_ms.push_back((latency_us[1] - latency_us[0]) / 1000);
+    reconfig_first = !reconfig_first;
+  }
+
+  reconfig_latency.print(std::cout, "Reconfiguration run latency");
+  nop_latency.print(std::cout, "Nop run latency");
+
+  auto overhead = vtd::summarize_samples(overhead_ms);
+  double nop_p50 = nop_latency.percentile_us(0.5);
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "AIE reconfiguration overhead (ms): mean " << overhead.mean << " +/- " << overhead.ci95
+            << " (95% CI) min " << overhead.min << " max " << overhead.max << ", CV " << overhead.cv() * 100
+            << "%\n";
+  std::cout << "Per run reconfiguration cost (ms, run latency less the nop p50):";
+  for (auto &p : std::vector<std::pair<std::string, double>>{{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}})
+    std::cout << " " << p.first << " " << (reconfig_latency.percentile_us(p.second) - nop_p50) / 1000;
+  std::cout << " max " << (reconfig_latency.max_us() - nop_p50) / 1000 << "\n";
+
+  // Amortization for the nop run and every given run time
+  std::vector<std::pair<std::string, double>> run_times = {{"nop run", nop_latency.mean_us()}};
+  for (auto us : run_us)
+    run_times.emplace_back("run", us);
+  std::cout << "Runs per reconfiguration to keep it below a share of the time:\n";
+  for (auto &rt : run_times) {
+    std::cout << "  " << rt.first << " of " << rt.second << " us:";
+    for (auto pct : shares)
+      std::cout << " " << pct << "%: " << amortization_runs(overhead.mean * 1000, rt.second, pct / 100.0);
+    std::cout << "\n";
+  }
+  std::cout << std::defaultfloat;
+
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, {{"aie_reconfig reconfig", reconfig_latency},
+                                                {"aie_reconfig nop", nop_latency}});
+  if (!results_json.empty()) {
+    vtd::result_set results;
+    results.app = "aie_reconfig";
+    for (auto ms : overhead_ms)
+      results.add("aie-reconfig-overhead", "ms", ms);
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Checks the --results-json output of the host applications against the
+ * thresholds in benchmarks/benchmark_npu*.json, e.g.
+ *
+ *   bench_compare run1.json run2.json run3.json
+ *
+ * Results are grouped by device id, power mode and test, so repeated runs of
+ * an application pool their samples.  The threshold file is picked by the
+ * device id and the entry by the power mode.  Latency, overhead and power
+ * (<app>-power) tests must stay at or below their threshold, all other tests
+ * at or above it, with --tolerance percent of slack.
+ *
+ * With more than one sample the mean is judged together with its 95%
+ * confidence interval: a mean on the wrong side of the limit whose interval
+ * still reaches the limit is reported as NOISY rather than FAIL.  So is a mean
+ * that misses the limit by less than the host noise floor the app measured
+ * (noise_pct, the largest of the pooled files), such a miss is not told apart
+ * from host timing noise.  NOISY fails the check as well unless --allow-noisy
+ * is given.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "json.h"
+#include "results.h"
+#include "sample_stats.h"
+
+struct threshold_file
+{
+  std::string fname;
+  std::string device_id;
+  std::map<std::pair<std::string, std::string>, double> thresholds;   // (test, pmode) -> threshold
+};
+
+threshold_file
+load_thresholds(const std::string &fname)
+{
+  auto doc = vtd::load_json(fname);
+  try {
+    threshold_file file;
+    file.fname = fname;
+    file.device_id = doc.at("device_id").as_string();
+    for (auto &test : doc.at("tests").as_array()) {
+      auto &name = test.at("test_name").as_string();
+      for (auto &entry : test.at("benchmarks").as_array()) {
+        // Thresholds are written as strings
+        auto &value = entry.at("threshold");
+        double threshold = value.is_number() ? value.as_double() : std::stod(value.as_string());
+        file.thresholds[{name, entry.at("pmode").as_string()}] = threshold;
+      }
+    }
+    return file;
+  }
+  catch (const std::exception& ex) {
+    throw std::runtime_error(fname + ": " + ex.what());
+  }
+}
+
+struct verdict
+{
+  std::string device_id;
+  std::string pmode;
+  std::string test;
+  std::string unit;
+  vtd::sample_stats stats;
+  bool has_threshold = false;
+  double threshold = 0;
+  double margin_pct = 0;                 // Positive is headroom
+  double noise_pct = 0;                  // Host noise floor
+  std::string status;                    // PASS, FAIL, NOISY or SKIP
+};
+
+verdict
+judge(const std::string &device_id, const std::string &pmode, const vtd::result_metric &metric,
+      const threshold_file *file, double tolerance)
+{
+  verdict v;
+  v.device_id = device_id;
+  v.pmode = pmode;
+  v.test = metric.test;
+  v.unit = metric.unit;
+  v.stats = vtd::summarize_samples(metric.samples);
+  v.noise_pct = metric.noise_pct;
+  v.status = "SKIP";
+  if (!file)
+    return v;
+  auto it = file->thresholds.find({metric.test, pmode});
+  if (it == file->thresholds.end())
+    return v;
+
+  v.has_threshold = true;
+  v.threshold = it->second;
+  bool lower = vtd::lower_is_better(metric.test);
+  double limit = v.threshold * (lower ? 1 + tolerance : 1 - tolerance);
+  double mean = v.stats.mean;
+  v.margin_pct = v.threshold ? (lower ? v.threshold - mean : mean - v.threshold) / v.threshold * 100 : 0;
+
+  bool pass = lower ? mean <= limit : mean >= limit;
+  double noise = mean * metric.noise_pct / 100;
+  double slack = std::max(v.stats.ci95, noise);
+  bool reaches = lower ? mean - slack <= limit : mean + slack >= limit;
+  v.status = pass ? "PASS" : reaches ? "NOISY" : "FAIL";
+  return v;
+}
+
+void
+write_report(const std::string &fname, const std::vector<verdict> &verdicts)
+{
+  std::ofstream ofs(fname);
+  if (!ofs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+
+  ofs << "{\"verdicts\": [";
+  for (size_t i = 0; i < verdicts.size(); i++) {
+    auto &v = verdicts[i];
+    ofs << (i ? ",\n" : "\n") << "  {\"device_id\": " << vtd::json_quote(v.device_id) << ", \"pmode\": "
+        << vtd::json_quote(v.pmode) << ", \"test\": " << vtd::json_quote(v.test) << ", \"unit\": "
+        << vtd::json_quote(v.unit) << ", \"count\": " << v.stats.count << ", \"mean\": " << v.stats.mean
+        << ", \"ci95\": " << v.stats.ci95;
+    if (v.noise_pct > 0)
+      ofs << ", \"noise_pct\": " << v.noise_pct;
+    if (v.has_threshold) {
+      ofs << ", \"threshold\": " << v.threshold << ", \"better\": \""
+          << (vtd::lower_is_better(v.test) ? "lower" : "higher") << "\", \"margin_pct\": " << v.margin_pct;
+    }
+    ofs << ", \"status\": \"" << v.status << "\"}";
+  }
+  ofs << "\n]}\n";
+}
+
+void
+run(int argc, char **argv)
+{
+  std::vector<std::string> result_files;
+  std::vector<std::string> threshold_files;
+  std::string device_override;
+  std::string pmode_override;
+  std::string report_json;
+  double tolerance = 0;
+  bool allow_noisy = false;
+  const std::string usage = "Usage: " + std::string(argv[0]) + " <results.json>... [--thresholds <benchmark.json>]..."
+                            " [--device-id <id>] [--pmode <mode>] [--tolerance <pct>] [--allow-noisy]"
+                            " [--report-json <file>]\n";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--thresholds" && i + 1 < argc)
+      threshold_files.push_back(argv[++i]);
+    else if (arg == "--device-id" && i + 1 < argc)
+      device_override = argv[++i];
+    else if (arg == "--pmode" && i + 1 < argc)
+      pmode_override = argv[++i];
+    else if (arg == "--tolerance" && i + 1 < argc)
+      tolerance = std::stod(argv[++i]) / 100;
+    else if (arg == "--allow-noisy")
+      allow_noisy = true;
+    else if (arg == "--report-json" && i + 1 < argc)
+      report_json = argv[++i];
+    else if (arg.rfind("--", 0) != 0)
+      result_files.push_back(arg);
+    else
+      throw std::runtime_error(usage);
+  }
+  if (result_files.empty())
+    throw std::runtime_error(usage);
+
+  // By default every threshold file in benchmarks/
+  if (threshold_files.empty()) {
+    std::filesystem::path dir = "../benchmarks";
+    if (std::filesystem::is_directory(dir)) {
+      for (auto &entry : std::filesystem::directory_iterator(dir)) {
+        auto name = entry.path().filename().string();
+        if (name.rfind("benchmark_", 0) == 0 && entry.path().extension() == ".json")
+          threshold_files.push_back(entry.path().string());
+      }
+    }
+    std::sort(threshold_files.begin(), threshold_files.end());
+  }
+  std::vector<threshold_file> files;
+  for (auto &fname : threshold_files)
+    files.push_back(load_thresholds(fname));
+
+  // Pool the samples of every (device, pmode, test)
+  std::map<std::tuple<std::string, std::string, std::string>, vtd::result_metric> pooled;
+  for (auto &fname : result_files) {
+    auto results = vtd::load_results(fname);
+    auto device_id = device_override.empty() ? results.device_id : device_override;
+    auto pmode = pmode_override.empty() ? results.pmode : pmode_override;
+    for (auto &metric : results.metrics) {
+      auto &pool = pooled[{device_id, pmode, metric.test}];
+      pool.test = metric.test;
+      pool.unit = metric.unit;
+      pool.samples.insert(pool.samples.end(), metric.samples.begin(), metric.samples.end());
+      pool.noise_pct = std::max(pool.noise_pct, metric.noise_pct);
+    }
+  }
+
+  std::vector<verdict> verdicts;
+  for (auto &entry : pooled) {
+    auto &device_id = std::get<0>(entry.first);
+    auto file = std::find_if(files.begin(), files.end(), [&](const threshold_file &f) {
+      return f.device_id == device_id;
+    });
+    verdicts.push_back(judge(device_id, std::get<1>(entry.first), entry.second,
+                             file == files.end() ? nullptr : &*file, tolerance));
+  }
+
+  unsigned int failed = 0;
+  std::string group;
+  std::cout << std::fixed << std::setprecision(3);
+  for (auto &v : verdicts) {
+    auto header = "Device " + v.device_id + ", pmode " + v.pmode;
+    if (header != group) {
+      group = header;
+      std::cout << header << ":\n";
+    }
+    std::cout << "  " << std::left << std::setw(28) << v.test << std::right << " mean " << v.stats.mean << " +/- "
+              << v.stats.ci95 << " " << v.unit << " (n=" << v.stats.count << ")";
+    if (v.noise_pct > 0)
+      std::cout << " noise floor " << v.noise_pct << "%";
+    if (v.has_threshold) {
+      std::cout << " threshold " << (vtd::lower_is_better(v.test) ? "<= " : ">= ") << v.threshold << " margin "
+                << std::showpos << v.margin_pct << std::noshowpos << "%";
+    }
+    std::cout << " " << v.status << "\n";
+    if (v.status == "FAIL" || (v.status == "NOISY" && !allow_noisy))
+      failed++;
+  }
+
+  if (!report_json.empty())
+    write_report(report_json, verdicts);
+  if (failed)
+    throw std::runtime_error("Error: " + std::to_string(failed) + " benchmark(s) below threshold\nTEST FAILED!");
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
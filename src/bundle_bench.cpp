@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application compares loading test files from an indexed bundle
+ * with extracting them from the flat ar archive of the same platform, as
+ * written by archive/build_archives.py.  Every file of the bundle is looked up
+ * and read: from the bundle by path in the memory mapped index, from the
+ * archive with ar -x into a scratch directory and by file name.  The archive
+ * flattens the tree, files whose name repeats come back as whichever copy was
+ * archived last and are reported as lost, as are files the archive is missing
+ * or holds an older copy of.  A single file is fetched both ways
+ * as well, which is what a test that needs one xclbin pays.  No device is
+ * needed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bundle.h"
+#include "dpu_sequence.h"
+
+template <typename Func>
+double
+time_us(Func &&func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// Median over 'rounds' calls
+template <typename Func>
+double
+median_us(int rounds, Func &&func)
+{
+  std::vector<double> samples;
+  for (int i = 0; i < rounds; i++)
+    samples.push_back(time_us(func));
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Read one byte per page so every page of the file is really loaded
+uint64_t
+touch(const char *data, size_t size)
+{
+  uint64_t sum = 0;
+  for (size_t i = 0; i < size; i += 4096)
+    sum += static_cast<unsigned char>(data[i]);
+  return sum;
+}
+
+// Scratch directory for ar -x, removed again when done
+class scratch_dir
+{
+public:
+  scratch_dir()
+    : m_path(std::filesystem::temp_directory_path()
+             / ("bundle_bench." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+  {
+    std::filesystem::create_directories(m_path);
+  }
+
+  ~scratch_dir()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(m_path, ec);
+  }
+
+  const std::filesystem::path&
+  path() const
+  {
+    return m_path;
+  }
+
+private:
+  std::filesystem::path m_path;
+};
+
+// Extract 'member', or every member when empty, of 'archive' into 'dir'
+void
+ar_extract(const std::string &archive, const std::filesystem::path &dir, const std::string &member = "")
+{
+  auto cmd = "cd '" + dir.string() + "' && ar x '" + archive + "'" + (member.empty() ? "" : " '" + member + "'");
+  if (std::system(cmd.c_str()))
+    throw std::runtime_error("Error: " + cmd + " failed\n");
+}
+
+void
+report(const std::string &name, double us, double baseline_us)
+{
+  std::cout << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << us << " us" << std::setw(10) << baseline_us / us << "x\n";
+}
+
+void
+run(int argc, char **argv)
+{
+  if (argc != 3 && !(argc == 5 && std::string(argv[3]) == "--rounds"))
+    throw std::runtime_error("Usage: " + std::string(argv[0]) + " <bundle> <archive.a> [--rounds <n>]");
+
+  std::string bundle_name = argv[1];
+  auto archive = std::filesystem::absolute(argv[2]).string();
+  int rounds = argc == 5 ? std::stoi(argv[4]) : 9;
+  if (rounds < 1)
+    throw std::runtime_error("Error: --rounds must be positive\n");
+
+  vtd::bundle bnd(bundle_name);
+  if (!bnd.size())
+    throw std::runtime_error("Error: " + bundle_name + " holds no files\n");
+  std::cout << "Bundle: " << bundle_name << " (" << bnd.size() << " files in " << bnd.blob_count() << " blobs, "
+            << bnd.entry_bytes() - bnd.stored_bytes() << " bytes shared)\n";
+
+  // The largest file stands for the one xclbin or ELF a test needs
+  std::vector<std::string> paths;
+  std::string single;
+  size_t single_size = 0;
+  for (size_t e = 0; e < bnd.size(); e++) {
+    auto entry = bnd.entry(e);
+    paths.emplace_back(entry.path);
+    if (entry.size >= single_size) {
+      single = paths.back();
+      single_size = entry.size;
+    }
+  }
+  auto single_member = std::filesystem::path(single).filename().string();
+
+  // Check what the archive gives back for every path before timing it
+  size_t lost = 0;
+  {
+    scratch_dir dir;
+    ar_extract(archive, dir.path());
+    for (auto &p : paths) {
+      auto fname = dir.path() / std::filesystem::path(p).filename();
+      auto entry = bnd.at(p);
+      if (!std::filesystem::exists(fname)) {
+        lost++;
+        continue;
+      }
+      vtd::mapped_file file(fname.string());
+      if (file.size() != entry.size || std::memcmp(file.data(), entry.data, entry.size))
+        lost++;
+    }
+  }
+
+  uint64_t sum = 0;
+  double ar_all_us = median_us(rounds, [&] {
+    scratch_dir dir;
+    ar_extract(archive, dir.path());
+    for (auto &p : paths) {
+      auto fname = dir.path() / std::filesystem::path(p).filename();
+      if (!std::filesystem::exists(fname))
+        continue;
+      vtd::mapped_file file(fname.string());
+      sum += touch(file.data(), file.size());
+    }
+  });
+  double bundle_all_us = median_us(rounds, [&] {
+    vtd::bundle fresh(bundle_name);
+    for (auto &p : paths) {
+      auto entry = fresh.at(p);
+      sum += touch(entry.data, entry.size);
+    }
+  });
+
+  double ar_single_us = median_us(rounds, [&] {
+    scratch_dir dir;
+    ar_extract(archive, dir.path(), single_member);
+    vtd::mapped_file file((dir.path() / single_member).string());
+    sum += touch(file.data(), file.size());
+  });
+  double bundle_single_us = median_us(rounds, [&] {
+    vtd::bundle fresh(bundle_name);
+    auto entry = fresh.at(single);
+    sum += touch(entry.data, entry.size);
+  });
+
+  // Lookup alone, on the bundle that is already open
+  constexpr int lookups = 1000;
+  double lookup_us = median_us(rounds, [&] {
+    for (int i = 0; i < lookups; i++) {
+      vtd::bundle_entry entry;
+      sum += bnd.find(paths[i % paths.size()], entry);
+    }
+  });
+
+  std::cout << "Archive: " << archive << " (" << lost << " of " << paths.size()
+            << " files missing or different, lost to name collisions or stale)\n";
+  report("ar -x, all files", ar_all_us, ar_all_us);
+  report("bundle, all files", bundle_all_us, ar_all_us);
+  report("ar -x, " + single_member, ar_single_us, ar_single_us);
+  report("bundle, " + single_member, bundle_single_us, ar_single_us);
+  std::cout << "Bundle lookup: " << lookup_us * 1000 / lookups << " ns per path\n";
+  std::cout << std::defaultfloat;
+  if (!sum)
+    std::cout << "(all files empty)\n";
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
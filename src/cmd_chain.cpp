@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application compares submitting commands one at a time with
+ * submitting them as command chains.  The kernel is set up as in tct_tp, from
+ * an xclbin and a short DPU sequence such as a nop, and --commands runs are
+ * bound once with the same arguments.  Every sample submits all of them
+ * individually, each run started and waited for in turn, and then as
+ * xrt::runlist chains of every --chain length, one chain after the other.
+ * The modes alternate order from sample to sample.
+ *
+ * Reported per mode are the time per command, the command rate and the
+ * latency of a submission (a command or a whole chain).  The time per command
+ * of the chains is fitted to t(L) = c + s / L, a per command cost c plus a
+ * per submission cost s shared by the L commands of a chain, which gives the
+ * chain length beyond which the submission cost stays below --knee percent of
+ * the time per command; longer chains hardly help any more.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_kernel.h"
+
+#include "cmdline.h"
+#include "dpu_sequence.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "sample_stats.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
+
+constexpr int host_app = 1;
+constexpr size_t buffer_size = 0x1000;
+
+// Time per command of every sample of one mode and its submission latencies
+struct chain_mode
+{
+  int length = 0;                        // 0 for individual submission
+  std::vector<double> us_per_command;
+  vtd::latency_histogram latency;
+};
+
+// Submit every run on its own, each is waited for before the next starts
+double
+run_individual(std::vector<xrt::run> &runs, vtd::latency_histogram &latency)
+{
+  auto begin = std::chrono::steady_clock::now();
+  for (auto &run : runs) {
+    auto start = std::chrono::steady_clock::now();
+    run.start();
+    run.wait2();
+    latency.record(std::chrono::steady_clock::now() - start);
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Submit the runs as chains of 'length', one chain after the other.  The
+// chains are built before and taken apart after the timed part, a run can
+// only be on one list at a time.
+double
+run_chained(const xrt::hw_context &hwctx, std::vector<xrt::run> &runs, int length,
+            vtd::latency_histogram &latency)
+{
+  std::vector<xrt::runlist> lists;
+  for (size_t i = 0; i < runs.size(); i++) {
+    if (i % length == 0)
+      lists.emplace_back(hwctx);
+    lists.back().add(runs[i]);
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  for (auto &list : lists) {
+    auto start = std::chrono::steady_clock::now();
+    list.execute();
+    list.wait();
+    latency.record(std::chrono::steady_clock::now() - start);
+  }
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  for (auto &list : lists)
+    list.reset();
+  return us;
+}
+
+std::string
+mode_name(const chain_mode &mode)
+{
+  return mode.length ? "chain of " + std::to_string(mode.length) : "individual";
+}
+
+void
+run(int argc, char **argv)
+{
+  vtd::startup_profile profile;
+  int commands = 256;
+  int samples = 5;
+  int warmup = 1;
+  int knee_pct = 10;
+  std::vector<int> lengths = {1, 2, 4, 8, 16, 32, 64};
+  std::string histogram_json;
+  std::string results_json;
+
+  const std::string usage = "Usage: " + std::string(argv[0]) + " <xclbin> <sequence> [--commands <n>]"
+                            " [--chain <n>[,<n>...]] [--samples <n>] [--warmup <n>] [--knee <pct>]"
+                            " [--histogram-json <file>] [--results-json <file>]\n";
+  if (argc < 3)
+    throw std::runtime_error(usage);
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--commands" && i + 1 < argc)
+      commands = std::stoi(argv[++i]);
+    else if (arg == "--chain" && i + 1 < argc)
+      lengths = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--samples" && i + 1 < argc)
+      samples = std::stoi(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::stoi(argv[++i]);
+    else if (arg == "--knee" && i + 1 < argc)
+      knee_pct = std::stoi(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else
+      throw std::runtime_error(usage);
+  }
+  std::sort(lengths.begin(), lengths.end());
+  lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+  if (commands < 1 || samples < 1 || warmup < 0 || lengths.empty() || lengths[0] < 1)
+    throw std::runtime_error("Error: --commands, --samples and the chain lengths must be positive\n");
+  if (knee_pct < 1 || knee_pct > 99)
+    throw std::runtime_error("Error: --knee must be between 1 and 99 percent\n");
+
+  std::string xclbinFileName = argv[1];
+  std::string dpuSequenceFileName = argv[2];
+  auto device = profile.time("device open", [] { return xrt::device(0); });
+  vtd::setup_cache cache(device, &profile);
+  auto hwctx = cache.hw_context(xclbinFileName);
+  auto dpu = cache.kernel(xclbinFileName);
+  auto instr = profile.time("DPU sequence", [&] {
+    return vtd::load_dpu_sequence(device, dpu, dpuSequenceFileName);
+  });
+  auto bo_in = profile.time("BO allocation", [&] {
+    return xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(1));
+  });
+  auto bo_out = profile.time("BO allocation", [&] {
+    return xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(3));
+  });
+  bo_in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+  // Every mode submits the same runs
+  std::vector<xrt::run> runs(commands);
+  profile.time("run setup", [&] {
+    for (auto &run : runs) {
+      run = xrt::run(dpu);
+      run.set_arg(0, host_app);
+      run.set_arg(1, bo_in);
+      run.set_arg(2, NULL);
+      run.set_arg(3, bo_out);
+      run.set_arg(4, NULL);
+      run.set_arg(5, instr.bo);
+      run.set_arg(6, instr.size);
+      run.set_arg(7, NULL);
+    }
+  });
+  profile.print(std::cout);
+
+  std::vector<chain_mode> modes(1);
+  for (auto length : lengths) {
+    modes.emplace_back();
+    modes.back().length = length;
+  }
+  auto submit = [&](const chain_mode &mode, vtd::latency_histogram &latency) {
+    return mode.length ? run_chained(hwctx, runs, mode.length, latency) : run_individual(runs, latency);
+  };
+
+  std::cout << "Command chains: " << samples << " samples of " << commands << " commands per mode" << std::endl;
+  vtd::latency_histogram discard;
+  for (int i = 0; i < warmup; i++) {
+    for (auto &mode : modes)
+      submit(mode, discard);
+  }
+
+  // Every other sample runs the modes in reverse order, so drift of the
+  // device does not favor the modes that run first
+  for (int s = 0; s < samples; s++) {
+    for (size_t k = 0; k < modes.size(); k++) {
+      auto &mode = modes[s % 2 ? modes.size() - 1 - k : k];
+      mode.us_per_command.push_back(submit(mode, mode.latency) / commands);
+    }
+  }
+
+  double individual_us = vtd::summarize_samples(modes[0].us_per_command).mean;
+  std::cout << "              Mode   Time/cmd (us)   +/- 95%     Cmd/s   Speedup   Submit p50 (us)   p99 (us)\n";
+  std::cout << std::fixed << std::setprecision(3);
+  std::vector<double> x, y;
+  for (auto &mode : modes) {
+    auto stats = vtd::summarize_samples(mode.us_per_command);
+    std::cout << std::setw(18) << mode_name(mode) << std::setw(16) << stats.mean << std::setw(10) << stats.ci95
+              << std::setw(10) << std::setprecision(0) << 1e6 / stats.mean << std::setprecision(3) << std::setw(10)
+              << individual_us / stats.mean << std::setw(18) << mode.latency.percentile_us(0.5) << std::setw(11)
+              << mode.latency.percentile_us(0.99) << "\n";
+    if (mode.length) {
+      x.push_back(1.0 / mode.length);
+      y.push_back(stats.mean);
+    }
+  }
+
+  // t(L) = c + s / L is a line in 1 / L
+  auto fit = vtd::fit_line(x, y);
+  if (x.size() < 2 || fit.slope <= 0 || fit.intercept <= 0)
+    std::cout << "Too few chain lengths, or no gain from chaining, to find where the benefit levels off\n";
+  else {
+    // s / L <= p (c + s / L) holds from L = s (1 - p) / (p c) on
+    auto knee = static_cast<int>(std::ceil(fit.slope * (100 - knee_pct) / (knee_pct * fit.intercept)));
+    std::cout << "Fitted cost: " << fit.intercept << " us per command plus " << fit.slope
+              << " us per submission (r^2 " << fit.r2 << ")\n";
+    std::cout << "Chains of " << knee << " or more commands keep the submission cost below " << knee_pct
+              << "% of the time per command, the benefit levels off there\n";
+  }
+  std::cout << std::defaultfloat;
+
+  if (!histogram_json.empty()) {
+    std::vector<std::pair<std::string, vtd::latency_histogram>> histograms;
+    for (auto &mode : modes)
+      histograms.emplace_back("cmd_chain " + mode_name(mode), mode.latency);
+    vtd::write_histograms_json(histogram_json, histograms);
+  }
+
+  // The gated cmd-chain numbers are those of the longest chain
+  if (!results_json.empty()) {
+    vtd::result_set results;
+    results.app = "cmd_chain";
+    for (auto us : modes.back().us_per_command) {
+      results.add("cmd-chain-latency", "us", us);
+      results.add("cmd-chain-throughput", "op/s", 1e6 / us);
+    }
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
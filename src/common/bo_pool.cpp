@@ -0,0 +1,369 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "bo_pool.h"
+#include "data_pattern.h"
+
+#include <iomanip>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t page_size = 4096;
+constexpr size_t huge_2m = size_t(2) << 20;
+constexpr size_t huge_1g = size_t(1) << 30;
+
+#if !defined(_WIN32) && defined(MAP_HUGETLB)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+/* Page aligned host memory of at least 'size' bytes for a user pointer BO.
+ * hugetlb pages are tried first, without reserved huge pages the mapping
+ * falls back to transparent huge pages and 'fallback' is set.
+ */
+void*
+map_host_memory(size_t size, vtd::bo_backing backing, size_t &len, bool &fallback)
+{
+#ifndef _WIN32
+  size_t page = backing == vtd::bo_backing::huge_1g ? huge_1g : huge_2m;
+  len = (size + page - 1) / page * page;
+  void *host = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (backing != vtd::bo_backing::thp) {
+    int huge = MAP_HUGETLB | (backing == vtd::bo_backing::huge_1g ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+    host = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | huge, -1, 0);
+  }
+#endif
+  if (host != MAP_FAILED)
+    return host;
+
+  fallback = backing != vtd::bo_backing::thp;
+  host = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (host == MAP_FAILED)
+    throw std::runtime_error("Error: Failure mapping " + std::to_string(len) + " bytes of host memory\n");
+#ifdef MADV_HUGEPAGE
+  madvise(host, len, MADV_HUGEPAGE);
+#endif
+  return host;
+#else
+  throw std::runtime_error("Error: Huge page backed BOs are only supported on Linux\n");
+#endif
+}
+
+// Bind 'len' bytes at 'host' to NUMA node 'node'.  Through the system call,
+// so libnuma is not needed.
+void
+bind_numa_node(void *host, size_t len, int node)
+{
+#if !defined(_WIN32) && defined(SYS_mbind)
+  constexpr int mpol_bind = 2;
+  constexpr size_t max_node = 1024;
+  constexpr size_t bits = 8 * sizeof(unsigned long);
+  if (node < 0 || static_cast<size_t>(node) >= max_node)
+    throw std::runtime_error("Error: Invalid NUMA node " + std::to_string(node) + "\n");
+  std::vector<unsigned long> mask(max_node / bits);
+  mask[node / bits] |= 1UL << (node % bits);
+  if (syscall(SYS_mbind, host, len, mpol_bind, mask.data(), max_node, 0))
+    throw std::runtime_error("Error: Failure binding host memory to NUMA node " + std::to_string(node) + "\n");
+#else
+  throw std::runtime_error("Error: NUMA placement is only supported on Linux\n");
+#endif
+}
+
+double
+to_ms(std::chrono::nanoseconds ns)
+{
+  return ns.count() / 1e6;
+}
+
+} // namespace
+
+namespace vtd {
+
+// A pooled BO and the host memory behind it when the pool mapped that itself
+struct bo_pool::entry
+{
+  xrt::bo bo;
+  size_t size = 0;
+  xrtBufferFlags flags = 0;
+  xrtMemoryGroup grp = 0;
+  void *host = nullptr;
+  size_t host_len = 0;
+  std::chrono::nanoseconds cost {};
+  bool leased = false;
+
+  ~entry()
+  {
+    // The BO must be gone before its user memory
+    bo = xrt::bo();
+#ifndef _WIN32
+    if (host)
+      munmap(host, host_len);
+#endif
+  }
+};
+
+bo_backing
+parse_bo_backing(const std::string &name)
+{
+  if (name == "driver")
+    return bo_backing::driver;
+  if (name == "thp")
+    return bo_backing::thp;
+  if (name == "2m")
+    return bo_backing::huge_2m;
+  if (name == "1g")
+    return bo_backing::huge_1g;
+  throw std::runtime_error("Error: Unknown BO backing '" + name + "', expected driver, thp, 2m or 1g\n");
+}
+
+std::string
+bo_backing_name(bo_backing backing)
+{
+  switch (backing) {
+  case bo_backing::thp:
+    return "thp";
+  case bo_backing::huge_2m:
+    return "2m";
+  case bo_backing::huge_1g:
+    return "1g";
+  default:
+    return "driver";
+  }
+}
+
+bo_pool::
+bo_pool(const xrt::device &device, bo_backing backing, bool prefault, int numa_node)
+  : m_device(device)
+  , m_backing(backing)
+  , m_prefault(prefault)
+  , m_numa_node(numa_node)
+{
+  if (numa_node >= 0 && backing == bo_backing::driver)
+    throw std::runtime_error("Error: A NUMA node needs a thp, 2m or 1g BO backing, the driver places its own memory\n");
+}
+
+bo_pool::
+~bo_pool() = default;
+
+std::unique_ptr<bo_pool::entry>
+bo_pool::
+allocate(size_t size, xrtBufferFlags flags, xrtMemoryGroup grp)
+{
+  auto e = std::make_unique<entry>();
+  e->size = size;
+  e->flags = flags;
+  e->grp = grp;
+
+  auto start = std::chrono::steady_clock::now();
+  bool fallback = false;
+  if (m_backing == bo_backing::driver)
+    e->bo = xrt::bo(m_device, size, flags, grp);
+  else {
+    e->host = map_host_memory(size, m_backing, e->host_len, fallback);
+    if (m_numa_node >= 0)
+      bind_numa_node(e->host, e->host_len, m_numa_node);
+    e->bo = xrt::bo(m_device, e->host, size, grp);
+  }
+  auto allocated = std::chrono::steady_clock::now();
+
+  auto data = e->bo.map<char*>();
+  auto mapped = std::chrono::steady_clock::now();
+
+  // Touch one byte per page on all cores, then let the driver pin the pages
+  auto prefaulted = mapped;
+  auto synced = mapped;
+  if (m_prefault) {
+    parallel_chunks((size + page_size - 1) / page_size, 0, [data](size_t begin, size_t end) {
+      for (size_t p = begin; p < end; p++)
+        data[p * page_size] = 0;
+    });
+    prefaulted = std::chrono::steady_clock::now();
+    e->bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    synced = std::chrono::steady_clock::now();
+  }
+  e->cost = synced - start;
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_stats.allocations++;
+  m_stats.huge_fallbacks += fallback;
+  m_stats.bytes += e->host_len ? e->host_len : size;
+  m_stats.alloc += allocated - start;
+  m_stats.map += mapped - allocated;
+  m_stats.prefault += prefaulted - mapped;
+  m_stats.sync += synced - prefaulted;
+  return e;
+}
+
+bo_lease
+bo_pool::
+acquire(size_t size, xrtBufferFlags flags, xrtMemoryGroup grp)
+{
+  bo_lease lease(this, nullptr);
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.acquires++;
+    for (auto &e : m_entries) {
+      if (e->size == size && e->flags == flags && e->grp == grp && !e->leased) {
+        m_stats.reuses++;
+        m_stats.saved += e->cost;
+        e->leased = true;
+        lease.m_entry = e.get();
+        lease.m_bo = e->bo;
+        return lease;
+      }
+    }
+  }
+
+  // Large allocations and prefaulting run outside the lock, other threads
+  // keep acquiring in the meantime
+  auto e = allocate(size, flags, grp);
+  e->leased = true;
+  lease.m_entry = e.get();
+  lease.m_bo = e->bo;
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_entries.push_back(std::move(e));
+  return lease;
+}
+
+void
+bo_pool::
+release(entry *e)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  e->leased = false;
+}
+
+bo_pool_stats
+bo_pool::
+stats() const
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_stats;
+}
+
+void
+bo_pool::
+print_stats(std::ostream &os) const
+{
+  auto s = stats();
+  auto flags = os.flags();
+  auto precision = os.precision();
+  os << std::fixed << std::setprecision(2);
+  os << "BO pool (" << bo_backing_name(m_backing) << (m_prefault ? ", prefault" : "")
+     << (m_numa_node >= 0 ? ", node " + std::to_string(m_numa_node) : "") << "): " << s.acquires
+     << " acquires, " << s.allocations << " allocations of " << s.bytes / (1024.0 * 1024.0) << " MB, " << s.reuses
+     << " reuses; alloc " << to_ms(s.alloc) << " ms, map " << to_ms(s.map) << " ms, prefault " << to_ms(s.prefault)
+     << " ms, sync " << to_ms(s.sync) << " ms; reuse saved " << to_ms(s.saved) << " ms";
+  if (s.huge_fallbacks)
+    os << "; " << s.huge_fallbacks << " allocations fell back to THP, reserve huge pages in /proc/sys/vm/nr_hugepages";
+  os << "\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+bo_lease::
+~bo_lease()
+{
+  release();
+}
+
+bo_lease::
+bo_lease(bo_lease &&other) noexcept
+  : m_pool(other.m_pool)
+  , m_entry(other.m_entry)
+  , m_bo(std::move(other.m_bo))
+{
+  other.m_pool = nullptr;
+  other.m_entry = nullptr;
+}
+
+bo_lease&
+bo_lease::
+operator=(bo_lease &&other) noexcept
+{
+  if (this != &other) {
+    release();
+    m_pool = other.m_pool;
+    m_entry = other.m_entry;
+    m_bo = std::move(other.m_bo);
+    other.m_pool = nullptr;
+    other.m_entry = nullptr;
+  }
+  return *this;
+}
+
+void
+bo_lease::
+release()
+{
+  m_bo = xrt::bo();
+  if (m_entry)
+    m_pool->release(m_entry);
+  m_pool = nullptr;
+  m_entry = nullptr;
+}
+
+file_bo::
+file_bo(const xrt::device &device, const std::string &fname, size_t size, xrtMemoryGroup grp)
+{
+#ifndef _WIN32
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Error: Failure opening file " + fname + "!!\n");
+
+  // Pages past the end of the file would fault, a short file is an error
+  struct stat st;
+  if (fstat(fd, &st) || static_cast<size_t>(st.st_size) < size) {
+    close(fd);
+    throw std::runtime_error("Error: " + fname + " holds fewer than the " + std::to_string(size) + " bytes expected\n");
+  }
+
+  m_len = (size + page_size - 1) / page_size * page_size;
+  m_host = mmap(nullptr, m_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m_host == MAP_FAILED) {
+    m_host = nullptr;
+    throw std::runtime_error("Error: Failure mapping file " + fname + "\n");
+  }
+
+  try {
+    m_bo = xrt::bo(device, m_host, size, grp);
+  }
+  catch (...) {
+    munmap(m_host, m_len);
+    throw;
+  }
+#else
+  throw std::runtime_error("Error: File backed BOs are only supported on Linux\n");
+#endif
+}
+
+file_bo::
+~file_bo()
+{
+  // The BO must be gone before its user memory
+  m_bo = xrt::bo();
+#ifndef _WIN32
+  if (m_host)
+    munmap(m_host, m_len);
+#endif
+}
+
+} // namespace vtd
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "bundle.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char bundle_magic[8] = {'V', 'T', 'D', 'B', 'N', 'D', '0', '1'};
+constexpr uint32_t bundle_version = 1;
+constexpr size_t header_size = 64;
+constexpr size_t entry_size = 16;
+constexpr size_t blob_size = 48;
+
+uint64_t
+get_le(const char *p, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+  return value;
+}
+
+uint32_t
+get32(const char *p)
+{
+  return static_cast<uint32_t>(get_le(p, 4));
+}
+
+uint64_t
+get64(const char *p)
+{
+  return get_le(p, 8);
+}
+
+} // namespace
+
+namespace vtd {
+
+bundle::
+bundle(const std::string &fname)
+  : m_file(fname)
+  , m_fname(fname)
+{
+  auto invalid = [&fname](const std::string &what) {
+    return std::runtime_error("Error: " + fname + " is not a valid bundle, " + what + "\n");
+  };
+
+  auto base = m_file.data();
+  uint64_t size = m_file.size();
+  if (size < header_size || std::memcmp(base, bundle_magic, sizeof(bundle_magic)))
+    throw invalid("bad magic");
+  if (get32(base + 8) != bundle_version)
+    throw invalid("unsupported version " + std::to_string(get32(base + 8)));
+
+  uint32_t page = get32(base + 12);
+  m_entry_count = get32(base + 16);
+  m_blob_count = get32(base + 20);
+  uint64_t entries = get64(base + 24);
+  uint64_t blobs = get64(base + 32);
+  uint64_t strings = get64(base + 40);
+  uint64_t strings_size = get64(base + 48);
+  if (get64(base + 56) != size)
+    throw invalid("truncated");
+
+  // Tables lie within the file, counts are bounded by the file size first so
+  // the products cannot overflow
+  auto in_file = [size](uint64_t offset, uint64_t len) { return offset <= size && len <= size - offset; };
+  if (m_entry_count > size / entry_size || m_blob_count > size / blob_size || !in_file(entries, m_entry_count * entry_size)
+      || !in_file(blobs, m_blob_count * blob_size) || !in_file(strings, strings_size))
+    throw invalid("table out of range");
+  m_entries = base + entries;
+  m_blobs = base + blobs;
+  m_strings = base + strings;
+
+  for (size_t b = 0; b < m_blob_count; b++) {
+    auto blob = m_blobs + b * blob_size;
+    uint64_t offset = get64(blob);
+    if ((page && offset % page) || !in_file(offset, get64(blob + 8)))
+      throw invalid("payload " + std::to_string(b) + " out of range");
+  }
+
+  // Lookups are binary searches, so the paths must be strictly ascending
+  std::string_view prev;
+  for (size_t e = 0; e < m_entry_count; e++) {
+    auto ent = m_entries + e * entry_size;
+    uint32_t path = get32(ent);
+    uint32_t path_size = get32(ent + 4);
+    if (path > strings_size || path_size > strings_size - path || get32(ent + 8) >= m_blob_count)
+      throw invalid("entry " + std::to_string(e) + " out of range");
+    std::string_view cur(m_strings + path, path_size);
+    if (e && cur <= prev)
+      throw invalid("entries not sorted");
+    prev = cur;
+  }
+}
+
+bundle_entry
+bundle::
+entry(size_t index) const
+{
+  if (index >= m_entry_count)
+    throw std::runtime_error("Error: Bundle entry " + std::to_string(index) + " out of range\n");
+
+  auto ent = m_entries + index * entry_size;
+  bundle_entry out;
+  out.path = std::string_view(m_strings + get32(ent), get32(ent + 4));
+  out.blob = get32(ent + 8);
+  auto blob = m_blobs + out.blob * blob_size;
+  out.data = m_file.data() + get64(blob);
+  out.size = get64(blob + 8);
+  out.sha256 = reinterpret_cast<const uint8_t*>(blob + 16);
+  return out;
+}
+
+bool
+bundle::
+find(std::string_view path, bundle_entry &out) const
+{
+  size_t lo = 0;
+  size_t hi = m_entry_count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    auto ent = m_entries + mid * entry_size;
+    std::string_view cur(m_strings + get32(ent), get32(ent + 4));
+    if (cur == path) {
+      out = entry(mid);
+      return true;
+    }
+    if (cur < path)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return false;
+}
+
+bundle_entry
+bundle::
+at(std::string_view path) const
+{
+  bundle_entry out;
+  if (!find(path, out))
+    throw std::runtime_error("Error: " + std::string(path) + " not found in bundle " + m_fname + "\n");
+  return out;
+}
+
+uint64_t
+bundle::
+stored_bytes() const
+{
+  uint64_t bytes = 0;
+  for (size_t b = 0; b < m_blob_count; b++)
+    bytes += get64(m_blobs + b * blob_size + 8);
+  return bytes;
+}
+
+uint64_t
+bundle::
+entry_bytes() const
+{
+  uint64_t bytes = 0;
+  for (size_t e = 0; e < m_entry_count; e++)
+    bytes += entry(e).size;
+  return bytes;
+}
+
+std::string
+bundle_hash_hex(const bundle_entry &entry)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  for (int i = 0; i < 32; i++) {
+    hex += digits[entry.sha256[i] >> 4];
+    hex += digits[entry.sha256[i] & 0xf];
+  }
+  return hex;
+}
+
+} // namespace vtd
@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "data_pattern.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VTD_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Below this many words a single thread is faster than spawning more
+constexpr size_t min_words_per_thread = 1 << 20;
+constexpr uint64_t key_span = uint64_t(1) << 32;
+
+/* Kernels working on a range that does not cross a 2^32 word boundary, so
+ * every word uses the same key and the low 32 bits of the index are
+ * 'base' + i.  Mismatch kernels return the offset within the range or
+ * vtd::pattern_match.
+ */
+using fill_fn = void (*)(uint32_t*, size_t, uint32_t, uint32_t);
+using verify_fn = size_t (*)(const uint32_t*, size_t, uint32_t, uint32_t);
+using compare_fn = size_t (*)(const uint32_t*, const uint32_t*, size_t);
+
+void
+fill_scalar(uint32_t *dst, size_t count, uint32_t base, uint32_t key)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] = vtd::pattern_hash((base + static_cast<uint32_t>(i)) ^ key);
+}
+
+size_t
+verify_scalar(const uint32_t *data, size_t count, uint32_t base, uint32_t key)
+{
+  for (size_t i = 0; i < count; i++) {
+    if (data[i] != vtd::pattern_hash((base + static_cast<uint32_t>(i)) ^ key))
+      return i;
+  }
+  return vtd::pattern_match;
+}
+
+size_t
+compare_scalar(const uint32_t *a, const uint32_t *b, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    if (a[i] != b[i])
+      return i;
+  }
+  return vtd::pattern_match;
+}
+
+#ifdef VTD_X86_SIMD
+
+__attribute__((target("avx2"))) inline __m256i
+hash_avx2(__m256i x)
+{
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+  return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+__attribute__((target("avx2"))) void
+fill_avx2(uint32_t *dst, size_t count, uint32_t base, uint32_t key)
+{
+  __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i step = _mm256_set1_epi32(8);
+  const __m256i k = _mm256_set1_epi32(static_cast<int>(key));
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), hash_avx2(_mm256_xor_si256(idx, k)));
+    idx = _mm256_add_epi32(idx, step);
+  }
+  fill_scalar(dst + i, count - i, base + static_cast<uint32_t>(i), key);
+}
+
+__attribute__((target("avx2"))) size_t
+verify_avx2(const uint32_t *data, size_t count, uint32_t base, uint32_t key)
+{
+  __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i step = _mm256_set1_epi32(8);
+  const __m256i k = _mm256_set1_epi32(static_cast<int>(key));
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i expected = hash_avx2(_mm256_xor_si256(idx, k));
+    __m256i actual = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(expected, actual)) != -1)
+      return i + verify_scalar(data + i, 8, base + static_cast<uint32_t>(i), key);
+    idx = _mm256_add_epi32(idx, step);
+  }
+
+  auto tail = verify_scalar(data + i, count - i, base + static_cast<uint32_t>(i), key);
+  return tail == vtd::pattern_match ? tail : i + tail;
+}
+
+__attribute__((target("avx2"))) size_t
+compare_avx2(const uint32_t *a, const uint32_t *b, size_t count)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(va, vb)) != -1)
+      return i + compare_scalar(a + i, b + i, 8);
+  }
+
+  auto tail = compare_scalar(a + i, b + i, count - i);
+  return tail == vtd::pattern_match ? tail : i + tail;
+}
+
+__attribute__((target("avx512f"))) inline __m512i
+hash_avx512(__m512i x)
+{
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x7feb352d));
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 15));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32(static_cast<int>(0x846ca68bU)));
+  return _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+}
+
+__attribute__((target("avx512f"))) void
+fill_avx512(uint32_t *dst, size_t count, uint32_t base, uint32_t key)
+{
+  __m512i idx = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(base)),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  const __m512i step = _mm512_set1_epi32(16);
+  const __m512i k = _mm512_set1_epi32(static_cast<int>(key));
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    _mm512_storeu_si512(dst + i, hash_avx512(_mm512_xor_si512(idx, k)));
+    idx = _mm512_add_epi32(idx, step);
+  }
+  fill_scalar(dst + i, count - i, base + static_cast<uint32_t>(i), key);
+}
+
+__attribute__((target("avx512f"))) size_t
+verify_avx512(const uint32_t *data, size_t count, uint32_t base, uint32_t key)
+{
+  __m512i idx = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(base)),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  const __m512i step = _mm512_set1_epi32(16);
+  const __m512i k = _mm512_set1_epi32(static_cast<int>(key));
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512i expected = hash_avx512(_mm512_xor_si512(idx, k));
+    __mmask16 diff = _mm512_cmpneq_epi32_mask(expected, _mm512_loadu_si512(data + i));
+    if (diff)
+      return i + __builtin_ctz(diff);
+    idx = _mm512_add_epi32(idx, step);
+  }
+
+  auto tail = verify_scalar(data + i, count - i, base + static_cast<uint32_t>(i), key);
+  return tail == vtd::pattern_match ? tail : i + tail;
+}
+
+__attribute__((target("avx512f"))) size_t
+compare_avx512(const uint32_t *a, const uint32_t *b, size_t count)
+{
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __mmask16 diff = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    if (diff)
+      return i + __builtin_ctz(diff);
+  }
+
+  auto tail = compare_scalar(a + i, b + i, count - i);
+  return tail == vtd::pattern_match ? tail : i + tail;
+}
+
+#endif
+
+struct kernels
+{
+  const char *isa;
+  fill_fn fill;
+  verify_fn verify;
+  compare_fn compare;
+};
+
+const kernels&
+select_kernels()
+{
+  static const kernels selected = [] {
+#ifdef VTD_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return kernels{"avx512", fill_avx512, verify_avx512, compare_avx512};
+    if (__builtin_cpu_supports("avx2"))
+      return kernels{"avx2", fill_avx2, verify_avx2, compare_avx2};
+#endif
+    return kernels{"scalar", fill_scalar, verify_scalar, compare_scalar};
+  }();
+  return selected;
+}
+
+// Run 'func(begin, count, base, key)' on the pieces of [begin, end) that share
+// a key, stopping at the first piece for which it returns true
+template <typename Func>
+void
+for_each_key_span(uint64_t seed, size_t begin, size_t end, Func &&func)
+{
+  while (begin < end) {
+    size_t span_end = std::min<uint64_t>(end, (begin / key_span + 1) * key_span);
+    if (func(begin, span_end - begin, static_cast<uint32_t>(begin), vtd::pattern_key(seed, begin)))
+      return;
+    begin = span_end;
+  }
+}
+
+} // namespace
+
+namespace vtd {
+
+void
+parallel_chunks(size_t count, unsigned int threads, const std::function<void(size_t, size_t)> &func)
+{
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned int>(std::min<size_t>(threads, std::max<size_t>(1, count / min_words_per_thread)));
+
+  // Keep chunk boundaries on a cache line of words
+  size_t chunk = ((count + threads - 1) / threads + 15) & ~size_t(15);
+
+  std::vector<std::thread> workers;
+  for (unsigned int t = 1; t < threads && t * chunk < count; t++)
+    workers.emplace_back(func, t * chunk, std::min(count, (t + 1) * chunk));
+
+  func(0, std::min(count, chunk));
+
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void
+fill_pattern(uint32_t *dst, size_t count, uint64_t seed, unsigned int threads)
+{
+  auto fill = select_kernels().fill;
+  parallel_chunks(count, threads, [=](size_t begin, size_t end) {
+    for_each_key_span(seed, begin, end, [=](size_t first, size_t n, uint32_t base, uint32_t key) {
+      fill(dst + first, n, base, key);
+      return false;
+    });
+  });
+}
+
+size_t
+compare_words(const uint32_t *a, const uint32_t *b, size_t count, unsigned int threads)
+{
+  auto compare = select_kernels().compare;
+  std::vector<size_t> first;
+  std::mutex lock;
+
+  parallel_chunks(count, threads, [&](size_t begin, size_t end) {
+    auto offset = compare(a + begin, b + begin, end - begin);
+    if (offset == pattern_match)
+      return;
+    std::lock_guard<std::mutex> guard(lock);
+    first.push_back(begin + offset);
+  });
+
+  return first.empty() ? pattern_match : *std::min_element(first.begin(), first.end());
+}
+
+size_t
+verify_pattern(const uint32_t *data, size_t count, uint64_t seed, unsigned int threads)
+{
+  auto verify = select_kernels().verify;
+  std::vector<size_t> first;
+  std::mutex lock;
+
+  parallel_chunks(count, threads, [&](size_t begin, size_t end) {
+    for_each_key_span(seed, begin, end, [&](size_t span, size_t n, uint32_t base, uint32_t key) {
+      auto offset = verify(data + span, n, base, key);
+      if (offset == pattern_match)
+        return false;
+      std::lock_guard<std::mutex> guard(lock);
+      first.push_back(span + offset);
+      return true;
+    });
+  });
+
+  return first.empty() ? pattern_match : *std::min_element(first.begin(), first.end());
+}
+
+const char*
+pattern_isa()
+{
+  return select_kernels().isa;
+}
+
+} // namespace vtd
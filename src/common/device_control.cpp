@@ -0,0 +1,428 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "device_control.h"
+#include "json.h"
+#include "power_modes.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// XRT includes
+#include "experimental/xrt_xclbin.h"
+
+#ifdef VTD_MOCK_XRT
+#include "mock_device.h"
+#endif
+
+namespace {
+
+std::string
+lower(std::string str)
+{
+  std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+  return str;
+}
+
+// Depth first search for the first value accepted by 'match'
+template <typename Match>
+const vtd::json_value*
+find_value(const vtd::json_value &value, Match &&match)
+{
+  if (match(value))
+    return &value;
+  if (value.is_object()) {
+    for (auto &member : value.as_object()) {
+      if (auto found = find_value(member.second, match))
+        return found;
+    }
+  } else if (value.is_array()) {
+    for (auto &item : value.as_array()) {
+      if (auto found = find_value(item, match))
+        return found;
+    }
+  }
+  return nullptr;
+}
+
+// Runs args[0], looked up in the PATH, with the remaining arguments as they
+// are, no shell involved.  Its standard output is discarded.  Returns the exit
+// status, -1 when the program could not be started or did not exit.
+int
+run_program(const std::vector<std::string> &args)
+{
+  std::vector<const char*> argv;
+  for (auto &arg : args)
+    argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+
+#ifdef _WIN32
+  return static_cast<int>(_spawnvp(_P_WAIT, argv[0], argv.data()));
+#else
+  pid_t child = fork();
+  if (child < 0)
+    return -1;
+  if (child == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0)
+      dup2(null, STDOUT_FILENO);
+    execvp(argv[0], const_cast<char* const*>(argv.data()));
+    _exit(127);
+  }
+  int status = 0;
+  while (waitpid(child, &status, 0) < 0) {
+    if (errno != EINTR)
+      return -1;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+std::string
+command_line(const std::vector<std::string> &args)
+{
+  std::string line;
+  for (auto &arg : args)
+    line += (line.empty() ? "" : " ") + arg;
+  return line;
+}
+
+// xrt-smi reports numbers as strings in places
+double
+to_number(const vtd::json_value &value)
+{
+  return value.is_number() ? value.as_double() : std::stod(value.as_string());
+}
+
+class xrt_smi_control : public vtd::device_control
+{
+public:
+  explicit xrt_smi_control(const xrt::device &device)
+    : m_bdf(device.get_info<xrt::info::device::bdf>())
+  {
+    auto smi = std::getenv("VTD_XRT_SMI");
+    m_smi = smi ? smi : "xrt-smi";
+  }
+
+  std::string
+  device_id() override
+  {
+    // The sysfs node of the PCI function has both ids as 0x prefixed hex
+    auto node = std::filesystem::path("/sys/bus/pci/devices") / m_bdf;
+    auto read_id = [&node, this](const char *name) {
+      std::ifstream ifs(node / name);
+      std::string value;
+      if (!(ifs >> value) || value.rfind("0x", 0) != 0)
+        throw std::runtime_error("Error: Failed to read the PCI " + std::string(name) + " id of " + m_bdf + "\n");
+      return lower(value.substr(2));
+    };
+    return read_id("device") + "_" + read_id("revision");
+  }
+
+  unsigned int
+  aie_clock_mhz() override
+  {
+    // The platform report lists the clocks as {"id": ..., "freq_mhz": ...}
+    auto report = examine("platform");
+    auto clock = find_value(report, [](const vtd::json_value &v) {
+      if (!v.is_object() || !v.find("freq_mhz"))
+        return false;
+      auto id = lower(v.get_string("id", v.get_string("description", "")));
+      return id.find("h clock") != std::string::npos || id.find("hclk") != std::string::npos
+             || id.find("h-clk") != std::string::npos || id.find("h clk") != std::string::npos;
+    });
+    if (!clock)
+      throw std::runtime_error("Error: " + m_smi + " does not report the AIE H clock of " + m_bdf + "\n");
+    return static_cast<unsigned int>(to_number(clock->at("freq_mhz")));
+  }
+
+  std::string
+  power_mode() override
+  {
+    auto report = examine("platform");
+    auto mode = find_value(report, [](const vtd::json_value &v) {
+      if (!v.is_object())
+        return false;
+      for (auto &member : v.as_object()) {
+        auto key = lower(member.first);
+        if (member.second.is_string() && (key == "power_mode" || key == "performance_mode" || key == "power mode"))
+          return true;
+      }
+      return false;
+    });
+    if (!mode)
+      throw std::runtime_error("Error: " + m_smi + " does not report the power mode of " + m_bdf + "\n");
+    for (auto &member : mode->as_object()) {
+      auto key = lower(member.first);
+      if (key == "power_mode" || key == "performance_mode" || key == "power mode")
+        return lower(member.second.as_string());
+    }
+    return "";
+  }
+
+  void
+  set_power_mode(const std::string &mode) override
+  {
+    if (!vtd::pmode_clocks().count(mode))
+      throw std::runtime_error("Error: Unknown power mode " + mode + "\n");
+    configure({"--pmode", mode});
+  }
+
+  double
+  power_watts() override
+  {
+    // Reported as a numeric power value next to the power mode, under a key
+    // that differs between xrt-smi versions
+    auto is_power = [](const std::string &name) {
+      auto key = lower(name);
+      return key.find("power") != std::string::npos && key.find("mode") == std::string::npos;
+    };
+    auto report = examine("platform");
+    const vtd::json_value *watts = nullptr;
+    find_value(report, [&](const vtd::json_value &v) {
+      if (!v.is_object())
+        return false;
+      for (auto &member : v.as_object()) {
+        if (!is_power(member.first) || !(member.second.is_number() || member.second.is_string()))
+          continue;
+        try {
+          to_number(member.second);
+          watts = &member.second;
+          return true;
+        }
+        catch (const std::exception&) {
+        }
+      }
+      return false;
+    });
+    if (!watts)
+      throw std::runtime_error("Error: " + m_smi + " does not report the power draw of " + m_bdf + "\n");
+    return to_number(*watts);
+  }
+
+  void
+  set_force_preemption(bool enable) override
+  {
+    configure({"--force-preemption", enable ? "enable" : "disable"});
+  }
+
+private:
+  vtd::json_value
+  examine(const std::string &report)
+  {
+    auto out = report_file(report);
+    auto remove_out = [&out] {
+      std::error_code ec;
+      std::filesystem::remove(out, ec);
+    };
+    std::vector<std::string> args = {m_smi, "examine", "-d", m_bdf, "-r", report, "-f", "JSON", "-o", out, "--force"};
+    if (run_program(args) != 0) {
+      remove_out();
+      throw std::runtime_error("Error: Failed to run '" + command_line(args) + "'\n");
+    }
+
+    try {
+      auto doc = vtd::load_json(out);
+      remove_out();
+      return doc;
+    }
+    catch (...) {
+      remove_out();
+      throw;
+    }
+  }
+
+  // Changing the device state needs root, it is not escalated behind the
+  // caller's back
+  void
+  configure(const std::vector<std::string> &options)
+  {
+    std::vector<std::string> args = {m_smi, "configure", "-d", m_bdf};
+    args.insert(args.end(), options.begin(), options.end());
+#ifndef _WIN32
+    if (geteuid() != 0)
+      throw std::runtime_error("Error: '" + command_line(args) + "' needs root, run as root or set "
+                               "VTD_DEVICE_CONTROL=stub\n");
+#endif
+    if (run_program(args) != 0)
+      throw std::runtime_error("Error: Failed to run '" + command_line(args) + "'\n");
+  }
+
+  // A fresh file of our own for xrt-smi to write the report to, created
+  // exclusively under an unpredictable name
+  static std::string
+  report_file(const std::string &report)
+  {
+    auto path = (std::filesystem::temp_directory_path() / ("vtd_" + report + "_XXXXXX")).string();
+#ifdef _WIN32
+    if (_mktemp_s(path.data(), path.size() + 1) != 0)
+      throw std::runtime_error("Error: Failed to create a temporary file for the " + report + " report\n");
+    return path + ".json";
+#else
+    path += ".json";
+    int fd = mkstemps(path.data(), 5);
+    if (fd < 0)
+      throw std::runtime_error("Error: Failed to create a temporary file for the " + report + " report\n");
+    close(fd);
+    return path;
+#endif
+  }
+
+  std::string m_bdf;
+  std::string m_smi;
+};
+
+#ifdef VTD_MOCK_XRT
+class mock_control : public vtd::device_control
+{
+public:
+  explicit mock_control(const xrt::device &device)
+    : m_device(device)
+  {}
+
+  std::string
+  device_id() override
+  {
+    return vtd_mock::device_id(m_device);
+  }
+
+  unsigned int
+  aie_clock_mhz() override
+  {
+    return vtd_mock::aie_clock_mhz(m_device);
+  }
+
+  std::string
+  power_mode() override
+  {
+    return vtd_mock::power_mode(m_device);
+  }
+
+  void
+  set_power_mode(const std::string &mode) override
+  {
+    vtd_mock::set_power_mode(m_device, mode);
+  }
+
+  double
+  power_watts() override
+  {
+    return vtd_mock::power_watts(m_device);
+  }
+
+  void
+  set_force_preemption(bool enable) override
+  {
+    vtd_mock::set_force_preemption(m_device, enable);
+  }
+
+private:
+  xrt::device m_device;
+};
+#endif
+
+// Local power mode and force preemption on top of another controller
+class stub_control : public vtd::device_control
+{
+public:
+  explicit stub_control(std::unique_ptr<vtd::device_control> base)
+    : m_base(std::move(base))
+  {}
+
+  std::string
+  device_id() override
+  {
+    return m_base->device_id();
+  }
+
+  unsigned int
+  aie_clock_mhz() override
+  {
+    return vtd::pmode_clocks().at(power_mode());
+  }
+
+  std::string
+  power_mode() override
+  {
+    auto mode = std::getenv("VTD_STUB_PMODE");
+    return mode && vtd::pmode_clocks().count(mode) ? mode : "default";
+  }
+
+  void
+  set_power_mode(const std::string &mode) override
+  {
+    if (!vtd::pmode_clocks().count(mode))
+      throw std::runtime_error("Error: Unknown power mode " + mode + "\n");
+    export_env("VTD_STUB_PMODE", mode);
+  }
+
+  double
+  power_watts() override
+  {
+    return m_base->power_watts();
+  }
+
+  void
+  set_force_preemption(bool enable) override
+  {
+    export_env("VTD_STUB_FORCE_PREEMPTION", enable ? "enable" : "disable");
+  }
+
+private:
+  static void
+  export_env(const char *name, const std::string &value)
+  {
+#ifndef _WIN32
+    setenv(name, value.c_str(), 1);
+#else
+    _putenv_s(name, value.c_str());
+#endif
+  }
+
+  std::unique_ptr<vtd::device_control> m_base;
+};
+
+} // namespace
+
+namespace vtd {
+
+std::unique_ptr<device_control>
+make_device_control(const xrt::device &device)
+{
+#ifdef VTD_MOCK_XRT
+  std::unique_ptr<device_control> control = std::make_unique<mock_control>(device);
+#else
+  std::unique_ptr<device_control> control = std::make_unique<xrt_smi_control>(device);
+#endif
+  auto kind = std::getenv("VTD_DEVICE_CONTROL");
+  if (kind && std::string(kind) == "stub")
+    return std::make_unique<stub_control>(std::move(control));
+  return control;
+}
+
+unsigned int
+xclbin_partition_columns(const xrt::xclbin &xclbin)
+{
+  auto partition = xclbin.get_axlf_section<const aie_partition*>(AIE_PARTITION);
+  if (!partition || !partition->info.column_width)
+    throw std::runtime_error("Error: xclbin has no AIE partition section\n");
+  return partition->info.column_width;
+}
+
+} // namespace vtd
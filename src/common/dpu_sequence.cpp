@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "dpu_sequence.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace {
+
+constexpr size_t dpu_instr_str_len = 8;
+constexpr uint8_t hex_invalid = 0x10;
+constexpr char cache_magic[8] = {'V', 'T', 'D', 'S', 'E', 'Q', '0', '1'};
+
+// Header of the binary image cached next to the DPU sequence text file.  The
+// size and modification time of the text file tell whether the image is stale.
+struct cache_header
+{
+  char magic[8];
+  uint64_t src_size;
+  int64_t src_mtime;
+  uint64_t words;
+};
+
+// ASCII to nibble lookup, anything that is not a hex digit maps to hex_invalid
+constexpr std::array<uint8_t, 256>
+make_hex_table()
+{
+  std::array<uint8_t, 256> table {};
+  for (auto &v : table)
+    v = hex_invalid;
+  for (int c = '0'; c <= '9'; c++)
+    table[c] = static_cast<uint8_t>(c - '0');
+  for (int c = 'a'; c <= 'f'; c++)
+    table[c] = static_cast<uint8_t>(c - 'a' + 10);
+  for (int c = 'A'; c <= 'F'; c++)
+    table[c] = static_cast<uint8_t>(c - 'A' + 10);
+  return table;
+}
+
+constexpr auto hex_table = make_hex_table();
+
+/* Decode exactly 8 hex digits.  The invalid marker of every digit is OR-ed
+ * together so there is a single branch per word instead of one per digit.
+ */
+inline bool
+decode_word(const char *p, uint32_t &word)
+{
+  uint32_t w = 0;
+  uint8_t bad = 0;
+  for (size_t i = 0; i < dpu_instr_str_len; i++) {
+    uint8_t v = hex_table[static_cast<unsigned char>(p[i])];
+    bad |= v;
+    w = (w << 4) | (v & 0xf);
+  }
+  word = w;
+  return !(bad & hex_invalid);
+}
+
+bool
+source_stat(const std::string &fname, uint64_t &size, int64_t &mtime)
+{
+  std::error_code ec;
+  size = std::filesystem::file_size(fname, ec);
+  if (ec)
+    return false;
+  auto time = std::filesystem::last_write_time(fname, ec);
+  if (ec)
+    return false;
+  mtime = static_cast<int64_t>(time.time_since_epoch().count());
+  return true;
+}
+
+bool
+load_cached(const xrt::device &device, const xrt::kernel &kernel, const std::string &fname,
+            int instr_argidx, vtd::dpu_instr &instr)
+{
+  uint64_t src_size;
+  int64_t src_mtime;
+  if (!source_stat(fname, src_size, src_mtime))
+    return false;
+
+  std::ifstream ifs(vtd::dpu_sequence_cache_name(fname), std::ios::binary);
+  if (!ifs.is_open())
+    return false;
+
+  cache_header hdr;
+  if (!ifs.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)))
+    return false;
+
+  if (std::memcmp(hdr.magic, cache_magic, sizeof(cache_magic)) || hdr.src_size != src_size
+      || hdr.src_mtime != src_mtime || hdr.words == 0)
+    return false;
+
+  auto bo = xrt::bo(device, hdr.words * sizeof(uint32_t), XCL_BO_FLAGS_CACHEABLE, kernel.group_id(instr_argidx));
+  if (!ifs.read(bo.map<char*>(), hdr.words * sizeof(uint32_t)))
+    return false;
+
+  instr.bo = bo;
+  instr.size = hdr.words;
+  return true;
+}
+
+// Best effort: a read-only sequence directory simply means no cache
+void
+store_cached(const std::string &fname, const uint32_t *words, size_t count)
+{
+  cache_header hdr;
+  std::memcpy(hdr.magic, cache_magic, sizeof(cache_magic));
+  hdr.words = count;
+  if (!source_stat(fname, hdr.src_size, hdr.src_mtime))
+    return;
+
+  // Write to a private file first so concurrent loaders never see a partial
+  // image.  Thread ids repeat across processes, so the name has the pid too.
+#ifdef _WIN32
+  auto pid = _getpid();
+#else
+  auto pid = getpid();
+#endif
+  auto cache = vtd::dpu_sequence_cache_name(fname);
+  auto tmp = cache + ".tmp" + std::to_string(pid) + "."
+             + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+      return;
+    ofs.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    ofs.write(reinterpret_cast<const char*>(words), count * sizeof(uint32_t));
+    if (!ofs)
+      return;
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp, cache, ec);
+  if (ec)
+    std::filesystem::remove(tmp, ec);
+}
+
+// Transaction opcodes
+constexpr uint32_t op_write = 0x00, op_blockwrite = 0x01, op_maskwrite = 0x03, op_maskpoll = 0x04;
+constexpr uint32_t op_custom = 0x80, op_tct = 0x80;
+
+/* Call 'visit(opcode, pos, size)' for every operation of a transaction format
+ * sequence, 'pos' and 'size' in words.  Returns false when the sequence is not
+ * in transaction format or holds an operation whose size is unknown.
+ */
+bool
+for_each_txn_op(const uint32_t *words, size_t count, const std::function<void(uint32_t, size_t, size_t)> &visit)
+{
+  constexpr size_t header_words = 4;
+  if (count < header_words || words[3] < header_words * sizeof(uint32_t) || words[3] > count * sizeof(uint32_t))
+    return false;
+
+  size_t end = words[3] / sizeof(uint32_t);
+  size_t pos = header_words;
+  for (uint32_t op = 0; op < words[2]; op++) {
+    if (pos >= end)
+      return false;
+
+    // Plain register ops have a fixed size, the others carry theirs
+    uint32_t opcode = words[pos] & 0xff;
+    size_t size;
+    if (opcode == op_write)
+      size = 6;
+    else if (opcode == op_maskwrite || opcode == op_maskpoll)
+      size = 7;
+    else if ((opcode == op_blockwrite && pos + 3 < end) || (opcode >= op_custom && pos + 1 < end))
+      size = words[pos + (opcode == op_blockwrite ? 3 : 1)] / sizeof(uint32_t);
+    else
+      return false;
+    if (size < 2 || pos + size > end)
+      return false;
+
+    visit(opcode, pos, size);
+    pos += size;
+  }
+  return true;
+}
+
+} // namespace
+
+namespace vtd {
+
+mapped_file::
+mapped_file(const std::string &fname)
+{
+#ifndef _WIN32
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
+
+  struct stat st {};
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      madvise(addr, st.st_size, MADV_SEQUENTIAL);
+      m_data = static_cast<const char*>(addr);
+      m_size = st.st_size;
+      m_mapped = true;
+    }
+  }
+  close(fd);
+  if (m_mapped || st.st_size == 0)
+    return;
+#endif
+
+  std::ifstream ifs(fname, std::ios::binary);
+  if (!ifs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
+
+  std::ostringstream ss;
+  ss << ifs.rdbuf();
+  m_buf = ss.str();
+  m_data = m_buf.data();
+  m_size = m_buf.size();
+}
+
+mapped_file::
+~mapped_file()
+{
+#ifndef _WIN32
+  if (m_mapped)
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+size_t
+parse_dpu_sequence(const char *begin, const char *end, uint32_t *out)
+{
+  const char *p = begin;
+  uint32_t *instr = out;
+
+  while (p < end) {
+    // Comments within the file are identified by a '#' prefix
+    if (*p == '#') {
+      auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      p = eol ? eol + 1 : end;
+      continue;
+    }
+
+    // Tolerate blank lines and DOS line endings
+    if (*p == '\n' || *p == '\r') {
+      p++;
+      continue;
+    }
+
+    uint32_t word;
+    if (static_cast<size_t>(end - p) < dpu_instr_str_len || !decode_word(p, word))
+      throw std::runtime_error("Error: Invalid DPU instruction at offset " + std::to_string(p - begin) + "\n");
+
+    p += dpu_instr_str_len;
+    if (p < end && *p == '\r')
+      p++;
+    if (p < end && *p != '\n')
+      throw std::runtime_error("Error: Invalid DPU instruction size\n");
+
+    *(instr++) = word;
+    p++;
+  }
+
+  return instr - out;
+}
+
+dpu_sequence_syncs
+scan_dpu_sequence_syncs(const uint32_t *words, size_t count)
+{
+  dpu_sequence_syncs syncs;
+  syncs.valid = for_each_txn_op(words, count, [&](uint32_t opcode, size_t pos, size_t size) {
+    // Sync words: direction, row and column, then row_num, col_num and channel
+    if (opcode != op_tct || size < 4)
+      return;
+    uint32_t column = (words[pos + 2] >> 16) & 0xff;
+    uint32_t row_num = (words[pos + 3] >> 8) & 0xff;
+    uint32_t col_num = (words[pos + 3] >> 16) & 0xff;
+    syncs.ops++;
+    syncs.tokens += std::max(row_num, 1u) * std::max(col_num, 1u);
+    for (uint32_t c = column; c < column + std::max(col_num, 1u) && c < 64; c++)
+      syncs.column_mask |= uint64_t(1) << c;
+  });
+  return syncs;
+}
+
+size_t
+patch_dpu_sequence_bd_lengths(uint32_t *words, size_t count, uint32_t old_length, uint32_t new_length)
+{
+  // Shim tile DMA buffer descriptors, 8 words each with the length first
+  constexpr uint32_t shim_bd_base = 0x1d000, shim_bd_stride = 0x20, shim_bd_count = 16;
+  constexpr uint32_t tile_offset_mask = 0xfffff;
+
+  std::vector<uint32_t*> lengths;
+  auto length_word = [&](uint32_t regoff, uint32_t *word) {
+    uint32_t offset = regoff & tile_offset_mask;
+    if (offset >= shim_bd_base && offset < shim_bd_base + shim_bd_count * shim_bd_stride &&
+        (offset - shim_bd_base) % shim_bd_stride == 0 && *word == old_length)
+      lengths.push_back(word);
+  };
+
+  // BDs are written whole by a block write or word by word
+  bool valid = for_each_txn_op(words, count, [&](uint32_t opcode, size_t pos, size_t size) {
+    if (opcode == op_blockwrite && size > 4)
+      length_word(words[pos + 2], &words[pos + 4]);
+    else if (opcode == op_write)
+      length_word(words[pos + 2], &words[pos + 4]);
+  });
+  if (!valid)
+    return 0;
+
+  for (auto word : lengths)
+    *word = new_length;
+  return lengths.size();
+}
+
+std::string
+dpu_sequence_cache_name(const std::string &fname)
+{
+  return fname + ".bin";
+}
+
+dpu_instr
+load_dpu_sequence(const xrt::device &device, const xrt::kernel &kernel, const std::string &fname,
+                  int instr_argidx, bool use_cache)
+{
+  dpu_instr instr;
+
+  if (!use_cache || !load_cached(device, kernel, fname, instr_argidx, instr)) {
+    mapped_file file(fname);
+
+    // The BO is sized for the worst case so the words can be decoded straight
+    // into it without counting the lines first
+    size_t capacity = dpu_sequence_max_words(file.size());
+    if (capacity == 0)
+      throw std::runtime_error("Error: Invalid DPU instruction length");
+
+    instr.bo = xrt::bo(device, capacity * sizeof(uint32_t), XCL_BO_FLAGS_CACHEABLE, kernel.group_id(instr_argidx));
+    auto words = instr.bo.map<uint32_t*>();
+    instr.size = parse_dpu_sequence(file.data(), file.data() + file.size(), words);
+    if (instr.size == 0)
+      throw std::runtime_error("Error: Invalid DPU instruction length");
+
+    if (use_cache)
+      store_cached(fname, words, instr.size);
+  }
+
+  instr.bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  return instr;
+}
+
+} // namespace vtd
@@ -0,0 +1,642 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "fw_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t out_buffer_size = 1 << 20;
+
+// Largest value a lookup table is expanded to, the firmware ones stay below 1K
+constexpr uint64_t max_table_value = 1 << 16;
+
+// Parse a decimal object key such as the event ids and lookup values
+uint64_t
+parse_key(const std::string &key)
+{
+  size_t pos = 0;
+  auto value = std::stoull(key, &pos, 0);
+  if (pos != key.size())
+    throw std::runtime_error("Error: Invalid numeric key '" + key + "'\n");
+  return value;
+}
+
+vtd::trace_names
+make_names(const std::vector<std::pair<uint64_t, std::string>> &entries)
+{
+  vtd::trace_names table;
+  uint64_t max_value = 0;
+  for (auto &entry : entries)
+    max_value = std::max(max_value, entry.first);
+  if (max_value >= max_table_value)
+    throw std::runtime_error("Error: Lookup value " + std::to_string(max_value) + " is out of range\n");
+
+  table.index.assign(entries.empty() ? 0 : max_value + 1, -1);
+  for (auto &entry : entries) {
+    table.index[entry.first] = static_cast<int32_t>(table.names.size());
+    table.names.push_back(vtd::json_quote(entry.second));
+  }
+  return table;
+}
+
+// "0x{:04X}" and "08x" style formats select zero padded hex
+void
+set_format(vtd::trace_field &field, const std::string &format)
+{
+  auto brace = format.find("{:0");
+  if (format.rfind("0x", 0) == 0 && brace != std::string::npos
+      && (format.back() == '}' && (format[format.size() - 2] == 'X' || format[format.size() - 2] == 'x'))) {
+    field.style = vtd::trace_field::render::hex;
+    field.hex_digits = std::stoul(format.substr(brace + 3));
+  }
+  else if (!format.empty() && format[0] == '0' && (format.back() == 'x' || format.back() == 'X')) {
+    field.style = vtd::trace_field::render::hex;
+    field.hex_digits = std::stoul(format);
+  }
+}
+
+int64_t
+sign_extend(uint64_t value, unsigned int width)
+{
+  if (width >= 64)
+    return static_cast<int64_t>(value);
+  auto shift = 64 - width;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+} // namespace
+
+namespace vtd {
+
+trace_json_writer::
+trace_json_writer(const std::string &fname)
+  : m_buf(out_buffer_size)
+{
+  m_file = std::fopen(fname.c_str(), "wb");
+  if (!m_file)
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+  write("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+}
+
+trace_json_writer::
+~trace_json_writer()
+{
+  if (!m_finished && m_pos)
+    std::fwrite(m_buf.data(), 1, m_pos, m_file);
+  std::fclose(m_file);
+}
+
+void
+trace_json_writer::
+reserve(size_t size)
+{
+  if (m_pos + size <= m_buf.size())
+    return;
+  if (m_pos && std::fwrite(m_buf.data(), 1, m_pos, m_file) != m_pos)
+    throw std::runtime_error("Error: Failure writing the trace output\n");
+  m_pos = 0;
+  if (size > m_buf.size())
+    m_buf.resize(size);
+}
+
+void
+trace_json_writer::
+next_event()
+{
+  if (m_first) {
+    m_first = false;
+    return;
+  }
+  write(",\n");
+}
+
+void
+trace_json_writer::
+write(const char *data, size_t size)
+{
+  reserve(size);
+  std::memcpy(m_buf.data() + m_pos, data, size);
+  m_pos += size;
+}
+
+void
+trace_json_writer::
+write_uint(uint64_t value)
+{
+  char digits[20];
+  int n = 0;
+  do {
+    digits[n++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  reserve(n);
+  while (n)
+    m_buf[m_pos++] = digits[--n];
+}
+
+void
+trace_json_writer::
+write_int(int64_t value)
+{
+  if (value < 0) {
+    write("-");
+    write_uint(static_cast<uint64_t>(0) - static_cast<uint64_t>(value));
+  }
+  else
+    write_uint(static_cast<uint64_t>(value));
+}
+
+void
+trace_json_writer::
+write_hex(uint64_t value, unsigned int digits)
+{
+  static const char hex[] = "0123456789abcdef";
+  unsigned int n = 1;
+  while (n < 16 && (value >> (4 * n)))
+    n++;
+  n = std::max(n, std::min(digits, 16u));
+
+  reserve(n + 4);
+  m_buf[m_pos++] = '"';
+  m_buf[m_pos++] = '0';
+  m_buf[m_pos++] = 'x';
+  for (unsigned int i = n; i--;)
+    m_buf[m_pos++] = hex[(value >> (4 * i)) & 0xf];
+  m_buf[m_pos++] = '"';
+}
+
+void
+trace_json_writer::
+write_us(uint64_t ns)
+{
+  write_uint(ns / 1000);
+  auto frac = static_cast<unsigned int>(ns % 1000);
+  if (!frac)
+    return;
+  reserve(4);
+  m_buf[m_pos++] = '.';
+  m_buf[m_pos++] = static_cast<char>('0' + frac / 100);
+  m_buf[m_pos++] = static_cast<char>('0' + frac / 10 % 10);
+  m_buf[m_pos++] = static_cast<char>('0' + frac % 10);
+}
+
+void
+trace_json_writer::
+write_string(const char *data, size_t size)
+{
+  static const char hex[] = "0123456789abcdef";
+  size = std::find(data, data + size, '\0') - data;
+
+  // Worst case every character becomes a \u00XX escape
+  reserve(size * 6 + 2);
+  m_buf[m_pos++] = '"';
+  for (size_t i = 0; i < size; i++) {
+    auto c = static_cast<unsigned char>(data[i]);
+    if (c == '"' || c == '\\') {
+      m_buf[m_pos++] = '\\';
+      m_buf[m_pos++] = static_cast<char>(c);
+    }
+    else if (c < 0x20) {
+      std::memcpy(m_buf.data() + m_pos, "\\u00", 4);
+      m_buf[m_pos + 4] = hex[c >> 4];
+      m_buf[m_pos + 5] = hex[c & 0xf];
+      m_pos += 6;
+    }
+    else
+      m_buf[m_pos++] = static_cast<char>(c);
+  }
+  m_buf[m_pos++] = '"';
+}
+
+void
+trace_json_writer::
+finish()
+{
+  write("\n]}\n");
+  m_finished = true;
+  bool failed = std::fwrite(m_buf.data(), 1, m_pos, m_file) != m_pos || std::fflush(m_file) != 0;
+  m_pos = 0;
+  if (failed)
+    throw std::runtime_error("Error: Failure writing the trace output\n");
+}
+
+trace_schema::
+trace_schema(const json_value &doc)
+{
+  auto &format = doc.at("data_format");
+  m_event_bits = static_cast<unsigned int>(format.at("event_bits").as_uint());
+  auto payload_bits = format.at("payload_bits").as_uint();
+  if (m_event_bits == 0 || m_event_bits > 16 || m_event_bits + payload_bits != 64)
+    throw std::runtime_error("Error: Unsupported trace format of " + std::to_string(m_event_bits) + " event and "
+                             + std::to_string(payload_bits) + " payload bits\n");
+
+  // Lookup names are matched exactly, an argument naming a table that does
+  // not exist keeps its numeric value
+  std::vector<std::string> table_names;
+  if (auto lookups = doc.find("lookups")) {
+    for (auto &lookup : lookups->as_object()) {
+      std::vector<std::pair<uint64_t, std::string>> entries;
+      for (auto &entry : lookup.second.as_object())
+        entries.emplace_back(parse_key(entry.first), entry.second.as_string());
+      table_names.push_back(lookup.first);
+      m_tables.push_back(make_names(entries));
+    }
+  }
+
+  m_index.assign(size_t(1) << m_event_bits, -1);
+  std::vector<uint64_t> pair_ids;
+  for (auto &member : doc.at("events").as_object()) {
+    auto id = parse_key(member.first);
+    if (id >= m_index.size())
+      throw std::runtime_error("Error: Event id " + member.first + " exceeds the event bits\n");
+    auto &def = member.second;
+
+    event ev;
+    ev.name = def.at("name").as_string();
+    ev.label = json_quote(ev.name);
+    auto type = def.find("type");
+    if (type && type->is_string())
+      ev.type = type->as_string() == "start" ? phase::begin : type->as_string() == "done" ? phase::end : phase::instant;
+
+    std::string category;
+    if (auto categories = def.find("categories")) {
+      for (auto &cat : categories->as_array())
+        category += (category.empty() ? "" : ",") + cat.as_string();
+    }
+
+    auto span = ev.name;
+    for (auto suffix : {"_START", "_DONE"}) {
+      auto len = std::strlen(suffix);
+      if (span.size() > len && span.compare(span.size() - len, len, suffix) == 0)
+        span.erase(span.size() - len);
+    }
+    ev.span = json_quote(span);
+
+    for (auto &arg : def.at("args").as_array()) {
+      trace_field field;
+      auto name = arg.at("name").as_string();
+      field.key = json_quote(name) + ":";
+      field.start = static_cast<unsigned int>(arg.at("start").as_uint());
+      field.width = static_cast<unsigned int>(arg.at("width").as_uint());
+      if (!field.width || field.start + field.width > payload_bits)
+        throw std::runtime_error("Error: Argument " + name + " of " + ev.name + " exceeds the payload\n");
+      field.is_signed = arg.get_bool("signed", false);
+      set_format(field, arg.get_string("format", ""));
+
+      auto lookup = std::find(table_names.begin(), table_names.end(), arg.get_string("lookup", ""));
+      if (lookup != table_names.end()) {
+        field.style = trace_field::render::name;
+        field.table = static_cast<int>(lookup - table_names.begin());
+        if (ev.name_field < 0)
+          ev.name_field = static_cast<int>(ev.fields.size());
+      }
+      if (name == "context_id")
+        ev.tid_field = static_cast<int>(ev.fields.size());
+      ev.fields.push_back(std::move(field));
+    }
+
+    static const char *phases[] = {"i\",\"s\":\"t", "B", "E"};
+    ev.head = ",\"cat\":" + json_quote(category.empty() ? "firmware" : category) + ",\"ph\":\""
+              + phases[static_cast<int>(ev.type)] + "\",\"ts\":";
+
+    m_index[id] = static_cast<int32_t>(m_events.size());
+    m_ids.push_back(static_cast<uint32_t>(id));
+    pair_ids.push_back(def.get_int("pair", -1) < 0 ? ~uint64_t(0) : def.at("pair").as_uint());
+    m_events.push_back(std::move(ev));
+  }
+
+  for (size_t i = 0; i < m_events.size(); i++) {
+    if (m_events[i].type == phase::instant)
+      continue;
+    if (pair_ids[i] >= m_index.size() || m_index[pair_ids[i]] < 0)
+      throw std::runtime_error("Error: Event " + m_events[i].name + " pairs with an undefined event\n");
+    m_events[i].pair = m_index[pair_ids[i]];
+  }
+}
+
+trace_schema
+trace_schema::
+load(const std::string &fname)
+{
+  auto doc = load_json(fname);
+  try {
+    return trace_schema(doc);
+  }
+  catch (const std::runtime_error &e) {
+    throw std::runtime_error(fname + ": " + e.what());
+  }
+}
+
+uint32_t
+trace_schema::
+id(const std::string &name) const
+{
+  for (size_t i = 0; i < m_events.size(); i++) {
+    if (m_events[i].name == name)
+      return m_ids[i];
+  }
+  throw std::runtime_error("Error: Trace schema has no event " + name + "\n");
+}
+
+trace_decoder::
+trace_decoder(const trace_schema &schema, double ticks_per_us)
+  : m_schema(schema)
+  , m_ns_per_tick(1000.0 / ticks_per_us)
+{
+  // A begin event owns one span per name its naming field can take and a
+  // last one for everything else
+  size_t slots = 0;
+  for (size_t i = 0; i < schema.event_count(); i++) {
+    auto &ev = schema.event_at(i);
+    m_span_base.push_back(slots);
+    if (ev.type != trace_schema::phase::begin)
+      continue;
+
+    if (ev.name_field >= 0) {
+      for (auto &name : schema.names(ev.fields[ev.name_field].table).names)
+        m_span_names.push_back(name.substr(1, name.size() - 2));
+    }
+    m_span_names.push_back(ev.span.substr(1, ev.span.size() - 2));
+    slots = m_span_names.size();
+  }
+  m_span_hist.resize(slots);
+  m_open_ts.assign(schema.event_count() * max_tids, 0);
+  m_open_span.assign(schema.event_count() * max_tids, -1);
+}
+
+void
+trace_decoder::
+decode(const char *begin, const char *end, trace_json_writer *out)
+{
+  const unsigned int event_bits = m_schema.event_bits();
+  const uint64_t event_mask = (uint64_t(1) << event_bits) - 1;
+
+  for (auto p = begin; p + 2 * sizeof(uint64_t) <= end; p += 2 * sizeof(uint64_t)) {
+    uint64_t ticks;
+    uint64_t word;
+    std::memcpy(&ticks, p, sizeof(ticks));
+    std::memcpy(&word, p + sizeof(ticks), sizeof(word));
+    m_records++;
+
+    auto ev = m_schema.find(static_cast<uint32_t>(word & event_mask));
+    if (!ev) {
+      m_unknown++;
+      continue;
+    }
+    uint64_t payload = word >> event_bits;
+    auto ns = static_cast<uint64_t>(ticks * m_ns_per_tick);
+    unsigned int tid = ev->tid_field < 0 ? 0 : static_cast<unsigned int>(ev->fields[ev->tid_field].extract(payload)) + 1;
+    if (tid >= max_tids)
+      tid = 0;
+
+    // Span bookkeeping, the slot of a begin event is found by its index
+    auto index = static_cast<size_t>(ev - &m_schema.event_at(0));
+    auto name = &ev->span;
+    if (ev->type == trace_schema::phase::begin) {
+      auto span = m_span_base[index];
+      if (ev->name_field >= 0) {
+        auto &field = ev->fields[ev->name_field];
+        auto &table = m_schema.names(field.table);
+        auto entry = table.find(field.extract(payload));
+        if (entry >= 0) {
+          span += entry;
+          name = &table.names[entry];
+        }
+        else
+          span += table.names.size();
+      }
+      m_open_ts[index * max_tids + tid] = ns;
+      m_open_span[index * max_tids + tid] = static_cast<int64_t>(span);
+    }
+    else if (ev->type == trace_schema::phase::end) {
+      auto slot = static_cast<size_t>(ev->pair) * max_tids + tid;
+      auto span = m_open_span[slot];
+      if (span < 0)
+        m_unmatched++;
+      else {
+        auto &hist = m_span_hist[span];
+        if (!hist)
+          hist = std::make_unique<latency_histogram>();
+        hist->record_ns(ns >= m_open_ts[slot] ? ns - m_open_ts[slot] : 0);
+        m_open_span[slot] = -1;
+      }
+    }
+
+    if (!out)
+      continue;
+
+    out->next_event();
+    out->write("{\"name\":");
+    out->write(ev->type == trace_schema::phase::begin ? *name : ev->label);
+    out->write(ev->head);
+    out->write_us(ns);
+    out->write(",\"pid\":0,\"tid\":");
+    out->write_uint(tid);
+    out->write(",\"args\":{");
+    bool first = true;
+    for (auto &field : ev->fields) {
+      if (!first)
+        out->write(",");
+      first = false;
+      out->write(field.key);
+      auto value = field.extract(payload);
+      if (field.style == trace_field::render::name) {
+        auto &table = m_schema.names(field.table);
+        auto entry = table.find(value);
+        if (entry >= 0) {
+          out->write(table.names[entry]);
+          continue;
+        }
+      }
+      if (field.style == trace_field::render::hex)
+        out->write_hex(value, field.hex_digits);
+      else if (field.is_signed)
+        out->write_int(sign_extend(value, field.width));
+      else
+        out->write_uint(value);
+    }
+    out->write("}}");
+  }
+}
+
+std::vector<std::pair<std::string, latency_histogram>>
+trace_decoder::
+spans() const
+{
+  std::vector<std::pair<std::string, latency_histogram>> result;
+  for (size_t i = 0; i < m_span_hist.size(); i++) {
+    if (m_span_hist[i])
+      result.emplace_back(m_span_names[i], *m_span_hist[i]);
+  }
+  return result;
+}
+
+log_schema::
+log_schema(const json_value &doc)
+{
+  std::vector<std::string> enum_names;
+  if (auto enums = doc.find("enumerations")) {
+    for (auto &def : enums->as_object()) {
+      std::vector<std::pair<uint64_t, std::string>> entries;
+      for (auto &entry : def.second.at("enumerators").as_object())
+        entries.emplace_back(entry.second.as_uint(), entry.first);
+      enum_names.push_back(def.first);
+      m_tables.push_back(make_names(entries));
+    }
+  }
+
+  auto &header = doc.at("structures").at("ipu_log_message_header");
+  unsigned int bit = 0;
+  for (auto &def : header.at("fields").as_array()) {
+    trace_field field;
+    auto name = def.at("name").as_string();
+    field.key = json_quote(name) + ":";
+    field.start = bit;
+    field.width = static_cast<unsigned int>(def.at("width").as_uint());
+    if (!field.width || field.start % 8 + field.width > 64)
+      throw std::runtime_error("Error: Log header field " + name + " straddles a 64-bit load\n");
+    set_format(field, def.get_string("format", ""));
+    auto enumeration = std::find(enum_names.begin(), enum_names.end(), def.get_string("enumeration", ""));
+    if (enumeration != enum_names.end()) {
+      field.style = trace_field::render::name;
+      field.table = static_cast<int>(enumeration - enum_names.begin());
+    }
+    bit += field.width;
+
+    // Reserved bits and the fields the message layout uses are not repeated as args
+    int index = static_cast<int>(m_fields.size());
+    if (name == "timestamp")
+      m_timestamp = index;
+    else if (name == "argc")
+      m_argc = index;
+    else if (name == "format")
+      m_format = index;
+    else if (name.rfind("reserved", 0) != 0)
+      m_shown.push_back(index);
+    m_fields.push_back(std::move(field));
+    m_field_names.push_back(name);
+  }
+  m_header_bytes = (bit + 7) / 8;
+  if (m_timestamp < 0 || m_argc < 0)
+    throw std::runtime_error("Error: Log header has no timestamp or argc field\n");
+
+  if (m_format >= 0 && m_fields[m_format].table >= 0) {
+    auto &table = m_tables[m_fields[m_format].table];
+    for (size_t v = 0; v < table.index.size(); v++) {
+      if (table.index[v] >= 0 && table.names[table.index[v]] == "\"full\"")
+        m_full_format = v;
+    }
+  }
+}
+
+log_schema
+log_schema::
+load(const std::string &fname)
+{
+  auto doc = load_json(fname);
+  try {
+    return log_schema(doc);
+  }
+  catch (const std::runtime_error &e) {
+    throw std::runtime_error(fname + ": " + e.what());
+  }
+}
+
+int
+log_schema::
+field(const std::string &name) const
+{
+  auto it = std::find(m_field_names.begin(), m_field_names.end(), name);
+  return it == m_field_names.end() ? -1 : static_cast<int>(it - m_field_names.begin());
+}
+
+uint64_t
+log_schema::
+enum_value(int field, const std::string &name) const
+{
+  if (field >= 0 && m_fields[field].table >= 0) {
+    auto &table = m_tables[m_fields[field].table];
+    auto quoted = json_quote(name);
+    for (size_t v = 0; v < table.index.size(); v++) {
+      if (table.index[v] >= 0 && table.names[table.index[v]] == quoted)
+        return v;
+    }
+  }
+  throw std::runtime_error("Error: Log header has no enumerator " + name + "\n");
+}
+
+uint64_t
+log_schema::
+read(const uint8_t *header, const trace_field &field) const
+{
+  uint64_t bits = 0;
+  size_t offset = field.start / 8;
+  std::memcpy(&bits, header + offset, std::min<size_t>(sizeof(bits), m_header_bytes - offset));
+  auto value = bits >> (field.start % 8);
+  return field.width < 64 ? value & ((uint64_t(1) << field.width) - 1) : value;
+}
+
+uint64_t
+log_schema::
+decode(const char *begin, const char *end, double ticks_per_us, trace_json_writer *out) const
+{
+  double ns_per_tick = 1000.0 / ticks_per_us;
+  uint64_t count = 0;
+  auto p = begin;
+  while (p + m_header_bytes <= end) {
+    auto header = reinterpret_cast<const uint8_t*>(p);
+    auto argc = read(header, m_fields[m_argc]);
+    auto args = p + m_header_bytes;
+    if (args + argc * sizeof(uint32_t) > end)
+      break;
+    p = args + argc * sizeof(uint32_t);
+    count++;
+    if (!out)
+      continue;
+
+    auto ns = static_cast<uint64_t>(read(header, m_fields[m_timestamp]) * ns_per_tick);
+    bool full = m_format >= 0 && read(header, m_fields[m_format]) == m_full_format;
+
+    out->next_event();
+    out->write("{\"name\":");
+    if (full)
+      out->write_string(args, argc * sizeof(uint32_t));
+    else
+      out->write("\"log\"");
+    out->write(",\"cat\":\"log\",\"ph\":\"i\",\"s\":\"g\",\"ts\":");
+    out->write_us(ns);
+    out->write(",\"pid\":1,\"tid\":0,\"args\":{");
+    for (auto index : m_shown) {
+      auto &field = m_fields[index];
+      auto value = read(header, field);
+      out->write(field.key);
+      int32_t entry = field.style == trace_field::render::name ? m_tables[field.table].find(value) : -1;
+      if (entry >= 0)
+        out->write(m_tables[field.table].names[entry]);
+      else if (field.style == trace_field::render::hex)
+        out->write_hex(value, field.hex_digits);
+      else
+        out->write_uint(value);
+      out->write(",");
+    }
+    out->write("\"args\":[");
+    if (!full) {
+      for (uint64_t i = 0; i < argc; i++) {
+        uint32_t arg;
+        std::memcpy(&arg, args + i * sizeof(arg), sizeof(arg));
+        if (i)
+          out->write(",");
+        out->write_uint(arg);
+      }
+    }
+    out->write("]}}");
+  }
+  return count;
+}
+
+} // namespace vtd
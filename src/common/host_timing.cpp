@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "host_timing.h"
+#include "sample_stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr int clock_batches = 5;
+constexpr int clock_reads = 100000;
+
+// Cheapest of a few batches of back to back clock reads
+double
+clock_read_ns()
+{
+  double best = 0;
+  for (int b = 0; b < clock_batches; b++) {
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    for (int i = 0; i < clock_reads; i++)
+      last = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(last - start).count() / clock_reads;
+    if (!b || ns < best)
+      best = ns;
+  }
+  return best;
+}
+
+// Read the clock back to back for 'duration' and collect the gaps that were
+// interruptions
+vtd::host_noise
+measure_noise(int cpu, std::chrono::milliseconds duration)
+{
+  vtd::host_noise noise;
+  noise.cpu = cpu;
+  noise.clock_ns = clock_read_ns();
+
+  std::vector<double> gaps_us;
+  double stolen_ns = 0;
+  auto threshold = std::chrono::nanoseconds(vtd::host_jitter_threshold_ns);
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + duration;
+  auto prev = start;
+  while (prev < end) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - prev > threshold) {
+      double ns = std::chrono::duration<double, std::nano>(now - prev).count();
+      gaps_us.push_back(ns / 1e3);
+      stolen_ns += ns;
+    }
+    prev = now;
+  }
+
+  double total_ns = std::chrono::duration<double, std::nano>(prev - start).count();
+  noise.interruptions = gaps_us.size();
+  noise.stolen_pct = total_ns ? stolen_ns / total_ns * 100 : 0;
+  if (!gaps_us.empty()) {
+    noise.max_gap_us = *std::max_element(gaps_us.begin(), gaps_us.end());
+    noise.p99_gap_us = vtd::sample_percentile(std::move(gaps_us), 0.99);
+  }
+  return noise;
+}
+
+} // namespace
+
+namespace vtd {
+
+std::vector<int>
+parse_cpu_list(const std::string &arg)
+{
+  auto invalid = [&arg] { return std::runtime_error("Error: Invalid CPU list '" + arg + "'\n"); };
+
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos <= arg.size()) {
+    auto comma = std::min(arg.find(',', pos), arg.size());
+    auto item = arg.substr(pos, comma - pos);
+    auto dash = item.find('-');
+    try {
+      size_t used = 0;
+      int first = std::stoi(item.substr(0, dash), &used);
+      if (used != std::min(dash, item.size()))
+        throw invalid();
+      int last = first;
+      if (dash != std::string::npos) {
+        last = std::stoi(item.substr(dash + 1), &used);
+        if (used != item.size() - dash - 1)
+          throw invalid();
+      }
+      if (first < 0 || last < first)
+        throw invalid();
+      for (int cpu = first; cpu <= last; cpu++)
+        cpus.push_back(cpu);
+    }
+    catch (const std::logic_error&) {
+      throw invalid();
+    }
+    pos = comma + 1;
+  }
+  return cpus;
+}
+
+void
+pin_thread(int cpu)
+{
+#ifndef _WIN32
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (err)
+    throw std::runtime_error("Error: Failure pinning thread to CPU " + std::to_string(cpu) + ": "
+                             + std::strerror(err) + "\n");
+#else
+  throw std::runtime_error("Error: Pinning threads is only supported on Linux\n");
+#endif
+}
+
+int
+cpu_numa_node(int cpu)
+{
+  std::error_code ec;
+  std::filesystem::directory_iterator it("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec);
+  for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+    auto name = it->path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::isdigit(static_cast<unsigned char>(name[4])))
+      return std::stoi(name.substr(4));
+  }
+  return -1;
+}
+
+int
+current_cpu()
+{
+#ifndef _WIN32
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+double
+host_calibration::
+noise_pct(double interval_us) const
+{
+  if (cpus.empty() || interval_us <= 0)
+    return 0;
+
+  double stolen = 0;
+  double clock_ns = 0;
+  for (auto &noise : cpus) {
+    stolen = std::max(stolen, noise.stolen_pct);
+    clock_ns = std::max(clock_ns, noise.clock_ns);
+  }
+  return stolen + 2 * clock_ns / (interval_us * 1e3) * 100;
+}
+
+void
+host_calibration::
+print(std::ostream &os) const
+{
+  os << "Host timing (" << duration.count() << " ms per CPU, gaps over " << host_jitter_threshold_ns / 1e3
+     << " us are interruptions):\n";
+  os << "   CPU  Node  Clock read (ns)  Interruptions  Stolen (%)  p99 gap (us)  Max gap (us)\n";
+  os << std::fixed << std::setprecision(3);
+  for (auto &noise : cpus) {
+    if (noise.cpu < 0)
+      os << "   any     -";
+    else
+      os << std::setw(6) << noise.cpu << std::setw(6) << cpu_numa_node(noise.cpu);
+    os << std::setw(17) << noise.clock_ns << std::setw(15) << noise.interruptions << std::setw(12)
+       << noise.stolen_pct << std::setw(14) << noise.p99_gap_us << std::setw(14) << noise.max_gap_us << "\n";
+  }
+  os << std::defaultfloat;
+}
+
+host_calibration
+calibrate_host(const std::vector<int> &cpus, std::chrono::milliseconds duration)
+{
+  host_calibration cal;
+  cal.duration = duration;
+  if (cpus.empty()) {
+    cal.cpus.push_back(measure_noise(-1, duration));
+    return cal;
+  }
+
+  // One core at a time, so the measurements do not disturb each other
+  for (auto cpu : cpus) {
+    std::exception_ptr error;
+    std::thread thread([&] {
+      try {
+        pin_thread(cpu);
+        cal.cpus.push_back(measure_noise(cpu, duration));
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+    });
+    thread.join();
+    if (error)
+      std::rethrow_exception(error);
+  }
+  return cal;
+}
+
+} // namespace vtd
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_ASYNC_STAGE_H
+#define VTD_ASYNC_STAGE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace vtd {
+
+/* A helper thread that runs one posted task at a time, so host side staging
+ * such as buffer fills and syncs proceeds while the caller waits for a
+ * command.  post() hands over the next task, wait() returns once it is done
+ * and rethrows what it threw.  busy() is the time spent in tasks so far.
+ */
+class async_stage
+{
+public:
+  async_stage() : m_thread([this] { loop(); }) {}
+
+  ~async_stage()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+  }
+
+  async_stage(const async_stage&) = delete;
+  async_stage& operator=(const async_stage&) = delete;
+
+  // Waits for the previous task first, only one is ever in flight
+  void
+  post(std::function<void()> task)
+  {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_task = std::move(task);
+    }
+    m_cond.notify_all();
+  }
+
+  void
+  wait()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_cond.wait(lock, [this] { return !m_task; });
+    if (m_error)
+      std::rethrow_exception(std::exchange(m_error, nullptr));
+  }
+
+  std::chrono::nanoseconds
+  busy() const
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_busy;
+  }
+
+private:
+  void
+  loop()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true) {
+      m_cond.wait(lock, [this] { return m_stop || m_task; });
+      if (!m_task)
+        return;
+
+      lock.unlock();
+      auto start = std::chrono::steady_clock::now();
+      std::exception_ptr error;
+      try {
+        m_task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      auto end = std::chrono::steady_clock::now();
+      lock.lock();
+
+      m_busy += end - start;
+      m_error = error;
+      m_task = nullptr;
+      m_cond.notify_all();
+    }
+  }
+
+  mutable std::mutex m_lock;
+  std::condition_variable m_cond;
+  std::function<void()> m_task;
+  std::exception_ptr m_error;
+  std::chrono::nanoseconds m_busy {};
+  bool m_stop = false;
+  std::thread m_thread;                  // Last, starts once the rest is set up
+};
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_BO_POOL_H
+#define VTD_BO_POOL_H
+
+/* Reusable buffer objects for large transfers.
+ *
+ * acquire() hands out a lease on a BO of the requested size, flags and memory
+ * group, reusing one whose lease has ended before allocating a new one.  The
+ * BO goes back to the pool when its lease is destroyed or released, so
+ * callers keep the lease for as long as they or their runs use the BO, and
+ * the pool can be shared across iterations, tests and threads.
+ *
+ * The host memory behind a new BO comes from the driver, or with a huge page
+ * backing from an explicit 2 MB / 1 GB hugetlb mapping (falling back to
+ * transparent huge pages when none are reserved) wrapped in a user pointer
+ * BO.  With prefault every page is touched on all cores and the BO synced once
+ * when it is allocated, so page faults and pinning stay out of the measured
+ * transfers.  The time spent on each of these steps is recorded and every
+ * reuse is credited with what its BO cost to set up.
+ *
+ * With a NUMA node the huge page backed host memory is bound to that node
+ * before it is first touched.  Driver allocated memory is placed by the
+ * driver, so a node requires a huge page backing.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+
+namespace vtd {
+
+class bo_lease;
+
+enum class bo_backing
+{
+  driver,    // Plain XRT allocation
+  thp,       // Anonymous memory advised to use transparent huge pages
+  huge_2m,   // hugetlb 2 MB pages
+  huge_1g,   // hugetlb 1 GB pages
+};
+
+// Parse one of driver, thp, 2m and 1g
+bo_backing
+parse_bo_backing(const std::string &name);
+
+std::string
+bo_backing_name(bo_backing backing);
+
+struct bo_pool_stats
+{
+  uint64_t acquires = 0;
+  uint64_t allocations = 0;
+  uint64_t reuses = 0;
+  uint64_t huge_fallbacks = 0;            // hugetlb requests served by THP
+  uint64_t bytes = 0;                     // Allocated, not requested
+  std::chrono::nanoseconds alloc {};      // Host memory and BO creation
+  std::chrono::nanoseconds map {};
+  std::chrono::nanoseconds prefault {};
+  std::chrono::nanoseconds sync {};       // First sync of prefaulted BOs
+  std::chrono::nanoseconds saved {};      // Setup cost of the reused BOs
+};
+
+class bo_pool
+{
+public:
+  // 'numa_node' -1 leaves the placement to the kernel
+  explicit bo_pool(const xrt::device &device, bo_backing backing = bo_backing::driver, bool prefault = false,
+                   int numa_node = -1);
+  ~bo_pool();
+
+  bo_pool(const bo_pool&) = delete;
+  bo_pool& operator=(const bo_pool&) = delete;
+
+  // A free BO of exactly 'size' bytes, 'flags' and 'grp', newly allocated when
+  // there is none
+  bo_lease
+  acquire(size_t size, xrtBufferFlags flags, xrtMemoryGroup grp);
+
+  bo_pool_stats
+  stats() const;
+
+  // One line summary of the stats
+  void
+  print_stats(std::ostream &os) const;
+
+private:
+  friend class bo_lease;
+  struct entry;
+
+  std::unique_ptr<entry>
+  allocate(size_t size, xrtBufferFlags flags, xrtMemoryGroup grp);
+
+  // End the lease on 'e'
+  void
+  release(entry *e);
+
+  xrt::device m_device;
+  bo_backing m_backing;
+  bool m_prefault;
+  int m_numa_node;
+  mutable std::mutex m_lock;
+  std::vector<std::unique_ptr<entry>> m_entries;
+  bo_pool_stats m_stats;
+};
+
+/* A BO handed out by bo_pool::acquire().  The BO is the holder's until the
+ * lease is destroyed or released, after that the pool hands it out again and
+ * copies of bo() must no longer be used.  The pool must outlive its leases.
+ */
+class bo_lease
+{
+public:
+  bo_lease() = default;
+  ~bo_lease();
+
+  bo_lease(bo_lease &&other) noexcept;
+  bo_lease& operator=(bo_lease &&other) noexcept;
+
+  bo_lease(const bo_lease&) = delete;
+  bo_lease& operator=(const bo_lease&) = delete;
+
+  xrt::bo&
+  bo()
+  {
+    return m_bo;
+  }
+
+  const xrt::bo&
+  bo() const
+  {
+    return m_bo;
+  }
+
+  // Hand the BO back to the pool before the lease is destroyed
+  void
+  release();
+
+  explicit operator bool() const
+  {
+    return m_entry != nullptr;
+  }
+
+private:
+  friend class bo_pool;
+
+  bo_lease(bo_pool *pool, bo_pool::entry *entry)
+    : m_pool(pool)
+    , m_entry(entry)
+  {}
+
+  bo_pool *m_pool = nullptr;
+  bo_pool::entry *m_entry = nullptr;
+  xrt::bo m_bo;
+};
+
+/* A read-only input file mapped copy-on-write into a user pointer BO, so that
+ * for example the weights of a model reach the device without being copied
+ * into a driver allocated buffer first.  'size' bytes of the file are
+ * exposed, the file must hold at least that many.
+ */
+class file_bo
+{
+public:
+  file_bo(const xrt::device &device, const std::string &fname, size_t size, xrtMemoryGroup grp);
+  ~file_bo();
+
+  file_bo(const file_bo&) = delete;
+  file_bo& operator=(const file_bo&) = delete;
+
+  xrt::bo&
+  bo()
+  {
+    return m_bo;
+  }
+
+private:
+  void *m_host = nullptr;
+  size_t m_len = 0;
+  xrt::bo m_bo;
+};
+
+} // namespace vtd
+
+#endif
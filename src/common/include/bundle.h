@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_BUNDLE_H
+#define VTD_BUNDLE_H
+
+/* Reader for the test bundles archive/build_archives.py --format bundle
+ * writes, an indexed replacement for the flat xrt_smi_<platform>.a archives.
+ *
+ * A bundle keeps the paths of the platform tree, e.g. "latency/nop.elf", and
+ * stores every distinct file content once.  All integers are little endian:
+ *
+ *   header   magic "VTDBND01", u32 version, u32 page size, u32 entry count,
+ *            u32 blob count, u64 entry table, blob table and string table
+ *            offsets, u64 string table size, u64 file size (64 bytes)
+ *   entry    u32 path offset and size in the string table, u32 blob, u32 0;
+ *            sorted by path
+ *   blob     u64 payload offset, u64 payload size, SHA-256 of the payload
+ *
+ * Payloads start on page boundaries.  The bundle is memory mapped and
+ * validated once when it is opened, a lookup is a binary search over the
+ * entry table and hands out a view of the payload in the mapping, so xclbin
+ * and ELF bytes are neither copied nor extracted.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "dpu_sequence.h"
+
+namespace vtd {
+
+// View of one file of a bundle, valid as long as the bundle is open
+struct bundle_entry
+{
+  std::string_view path;
+  const char *data = nullptr;
+  size_t size = 0;
+  const uint8_t *sha256 = nullptr;   // 32 bytes
+  uint32_t blob = 0;                 // Entries of one blob share their payload
+};
+
+class bundle
+{
+public:
+  explicit bundle(const std::string &fname);
+
+  bundle(const bundle&) = delete;
+  bundle& operator=(const bundle&) = delete;
+
+  size_t
+  size() const
+  {
+    return m_entry_count;
+  }
+
+  size_t
+  blob_count() const
+  {
+    return m_blob_count;
+  }
+
+  // Entries in path order
+  bundle_entry
+  entry(size_t index) const;
+
+  // Entry at 'path', false when the bundle has none
+  bool
+  find(std::string_view path, bundle_entry &out) const;
+
+  // Entry at 'path', throws when the bundle has none
+  bundle_entry
+  at(std::string_view path) const;
+
+  // Payload bytes stored and the bytes the entries would take without sharing
+  uint64_t
+  stored_bytes() const;
+
+  uint64_t
+  entry_bytes() const;
+
+private:
+  mapped_file m_file;
+  std::string m_fname;
+  const char *m_entries = nullptr;
+  const char *m_blobs = nullptr;
+  const char *m_strings = nullptr;
+  size_t m_entry_count = 0;
+  size_t m_blob_count = 0;
+};
+
+// Hex string of an entry's SHA-256
+std::string
+bundle_hash_hex(const bundle_entry &entry);
+
+} // namespace vtd
+
+#endif
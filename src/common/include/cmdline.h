@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_CMDLINE_H
+#define VTD_CMDLINE_H
+
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vtd {
+
+// Parse a comma separated list of positive integers such as "1,2,4,8"
+inline std::vector<int>
+parse_int_list(const std::string &arg)
+{
+  std::vector<int> values;
+  std::stringstream ss(arg);
+  std::string item;
+
+  while (std::getline(ss, item, ',')) {
+    size_t pos = 0;
+    int value = std::stoi(item, &pos);
+    if (pos != item.size() || value < 1)
+      throw std::runtime_error("Error: Invalid list value '" + item + "' in '" + arg + "'\n");
+    values.push_back(value);
+  }
+
+  if (values.empty())
+    throw std::runtime_error("Error: Empty list '" + arg + "'\n");
+
+  return values;
+}
+
+// Parse a byte count with an optional K, M or G (binary) suffix such as "4K"
+inline size_t
+parse_size(const std::string &arg)
+{
+  size_t pos = 0;
+  unsigned long long value = 0;
+  try {
+    value = std::stoull(arg, &pos);
+  } catch (const std::exception&) {
+    pos = 0;
+  }
+
+  int shift = 0;
+  if (pos + 1 == arg.size()) {
+    switch (arg[pos]) {
+    case 'K': case 'k': shift = 10; break;
+    case 'M': case 'm': shift = 20; break;
+    case 'G': case 'g': shift = 30; break;
+    default: pos = 0; break;
+    }
+    if (pos)
+      pos++;
+  }
+  if (pos == 0 || pos != arg.size() || value == 0)
+    throw std::runtime_error("Error: Invalid size '" + arg + "'\n");
+
+  return static_cast<size_t>(value) << shift;
+}
+
+// Human readable form of a byte count as parse_size accepts it
+inline std::string
+format_size(size_t bytes)
+{
+  const char *suffix[] = {"", "K", "M", "G"};
+  int unit = 0;
+  while (unit < 3 && bytes >= 1024 && bytes % 1024 == 0) {
+    bytes /= 1024;
+    unit++;
+  }
+  return std::to_string(bytes) + suffix[unit];
+}
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_DATA_PATTERN_H
+#define VTD_DATA_PATTERN_H
+
+/* Test data generation and checking for large buffers.
+ *
+ * Word i of a pattern is a pure function of (seed, i), so any chunk of a
+ * buffer can be generated or re-generated on its own.  That lets the work be
+ * split across all cores and lets a buffer be verified against the seed
+ * instead of a stored golden copy.  Comparison loops use AVX-512 or AVX2 when
+ * the CPU has them and fall back to scalar code otherwise.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+namespace vtd {
+
+constexpr size_t pattern_match = std::numeric_limits<size_t>::max();
+
+// 32-bit bijective integer hash (lowbias32)
+inline uint32_t
+pattern_hash(uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+  return x;
+}
+
+// Per 2^32 words key derived from the seed, keeps the inner loops 32-bit wide
+inline uint32_t
+pattern_key(uint64_t seed, uint64_t index)
+{
+  uint64_t z = seed + (index >> 32) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<uint32_t>(z ^ (z >> 31));
+}
+
+// Expected value of word 'index' of the pattern for 'seed'
+inline uint32_t
+pattern_word(uint64_t seed, uint64_t index)
+{
+  return pattern_hash(static_cast<uint32_t>(index) ^ pattern_key(seed, index));
+}
+
+// Split [0, count) into one contiguous chunk per thread and run 'func' on each.
+// 'threads' of 0 uses every core.
+void
+parallel_chunks(size_t count, unsigned int threads, const std::function<void(size_t, size_t)> &func);
+
+// Write words [0, count) of the pattern for 'seed'
+void
+fill_pattern(uint32_t *dst, size_t count, uint64_t seed, unsigned int threads = 0);
+
+// Index of the first word that differs between 'a' and 'b', or pattern_match
+size_t
+compare_words(const uint32_t *a, const uint32_t *b, size_t count, unsigned int threads = 0);
+
+// Index of the first word that is not the pattern for 'seed', or pattern_match
+size_t
+verify_pattern(const uint32_t *data, size_t count, uint64_t seed, unsigned int threads = 0);
+
+// Name of the vector extension picked for this CPU, for reporting
+const char*
+pattern_isa();
+
+} // namespace vtd
+
+#endif
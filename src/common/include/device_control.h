@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_DEVICE_CONTROL_H
+#define VTD_DEVICE_CONTROL_H
+
+/* Device state that XRT does not expose through its API: the PCI device id,
+ * the AIE clock, the power mode, the power draw and force preemption.  On
+ * hardware these still come from xrt-smi (VTD_XRT_SMI overrides the path),
+ * executed with an argument vector and no shell: the reports from 'xrt-smi
+ * examine' into a private temporary file, and the power mode and force
+ * preemption are set with 'xrt-smi configure', which needs the process to run
+ * as root.  In mock builds they go to the simulated NPU.
+ * Applications hold a device_control instead of running xrt-smi themselves, so
+ * the policy lives in one place and can be replaced.
+ *
+ * With VTD_DEVICE_CONTROL=stub the power mode and force preemption are local
+ * stand-ins instead: they live in the VTD_STUB_PMODE and
+ * VTD_STUB_FORCE_PREEMPTION environment variables, which setting them exports
+ * to the processes started afterwards, and the clock follows from the mode.
+ * The device id and power draw still come from the device.  That runs the
+ * power mode and preemption logic of the apps and of pmode_matrix without root
+ * or a device that supports them.
+ */
+
+#include <memory>
+#include <string>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+namespace vtd {
+
+class device_control
+{
+public:
+  virtual ~device_control() = default;
+
+  // PCI device and revision id as used by benchmarks/, e.g. 17f0_10
+  virtual std::string
+  device_id() = 0;
+
+  // Current AIE (H) clock in MHz, throws when the device does not report it
+  virtual unsigned int
+  aie_clock_mhz() = 0;
+
+  virtual std::string
+  power_mode() = 0;
+
+  virtual void
+  set_power_mode(const std::string &mode) = 0;
+
+  // Current NPU power draw in watts, throws when the device does not report it
+  virtual double
+  power_watts() = 0;
+
+  // Preempt every command at each of its preemption points
+  virtual void
+  set_force_preemption(bool enable) = 0;
+};
+
+// Controller for 'device', xrt-smi based unless built against the mock, with
+// the stub power mode on top when VTD_DEVICE_CONTROL=stub
+std::unique_ptr<device_control>
+make_device_control(const xrt::device &device);
+
+// Number of AIE columns of the partition described by 'xclbin'
+unsigned int
+xclbin_partition_columns(const xrt::xclbin &xclbin);
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_DPU_SEQUENCE_H
+#define VTD_DPU_SEQUENCE_H
+
+/* Shared loader for DPU sequence text files.
+ *
+ * A DPU sequence is a list of ASCII encoded 4-Byte hexadecimal values, one
+ * per line, with comment lines identified by a '#' prefix.  The loader maps
+ * the file, decodes every word in a single pass straight into the mapped
+ * instruction BO and stores the decoded image next to the text file
+ * (<file>.bin) so later runs copy the binary image instead of parsing.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_kernel.h"
+
+namespace vtd {
+
+// Instruction BO together with its length in 32-bit words, which is what the
+// DPU kernel expects as the instruction count argument.
+struct dpu_instr
+{
+  xrt::bo bo;
+  size_t size = 0;
+};
+
+// Read-only view of a whole file, memory mapped where the platform allows it
+class mapped_file
+{
+public:
+  explicit mapped_file(const std::string &fname);
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  const char*
+  data() const
+  {
+    return m_data;
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+private:
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  std::string m_buf;   // Fallback storage when mmap is not available
+  bool m_mapped = false;
+};
+
+// Upper bound of the number of words a sequence of 'bytes' characters holds.
+// Every instruction line is at least 8 hex digits and a newline.
+inline size_t
+dpu_sequence_max_words(size_t bytes)
+{
+  return (bytes + 1) / 9;
+}
+
+// Decode the sequence text in [begin, end) into 'out' which must hold at least
+// dpu_sequence_max_words(end - begin) words.  Returns the number of words
+// written, throws std::runtime_error on a malformed line.
+size_t
+parse_dpu_sequence(const char *begin, const char *end, uint32_t *out);
+
+/* TCT sync operations of a sequence in transaction format: a 4 word header
+ * with the operation count and byte size, then the operations, each starting
+ * with a word whose low byte is the opcode.  A sync op waits for row_num x
+ * col_num task completion tokens.  'valid' is false when the sequence is not
+ * in transaction format or holds an operation the scan does not know, the
+ * token count is then unknown.
+ */
+struct dpu_sequence_syncs
+{
+  bool valid = false;
+  size_t ops = 0;
+  size_t tokens = 0;
+  uint64_t column_mask = 0;   // Columns any sync op waits on
+};
+
+dpu_sequence_syncs
+scan_dpu_sequence_syncs(const uint32_t *words, size_t count);
+
+/* Rewrite the length of every shim DMA buffer descriptor of a transaction
+ * format sequence that moves 'old_length' words to 'new_length' words, so one
+ * sequence serves transfers of other sizes.  BDs are found by their register
+ * offset in write and block write operations.  Returns the number of BDs
+ * patched, 0 when there is none or the sequence is not in transaction format.
+ */
+size_t
+patch_dpu_sequence_bd_lengths(uint32_t *words, size_t count, uint32_t old_length, uint32_t new_length);
+
+// Name of the binary image cached next to the sequence text file
+std::string
+dpu_sequence_cache_name(const std::string &fname);
+
+// Allocate the instruction BO for 'kernel' and fill it from the sequence file.
+// When 'use_cache' is set the binary image next to the text file is used if it
+// is still current, and is (re)written after parsing otherwise.
+dpu_instr
+load_dpu_sequence(const xrt::device &device, const xrt::kernel &kernel, const std::string &fname,
+                  int instr_argidx = 5, bool use_cache = true);
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_FW_TRACE_H
+#define VTD_FW_TRACE_H
+
+/* Decoder of the NPU firmware event trace and log buffers.
+ *
+ * The formats are described by the firmware_configs schemas of the archive:
+ * trace_events.json for the event trace, firmware_log.json for the log.  The
+ * schemas are turned into flat tables once, decoding then walks the raw
+ * buffer with table lookups and writes Chrome trace JSON (which Perfetto also
+ * reads) through a fixed buffer, nothing is allocated per record.
+ *
+ * Event trace record, 16 bytes little endian:
+ *   uint64_t timestamp    firmware timer ticks
+ *   uint64_t event        event id in the low event_bits, payload above
+ *
+ * Log message, the header fields of ipu_log_message_header packed LSB first
+ * in declaration order, followed by 'argc' 32-bit words.  These are the
+ * arguments of a concise message and the NUL padded text of a full one.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json.h"
+#include "latency_histogram.h"
+
+namespace vtd {
+
+// Buffered writer of a Chrome trace document
+class trace_json_writer
+{
+public:
+  explicit trace_json_writer(const std::string &fname);
+  ~trace_json_writer();
+
+  trace_json_writer(const trace_json_writer&) = delete;
+  trace_json_writer& operator=(const trace_json_writer&) = delete;
+
+  // Start the next element of the traceEvents array
+  void
+  next_event();
+
+  void
+  write(const char *data, size_t size);
+
+  void
+  write(const std::string &str)
+  {
+    write(str.data(), str.size());
+  }
+
+  template <size_t N>
+  void
+  write(const char (&literal)[N])
+  {
+    write(literal, N - 1);
+  }
+
+  void
+  write_uint(uint64_t value);
+
+  void
+  write_int(int64_t value);
+
+  // 0x prefixed, zero padded to 'digits'
+  void
+  write_hex(uint64_t value, unsigned int digits);
+
+  // Microseconds with nanosecond fraction, the unit of Chrome trace timestamps
+  void
+  write_us(uint64_t ns);
+
+  // Quoted JSON string of [data, data + size), stops at a NUL
+  void
+  write_string(const char *data, size_t size);
+
+  // Close the document and flush, throws when the output failed
+  void
+  finish();
+
+private:
+  void
+  reserve(size_t size);
+
+  std::FILE *m_file = nullptr;
+  bool m_first = true;
+  bool m_finished = false;
+  std::vector<char> m_buf;
+  size_t m_pos = 0;
+};
+
+// One bit field of an event payload or log header
+struct trace_field
+{
+  enum class render { decimal, hex, name };
+
+  std::string key;                       // Quoted name and colon, ready to write
+  unsigned int start = 0;
+  unsigned int width = 0;
+  bool is_signed = false;
+  render style = render::decimal;
+  unsigned int hex_digits = 0;
+  int table = -1;                        // Value names for render::name
+
+  uint64_t
+  extract(uint64_t bits) const
+  {
+    uint64_t value = bits >> start;
+    return width < 64 ? value & ((uint64_t(1) << width) - 1) : value;
+  }
+};
+
+// Dense value to name table of a lookup or enumeration
+struct trace_names
+{
+  std::vector<int32_t> index;            // Value -> entry or -1
+  std::vector<std::string> names;        // Quoted names
+
+  int32_t
+  find(uint64_t value) const
+  {
+    return value < index.size() ? index[value] : -1;
+  }
+};
+
+class trace_schema
+{
+public:
+  enum class phase { instant, begin, end };
+
+  struct event
+  {
+    std::string name;
+    std::string label;                   // Quoted name
+    std::string span;                    // Quoted span name of a begin event
+    std::string head;                    // ,"cat":...,"ph":... ready to write
+    phase type = phase::instant;
+    int pair = -1;                       // Event index of the other end of a span
+    int tid_field = -1;                  // Field with the context id
+    int name_field = -1;                 // Field whose value names a span
+    std::vector<trace_field> fields;
+  };
+
+  explicit trace_schema(const json_value &doc);
+
+  static trace_schema
+  load(const std::string &fname);
+
+  unsigned int
+  event_bits() const
+  {
+    return m_event_bits;
+  }
+
+  // Event of 'id' or nullptr when the schema does not define it
+  const event*
+  find(uint32_t id) const
+  {
+    auto idx = id < m_index.size() ? m_index[id] : -1;
+    return idx < 0 ? nullptr : &m_events[idx];
+  }
+
+  // Id of the event called 'name', throws when there is none
+  uint32_t
+  id(const std::string &name) const;
+
+  size_t
+  event_count() const
+  {
+    return m_events.size();
+  }
+
+  const event&
+  event_at(size_t index) const
+  {
+    return m_events[index];
+  }
+
+  const trace_names&
+  names(int table) const
+  {
+    return m_tables[table];
+  }
+
+private:
+  unsigned int m_event_bits = 16;
+  std::vector<int32_t> m_index;          // Event id -> m_events index
+  std::vector<uint32_t> m_ids;           // m_events index -> event id
+  std::vector<event> m_events;
+  std::vector<trace_names> m_tables;
+};
+
+// Walks event trace buffers, pairs begin and end events per context and
+// collects the span durations next to the optional JSON output
+class trace_decoder
+{
+public:
+  trace_decoder(const trace_schema &schema, double ticks_per_us);
+
+  void
+  decode(const char *begin, const char *end, trace_json_writer *out);
+
+  uint64_t
+  records() const
+  {
+    return m_records;
+  }
+
+  uint64_t
+  unknown() const
+  {
+    return m_unknown;
+  }
+
+  // End events without a matching begin
+  uint64_t
+  unmatched() const
+  {
+    return m_unmatched;
+  }
+
+  // Durations of the begin/end pairs by span name, e.g. IPU_MSG_EXECUTE_BUFFER
+  std::vector<std::pair<std::string, latency_histogram>>
+  spans() const;
+
+private:
+  static constexpr unsigned int max_tids = 17;    // 16 contexts and the rest
+
+  const trace_schema &m_schema;
+  double m_ns_per_tick;
+  std::vector<size_t> m_span_base;                // Event index -> first span slot
+  std::vector<std::string> m_span_names;
+  std::vector<std::unique_ptr<latency_histogram>> m_span_hist;
+  std::vector<uint64_t> m_open_ts;                // (event index, tid) -> begin timestamp
+  std::vector<int64_t> m_open_span;               // (event index, tid) -> span slot or -1
+  uint64_t m_records = 0;
+  uint64_t m_unknown = 0;
+  uint64_t m_unmatched = 0;
+};
+
+class log_schema
+{
+public:
+  explicit log_schema(const json_value &doc);
+
+  static log_schema
+  load(const std::string &fname);
+
+  // Decode the messages in [begin, end) into 'out', returns the message count
+  uint64_t
+  decode(const char *begin, const char *end, double ticks_per_us, trace_json_writer *out) const;
+
+  size_t
+  header_size() const
+  {
+    return m_header_bytes;
+  }
+
+  const std::vector<trace_field>&
+  fields() const
+  {
+    return m_fields;
+  }
+
+  // Index of field 'name' or -1
+  int
+  field(const std::string &name) const;
+
+  // Raw value of 'name' in enumeration field 'field', throws when undefined
+  uint64_t
+  enum_value(int field, const std::string &name) const;
+
+private:
+  uint64_t
+  read(const uint8_t *header, const trace_field &field) const;
+
+  std::vector<trace_field> m_fields;
+  std::vector<std::string> m_field_names;
+  std::vector<trace_names> m_tables;
+  std::vector<int> m_shown;              // Fields written as args
+  size_t m_header_bytes = 0;
+  int m_timestamp = -1;
+  int m_argc = -1;
+  int m_format = -1;
+  uint64_t m_full_format = ~uint64_t(0);
+};
+
+} // namespace vtd
+
+#endif
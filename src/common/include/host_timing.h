@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_HOST_TIMING_H
+#define VTD_HOST_TIMING_H
+
+/* Placement of the submission threads and the timing noise of the host.
+ *
+ * Microsecond scale results such as the TCT latency are exposed to thread
+ * migrations and to everything else the host runs.  The submission threads
+ * can be pinned to chosen cores, and a calibration pass measures on those
+ * cores what reading the clock costs and how much time the OS takes away:
+ * a thread reads the clock back to back and every gap longer than
+ * host_jitter_threshold_ns is an interruption.  From that a measurement gets a
+ * noise floor, the share of its time the host alone can explain.  Regressions
+ * below the floor are not told apart from host noise.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vtd {
+
+// A gap between two clock reads longer than this was an interruption
+constexpr uint64_t host_jitter_threshold_ns = 1000;
+
+// Parse a CPU list such as "0,2-3" as the kernel prints them
+std::vector<int>
+parse_cpu_list(const std::string &arg);
+
+// Pin the calling thread to 'cpu', throws when that is not possible
+void
+pin_thread(int cpu);
+
+// NUMA node of 'cpu', -1 when unknown
+int
+cpu_numa_node(int cpu);
+
+// CPU the calling thread runs on, -1 when unknown
+int
+current_cpu();
+
+// Timing noise of one core, or of an unpinned thread with cpu -1
+struct host_noise
+{
+  int cpu = -1;
+  double clock_ns = 0;                   // Cost of one clock read
+  uint64_t interruptions = 0;
+  double stolen_pct = 0;                 // Share of the time lost to interruptions
+  double max_gap_us = 0;                 // Longest interruption
+  double p99_gap_us = 0;                 // Of the interruptions
+};
+
+struct host_calibration
+{
+  std::vector<host_noise> cpus;
+  std::chrono::milliseconds duration {};  // Per core
+
+  // Noise floor in percent of a measurement that takes 'interval_us' per
+  // command and reads the clock twice per command: the worst core's stolen
+  // time plus the clock reads.  0 without calibration.
+  double
+  noise_pct(double interval_us) const;
+
+  void
+  print(std::ostream &os) const;
+};
+
+// Measure every core of 'cpus' in turn for 'duration' from a thread pinned to
+// it, an empty list measures one unpinned thread
+host_calibration
+calibrate_host(const std::vector<int> &cpus, std::chrono::milliseconds duration);
+
+} // namespace vtd
+
+#endif
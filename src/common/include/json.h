@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_JSON_H
+#define VTD_JSON_H
+
+/* Minimal JSON reader for the test definitions and result files.
+ *
+ * Documents are parsed in one pass into a tree of json_value.  Objects keep
+ * their members in file order, integer literals keep their exact 64-bit value
+ * next to the double.  Accessors throw std::runtime_error naming the member
+ * when a value has the wrong type, so malformed definitions fail with a
+ * readable message instead of a crash.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vtd {
+
+class json_value
+{
+public:
+  enum class kind { null, boolean, number, string, array, object };
+
+  using member = std::pair<std::string, json_value>;
+
+  json_value() = default;
+
+  kind
+  type() const
+  {
+    return m_kind;
+  }
+
+  bool
+  is_null() const
+  {
+    return m_kind == kind::null;
+  }
+
+  bool
+  is_number() const
+  {
+    return m_kind == kind::number;
+  }
+
+  bool
+  is_string() const
+  {
+    return m_kind == kind::string;
+  }
+
+  bool
+  is_array() const
+  {
+    return m_kind == kind::array;
+  }
+
+  bool
+  is_object() const
+  {
+    return m_kind == kind::object;
+  }
+
+  bool
+  as_bool() const;
+
+  double
+  as_double() const;
+
+  // Exact value of an integer literal, throws for fractions
+  int64_t
+  as_int() const;
+
+  uint64_t
+  as_uint() const;
+
+  const std::string&
+  as_string() const;
+
+  const std::vector<json_value>&
+  as_array() const;
+
+  const std::vector<member>&
+  as_object() const;
+
+  // Member 'key' of an object or nullptr when absent
+  const json_value*
+  find(const std::string &key) const;
+
+  // Member 'key' of an object, throws when absent
+  const json_value&
+  at(const std::string &key) const;
+
+  // Typed lookups of optional members
+  int64_t
+  get_int(const std::string &key, int64_t dflt) const;
+
+  double
+  get_double(const std::string &key, double dflt) const;
+
+  bool
+  get_bool(const std::string &key, bool dflt) const;
+
+  std::string
+  get_string(const std::string &key, const std::string &dflt) const;
+
+  size_t
+  size() const;
+
+  const json_value&
+  operator[](size_t index) const
+  {
+    return as_array().at(index);
+  }
+
+private:
+  friend class json_parser;
+
+  kind m_kind = kind::null;
+  bool m_bool = false;
+  bool m_integral = false;
+  double m_number = 0;
+  int64_t m_int = 0;
+  std::string m_string;
+  std::vector<json_value> m_array;
+  std::vector<member> m_object;
+};
+
+// Parse the JSON text in [begin, end), throws with the line number on errors
+json_value
+parse_json(const char *begin, const char *end);
+
+// Parse the JSON file 'fname'
+json_value
+load_json(const std::string &fname);
+
+// Quote and escape 's' as a JSON string
+std::string
+json_quote(const std::string &s);
+
+} // namespace vtd
+
+#endif
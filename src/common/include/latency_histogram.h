@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_LATENCY_HISTOGRAM_H
+#define VTD_LATENCY_HISTOGRAM_H
+
+/* HDR style latency histogram.
+ *
+ * Values are recorded in nanoseconds.  Values below 128 ns get a bucket each,
+ * above that every power of two is split into 64 linear sub-buckets, so any
+ * recorded value is known to within 1/64 (1.6%) up to about 73 minutes.  The
+ * bucket array is sized once at construction; record() only does integer math
+ * and never allocates, so it can sit inside timed loops.  Count, min, max, mean
+ * and standard deviation are tracked exactly next to the buckets.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vtd {
+
+class latency_histogram
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr unsigned int linear_bits = 7;                 // Exact buckets below 128 ns
+  static constexpr unsigned int sub_buckets = 1u << (linear_bits - 1);
+  static constexpr unsigned int max_msb = 42;                    // 2^43 ns, ~73 minutes
+  static constexpr size_t bucket_count = (1u << linear_bits) + (max_msb - linear_bits + 1) * sub_buckets;
+
+  latency_histogram()
+    : m_buckets(bucket_count, 0)
+  {}
+
+  void
+  record(clock::duration latency)
+  {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    record_ns(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+  }
+
+  void
+  record_ns(uint64_t ns)
+  {
+    m_buckets[bucket_index(ns)]++;
+    m_count++;
+    m_min = std::min(m_min, ns);
+    m_max = std::max(m_max, ns);
+    double v = static_cast<double>(ns);
+    m_sum += v;
+    m_sum_sq += v * v;
+  }
+
+  // Fold 'other' into this histogram, e.g. to aggregate per thread recorders
+  void
+  merge(const latency_histogram &other);
+
+  void
+  reset()
+  {
+    *this = latency_histogram();
+  }
+
+  uint64_t
+  count() const
+  {
+    return m_count;
+  }
+
+  double
+  min_us() const
+  {
+    return m_count ? m_min / 1e3 : 0;
+  }
+
+  double
+  max_us() const
+  {
+    return m_max / 1e3;
+  }
+
+  double
+  mean_us() const
+  {
+    return m_count ? m_sum / m_count / 1e3 : 0;
+  }
+
+  double
+  stddev_us() const;
+
+  // Upper bound of the bucket holding the q-th quantile (0 < q <= 1), clamped
+  // to the largest recorded value
+  double
+  percentile_us(double q) const;
+
+  // One line summary: p50/p90/p99/p99.9/max, mean and stddev in microseconds
+  void
+  print(std::ostream &os, const std::string &label) const;
+
+  // JSON object with the summary and all non-empty buckets as
+  // [lower_ns, upper_ns, count] triples
+  void
+  to_json(std::ostream &os, const std::string &name) const;
+
+  static size_t
+  bucket_index(uint64_t ns)
+  {
+    if (ns < (1u << linear_bits))
+      return static_cast<size_t>(ns);
+
+    unsigned int msb = 63 - count_leading_zeros(ns);
+    if (msb > max_msb)
+      return bucket_count - 1;
+
+    unsigned int shift = msb - (linear_bits - 1);
+    return (1u << linear_bits) + (msb - linear_bits) * sub_buckets + ((ns >> shift) - sub_buckets);
+  }
+
+  // Inclusive value range [lower, upper] in nanoseconds covered by a bucket
+  static std::pair<uint64_t, uint64_t>
+  bucket_range(size_t index);
+
+private:
+  static unsigned int
+  count_leading_zeros(uint64_t v)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned int>(__builtin_clzll(v));
+#else
+    unsigned int n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; !(v & bit); bit >>= 1)
+      n++;
+    return n;
+#endif
+  }
+
+  std::vector<uint64_t> m_buckets;
+  uint64_t m_count = 0;
+  uint64_t m_min = std::numeric_limits<uint64_t>::max();
+  uint64_t m_max = 0;
+  double m_sum = 0;
+  double m_sum_sq = 0;
+};
+
+// Write a list of named histograms as one JSON document
+void
+write_histograms_json(const std::string &fname,
+                      const std::vector<std::pair<std::string, latency_histogram>> &histograms);
+
+} // namespace vtd
+
+#endif
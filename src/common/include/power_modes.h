@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_POWER_MODES_H
+#define VTD_POWER_MODES_H
+
+#include <map>
+#include <string>
+
+namespace vtd {
+
+// AIE clock of every power mode of NPU4 class devices.  Shared by the stub
+// device control and the simulated NPU, which both derive the clock from the
+// mode instead of reading it from the device.
+inline const std::map<std::string, unsigned int>&
+pmode_clocks()
+{
+  static const std::map<std::string, unsigned int> clocks = {
+    {"powersaver", 800},
+    {"balanced", 1200},
+    {"default", 1500},
+    {"performance", 1600},
+    {"turbo", 1810},
+  };
+  return clocks;
+}
+
+} // namespace vtd
+
+#endif
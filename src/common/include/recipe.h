@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_RECIPE_H
+#define VTD_RECIPE_H
+
+/* Execution engine for the recipe/profile test definitions in archive/.
+ *
+ * A recipe names the xclbin (or a full ELF program), the buffers, the kernels
+ * with their ctrlcode and, in execution.runs, how buffers and constants bind to
+ * kernel arguments.  A profile adds the iteration count and buffer init
+ * patterns.  Loading resolves every name to an index so mistakes are reported
+ * before the device is touched.  The engine then allocates every BO and binds
+ * every xrt::run once; an iteration only starts the runs and waits for them.
+ *
+ * A run entry may carry "repeat": N (or "count": N) to submit the same run N
+ * times in a row as an xrt::runlist command chain of at most chain-length
+ * runs, executed again until the count is reached, so memory does not grow
+ * with the chain length; "chain": false submits them one by one instead.
+ * Consecutive identical entries of expanded recipes are folded into one
+ * template while loading to save memory, but are still submitted one by one
+ * as written.  save_recipe() writes the folded recipe in a binary form that
+ * load_recipe() reads without parsing.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_kernel.h"
+
+#include "bo_pool.h"
+#include "latency_histogram.h"
+
+namespace vtd {
+
+struct recipe_buffer
+{
+  std::string name;
+  std::string type;                      // input, output or debug
+  size_t size = 0;
+};
+
+struct recipe_kernel
+{
+  std::string name;
+  std::string instance;
+  std::string ctrlcode;                  // Path of the ctrlcode ELF, may be empty
+};
+
+struct recipe_argument
+{
+  size_t buffer;                         // Index into recipe::buffers
+  int argidx;
+};
+
+struct recipe_constant
+{
+  int argidx;
+  std::string type;                      // int, uint, int64 or uint64
+  int64_t value;
+};
+
+struct recipe_run
+{
+  size_t kernel;                         // Index into recipe::kernels
+  std::vector<recipe_argument> arguments;
+  std::vector<recipe_constant> constants;
+  uint64_t repeat = 1;                   // Consecutive submissions of this run
+  bool chain = false;                    // Submit the repeats as command chains, only with repeat > 1
+};
+
+struct recipe
+{
+  std::string xclbin;                    // Paths are resolved against the recipe directory
+  std::string program;                   // Full ELF used instead of an xclbin
+  std::vector<recipe_buffer> buffers;
+  std::vector<recipe_kernel> kernels;
+  std::vector<recipe_run> runs;
+};
+
+struct profile_binding
+{
+  size_t buffer;                         // Index into recipe::buffers
+  size_t size = 0;                       // Bytes to initialize
+  bool init = false;
+  size_t stride = 4;                     // Write 'value' every 'stride' bytes
+  uint32_t value = 0;
+};
+
+struct profile
+{
+  uint64_t iterations = 1;
+  bool iteration_init = false;           // Re-initialize the bindings every iteration
+  bool verbose = false;
+  std::vector<profile_binding> bindings;
+};
+
+// Parse a recipe file, JSON or the binary form written by save_recipe().
+// With 'fold' false every JSON run entry stays a template of its own.
+// Throws std::runtime_error on unknown names or bad types.
+recipe
+load_recipe(const std::string &fname, bool fold = true);
+
+// Write 'rcp' in the binary form, paths are stored absolute
+void
+save_recipe(const recipe &rcp, const std::string &fname);
+
+// Write 'rcp' as JSON using "repeat" and "chain" for run templates, paths are
+// stored absolute
+void
+save_recipe_json(const recipe &rcp, const std::string &fname);
+
+// Number of commands one pass over the runs of 'rcp' submits
+uint64_t
+recipe_commands(const recipe &rcp);
+
+// Parse a profile file for 'rcp'
+profile
+load_profile(const std::string &fname, const recipe &rcp);
+
+// Timing of one execute() call
+struct recipe_result
+{
+  uint64_t iterations = 0;
+  uint64_t commands = 0;
+  std::chrono::steady_clock::duration elapsed {};
+  latency_histogram latency;             // Start of the first run to completion of the last
+};
+
+class recipe_engine
+{
+public:
+  static constexpr unsigned int default_queue_depth = 64;
+  static constexpr unsigned int default_chain_length = 64;
+
+  // Create the hw_context and kernels, allocate and initialize every buffer
+  // and bind the runs of every template.  At most 'queue_depth' runs that are
+  // not chained are in flight at once, and chains are at most 'chain_length'
+  // runs long.  Buffers come from 'pool' when given, which must outlive the
+  // engine, so that engines created one after the other reuse them.
+  recipe_engine(const xrt::device &device, const recipe &rcp, const profile &prf,
+                unsigned int queue_depth = default_queue_depth, unsigned int chain_length = default_chain_length,
+                bo_pool *pool = nullptr);
+
+  // Run 'iterations' passes over execution.runs, profile iterations when 0
+  recipe_result
+  execute(uint64_t iterations = 0);
+
+  // Host time spent in the constructor
+  std::chrono::steady_clock::duration
+  setup_time() const
+  {
+    return m_setup_time;
+  }
+
+  xrt::bo&
+  buffer(const std::string &name);
+
+private:
+  void
+  initialize_buffers();
+
+  xrt::run
+  bind_run(const recipe_run &r);
+
+  recipe m_recipe;
+  profile m_profile;
+  xrt::device m_device;
+  xrt::hw_context m_hwctx;
+  std::vector<xrt::kernel> m_kernels;
+  std::vector<bo_lease> m_leases;              // Of the pooled buffers, outlive the copies in m_buffers
+  std::vector<xrt::bo> m_buffers;
+  std::vector<std::vector<xrt::run>> m_runs;   // Ring of up to queue-depth runs of a template submitted one by one
+  std::vector<std::vector<xrt::runlist>> m_chains;  // Full length chain and the rest of a repeated template
+  unsigned int m_queue_depth;
+  unsigned int m_chain_length;
+  std::chrono::steady_clock::duration m_setup_time {};
+};
+
+} // namespace vtd
+
+#endif
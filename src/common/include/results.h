@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_RESULTS_H
+#define VTD_RESULTS_H
+
+/* Structured results of the host applications.
+ *
+ * Every application can write its headline numbers with --results-json.  A
+ * metric is named after its test in benchmarks/benchmark_npu*.json and keeps
+ * every sample taken, together with the device id and power mode the
+ * thresholds are selected by:
+ *
+ *   {"app": "df_bw", "device_id": "17f0_10", "pmode": "performance",
+ *    "results": [{"test": "df-bw", "unit": "GB/s", "samples": [55.2],
+ *                 "noise_pct": 0.4}]}
+ *
+ * noise_pct is the host noise floor of the metric, see host_timing.h, and is
+ * only written when the app calibrated it.  bench_compare reads these files
+ * back and checks them against the thresholds.
+ */
+
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+namespace vtd {
+
+struct result_metric
+{
+  std::string test;
+  std::string unit;
+  std::vector<double> samples;
+  double noise_pct = 0;                  // Host noise floor in percent, 0 when unknown
+};
+
+struct result_set
+{
+  std::string app;
+  std::string device_id = "unknown";
+  std::string pmode = "unknown";
+  std::vector<result_metric> metrics;
+
+  // Append a sample to metric 'test', created on first use.  The metric keeps
+  // the largest noise floor of its samples.
+  void
+  add(const std::string &test, const std::string &unit, double value, double noise_pct = 0);
+};
+
+// Fill in the device id and power mode of 'device', both stay "unknown" when
+// the device does not report them
+void
+set_result_device(result_set &results, const xrt::device &device);
+
+void
+write_results_json(const std::string &fname, const result_set &results);
+
+result_set
+load_results(const std::string &fname);
+
+// Latencies, overheads and power draws (<app>-power) are better when lower,
+// everything else is a rate
+bool
+lower_is_better(const std::string &test);
+
+} // namespace vtd
+
+#endif
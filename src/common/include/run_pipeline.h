@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_RUN_PIPELINE_H
+#define VTD_RUN_PIPELINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_kernel.h"
+
+namespace vtd {
+
+/* Submit 'count' commands round robin over 'runs' keeping runs.size() of them
+ * in flight, i.e. runs.size() is the queue depth.  Completions are reaped in
+ * submission order and 'record' is called with the latency from start() to
+ * the return of wait2() of every command.  A depth of one is the classic
+ * serialized start/wait loop.
+ */
+template <typename Record>
+void
+run_pipelined(std::vector<xrt::run> &runs, size_t count, Record &&record)
+{
+  const size_t depth = runs.size();
+  std::vector<std::chrono::steady_clock::time_point> submitted(depth);
+
+  size_t issued = 0;
+  for (size_t reaped = 0; reaped < count; reaped++) {
+    // Top up the queue before waiting on the oldest command
+    for (; issued < count && issued - reaped < depth; issued++) {
+      submitted[issued % depth] = std::chrono::steady_clock::now();
+      runs[issued % depth].start();
+    }
+
+    runs[reaped % depth].wait2();
+    record(std::chrono::steady_clock::now() - submitted[reaped % depth]);
+  }
+}
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_SAMPLE_STATS_H
+#define VTD_SAMPLE_STATS_H
+
+/* Summary statistics of repeated measurements.  The confidence interval uses
+ * Student's t distribution so it stays honest for the small sample counts the
+ * slower tests can afford.
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace vtd {
+
+struct sample_stats
+{
+  size_t count = 0;
+  double mean = 0;
+  double stddev = 0;                     // Sample standard deviation
+  double min = 0;
+  double max = 0;
+  double ci95 = 0;                       // Half width of the 95% confidence interval of the mean
+
+  // Coefficient of variation
+  double
+  cv() const
+  {
+    return mean != 0 ? stddev / mean : 0;
+  }
+};
+
+sample_stats
+summarize_samples(const std::vector<double> &samples);
+
+// Nearest rank percentile of 'samples', q in [0, 1]
+double
+sample_percentile(std::vector<double> samples, double q);
+
+// Straight line y = intercept + slope * x through a set of points
+struct line_fit
+{
+  double intercept = 0;
+  double slope = 0;
+  double r2 = 0;                         // Coefficient of determination
+};
+
+// Weighted least squares fit, equal weights when 'weights' is empty.  Weights
+// of 1 / y^2 fit relative rather than absolute errors, which keeps points
+// spanning several orders of magnitude equally important.
+line_fit
+fit_line(const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &weights = {});
+
+// Two sided 95% quantile of Student's t distribution with 'dof' degrees of freedom
+double
+t_quantile_95(size_t dof);
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_SETUP_CACHE_H
+#define VTD_SETUP_CACHE_H
+
+/* In-process cache of what a host app sets up before its first run.
+ *
+ * xclbins are loaded once per file and registered once per UUID, their DPU
+ * kernel is looked up once, hw_contexts are opened once per UUID and slot and
+ * kernels are resolved once per context and name, or per context and ELF on
+ * the ELF flow.  Tests that measure several configurations on one xclbin, or
+ * the same configuration again, get everything after the first from the
+ * cache.  Slots keep contexts apart that must not be shared, such as one per
+ * tenant.
+ *
+ * Cached contexts keep their columns, release() hands them back before
+ * contexts of another partition are opened.
+ *
+ * Every miss is timed as a phase of the startup profile handed to the
+ * constructor, if any, and hits are counted.
+ */
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <tuple>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+
+#include "startup_profile.h"
+
+namespace vtd {
+
+struct setup_cache_stats
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+class setup_cache
+{
+public:
+  explicit setup_cache(const xrt::device &device, startup_profile *profile = nullptr);
+
+  setup_cache(const setup_cache&) = delete;
+  setup_cache& operator=(const setup_cache&) = delete;
+
+  // The xclbin in 'fname', registered with the device
+  const xrt::xclbin&
+  xclbin(const std::string &fname);
+
+  // Name of the first kernel of the xclbin that starts with DPU or dpu
+  std::string
+  dpu_kernel_name(const std::string &fname);
+
+  xrt::hw_context
+  hw_context(const std::string &fname, unsigned int slot = 0);
+
+  // Kernel 'name' of the context, the DPU kernel when empty
+  xrt::kernel
+  kernel(const std::string &fname, unsigned int slot = 0, const std::string &name = "");
+
+  // Kernel 'name' of the context running the ctrlcode of 'elf'
+  xrt::kernel
+  elf_kernel(const std::string &fname, const std::string &elf, unsigned int slot = 0, const std::string &name = "");
+
+  // Close the contexts of the xclbin and drop their kernels, the xclbin
+  // stays loaded and registered
+  void
+  release(const std::string &fname);
+
+  setup_cache_stats
+  stats() const;
+
+  void
+  print_stats(std::ostream &os) const;
+
+private:
+  struct xclbin_entry
+  {
+    xrt::xclbin xclbin;
+    std::string uuid;
+    std::string dpu_kernel;
+  };
+
+  // Both expect m_lock to be held
+  xclbin_entry&
+  load(const std::string &fname);
+
+  xrt::hw_context
+  context(xclbin_entry &entry, unsigned int slot);
+
+  template <typename Func>
+  auto
+  miss(const std::string &phase, Func &&func)
+  {
+    m_stats.misses++;
+    if (m_profile)
+      return m_profile->time(phase, std::forward<Func>(func));
+    return std::forward<Func>(func)();
+  }
+
+  xrt::device m_device;
+  startup_profile *m_profile;
+  mutable std::mutex m_lock;
+  setup_cache_stats m_stats;
+  std::map<std::string, xclbin_entry> m_xclbins;                           // By file
+  std::set<std::string> m_registered;                                     // UUIDs
+  std::map<std::pair<std::string, unsigned int>, xrt::hw_context> m_contexts;    // By UUID and slot
+  std::map<std::tuple<std::string, unsigned int, std::string, std::string>, xrt::kernel> m_kernels;   // By UUID, slot, ELF and name
+};
+
+} // namespace vtd
+
+#endif
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_STARTUP_PROFILE_H
+#define VTD_STARTUP_PROFILE_H
+
+/* Timeline of the setup phases of a host app.
+ *
+ * Every phase is recorded with its start and end in nanoseconds of the steady
+ * clock since the profile was created, which is meant to be as early in the
+ * app as possible.  time() wraps a setup step and passes on its result,
+ * record() takes a phase measured elsewhere.  print() lists the phases in the
+ * order they first ran with their count, total time and share of the startup,
+ * which runs from creating the profile to the end of the last phase; the time
+ * in between phases is shown as unaccounted.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vtd {
+
+struct startup_phase
+{
+  std::string name;
+  int64_t start_ns = 0;    // Since the profile was created
+  int64_t end_ns = 0;
+};
+
+class startup_profile
+{
+public:
+  startup_profile();
+
+  startup_profile(const startup_profile&) = delete;
+  startup_profile& operator=(const startup_profile&) = delete;
+
+  void
+  record(const std::string &name, std::chrono::steady_clock::time_point start,
+         std::chrono::steady_clock::time_point end);
+
+  // Run 'func' as phase 'name', a phase that throws is not recorded
+  template <typename Func>
+  auto
+  time(const std::string &name, Func &&func)
+  {
+    auto start = std::chrono::steady_clock::now();
+    if constexpr (std::is_void_v<std::invoke_result_t<Func>>) {
+      std::forward<Func>(func)();
+      record(name, start, std::chrono::steady_clock::now());
+    }
+    else {
+      auto result = std::forward<Func>(func)();
+      record(name, start, std::chrono::steady_clock::now());
+      return result;
+    }
+  }
+
+  std::vector<startup_phase>
+  phases() const;
+
+  // From creating the profile to the end of the last phase
+  std::chrono::nanoseconds
+  elapsed() const;
+
+  void
+  print(std::ostream &os, const std::string &title = "Startup") const;
+
+private:
+  std::chrono::steady_clock::time_point m_origin;
+  mutable std::mutex m_lock;
+  std::vector<startup_phase> m_phases;
+};
+
+} // namespace vtd
+
+#endif
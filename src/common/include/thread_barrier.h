@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_THREAD_BARRIER_H
+#define VTD_THREAD_BARRIER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace vtd {
+
+// Single use start line for test threads, so that concurrent contexts begin
+// submitting at the same time instead of in thread creation order
+class thread_barrier
+{
+public:
+  explicit thread_barrier(size_t count) : m_count(count) {}
+
+  void
+  arrive_and_wait()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    if (--m_count == 0) {
+      m_cond.notify_all();
+      return;
+    }
+    m_cond.wait(lock, [this] { return m_count == 0; });
+  }
+
+private:
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  size_t m_count;
+};
+
+} // namespace vtd
+
+#endif
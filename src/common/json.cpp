@@ -0,0 +1,506 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "json.h"
+#include "dpu_sequence.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+const char*
+kind_name(vtd::json_value::kind kind)
+{
+  switch (kind) {
+  case vtd::json_value::kind::null:
+    return "null";
+  case vtd::json_value::kind::boolean:
+    return "boolean";
+  case vtd::json_value::kind::number:
+    return "number";
+  case vtd::json_value::kind::string:
+    return "string";
+  case vtd::json_value::kind::array:
+    return "array";
+  default:
+    return "object";
+  }
+}
+
+void
+expect_kind(const vtd::json_value &value, vtd::json_value::kind kind)
+{
+  if (value.type() != kind)
+    throw std::runtime_error(std::string("Error: JSON value is a ") + kind_name(value.type())
+                             + ", expected a " + kind_name(kind) + "\n");
+}
+
+void
+append_utf8(std::string &out, uint32_t cp)
+{
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xc0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xe0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  } else {
+    out += static_cast<char>(0xf0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  }
+}
+
+} // namespace
+
+namespace vtd {
+
+// Recursive descent parser, one instance per document
+class json_parser
+{
+public:
+  json_parser(const char *begin, const char *end)
+    : m_begin(begin)
+    , m_pos(begin)
+    , m_end(end)
+  {}
+
+  json_value
+  parse_document()
+  {
+    json_value value;
+    parse_value(value, 0);
+    skip_space();
+    if (m_pos != m_end)
+      fail("trailing characters after the document");
+    return value;
+  }
+
+private:
+  static constexpr int max_depth = 256;
+
+  [[noreturn]] void
+  fail(const std::string &what) const
+  {
+    size_t line = 1;
+    for (auto p = m_begin; p < m_pos && p < m_end; p++)
+      line += *p == '\n';
+    throw std::runtime_error("Error: JSON parse error at line " + std::to_string(line) + ": " + what + "\n");
+  }
+
+  void
+  skip_space()
+  {
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+      m_pos++;
+  }
+
+  void
+  expect(char c)
+  {
+    skip_space();
+    if (m_pos == m_end || *m_pos != c)
+      fail(std::string("expected '") + c + "'");
+    m_pos++;
+  }
+
+  bool
+  consume(const char *literal)
+  {
+    auto p = m_pos;
+    for (; *literal; literal++, p++) {
+      if (p == m_end || *p != *literal)
+        return false;
+    }
+    m_pos = p;
+    return true;
+  }
+
+  void
+  parse_value(json_value &value, int depth)
+  {
+    if (depth > max_depth)
+      fail("nesting too deep");
+
+    skip_space();
+    if (m_pos == m_end)
+      fail("unexpected end of input");
+
+    switch (*m_pos) {
+    case '{':
+      parse_object(value, depth);
+      return;
+    case '[':
+      parse_array(value, depth);
+      return;
+    case '"':
+      value.m_kind = json_value::kind::string;
+      parse_string(value.m_string);
+      return;
+    case 't':
+    case 'f':
+      value.m_kind = json_value::kind::boolean;
+      value.m_bool = *m_pos == 't';
+      if (!consume(value.m_bool ? "true" : "false"))
+        fail("invalid literal");
+      return;
+    case 'n':
+      if (!consume("null"))
+        fail("invalid literal");
+      return;
+    default:
+      parse_number(value);
+    }
+  }
+
+  void
+  parse_object(json_value &value, int depth)
+  {
+    value.m_kind = json_value::kind::object;
+    m_pos++;
+    skip_space();
+    if (m_pos < m_end && *m_pos == '}') {
+      m_pos++;
+      return;
+    }
+
+    while (true) {
+      skip_space();
+      if (m_pos == m_end || *m_pos != '"')
+        fail("expected a member name");
+      value.m_object.emplace_back();
+      auto &member = value.m_object.back();
+      parse_string(member.first);
+      expect(':');
+      parse_value(member.second, depth + 1);
+
+      skip_space();
+      if (m_pos < m_end && *m_pos == ',') {
+        m_pos++;
+        continue;
+      }
+      expect('}');
+      return;
+    }
+  }
+
+  void
+  parse_array(json_value &value, int depth)
+  {
+    value.m_kind = json_value::kind::array;
+    m_pos++;
+    skip_space();
+    if (m_pos < m_end && *m_pos == ']') {
+      m_pos++;
+      return;
+    }
+
+    while (true) {
+      value.m_array.emplace_back();
+      parse_value(value.m_array.back(), depth + 1);
+
+      skip_space();
+      if (m_pos < m_end && *m_pos == ',') {
+        m_pos++;
+        continue;
+      }
+      expect(']');
+      return;
+    }
+  }
+
+  uint32_t
+  parse_hex4()
+  {
+    if (m_end - m_pos < 4)
+      fail("truncated \\u escape");
+
+    uint32_t cp = 0;
+    for (int i = 0; i < 4; i++, m_pos++) {
+      char c = *m_pos;
+      cp <<= 4;
+      if (c >= '0' && c <= '9')
+        cp |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        cp |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        cp |= c - 'A' + 10;
+      else
+        fail("invalid \\u escape");
+    }
+    return cp;
+  }
+
+  void
+  parse_string(std::string &out)
+  {
+    m_pos++;
+    while (true) {
+      // Copy runs without escapes in one go
+      auto start = m_pos;
+      while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\')
+        m_pos++;
+      out.append(start, m_pos);
+
+      if (m_pos == m_end)
+        fail("unterminated string");
+      if (*m_pos++ == '"')
+        return;
+
+      if (m_pos == m_end)
+        fail("unterminated string");
+      switch (*m_pos++) {
+      case '"':
+        out += '"';
+        break;
+      case '\\':
+        out += '\\';
+        break;
+      case '/':
+        out += '/';
+        break;
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        auto cp = parse_hex4();
+        if (cp >= 0xd800 && cp < 0xdc00 && consume("\\u")) {
+          auto low = parse_hex4();
+          cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+        }
+        append_utf8(out, cp);
+        break;
+      }
+      default:
+        fail("invalid escape");
+      }
+    }
+  }
+
+  void
+  parse_number(json_value &value)
+  {
+    auto start = m_pos;
+    bool integral = true;
+    if (m_pos < m_end && *m_pos == '-')
+      m_pos++;
+    while (m_pos < m_end && ((*m_pos >= '0' && *m_pos <= '9') || *m_pos == '.' || *m_pos == 'e'
+                             || *m_pos == 'E' || *m_pos == '+' || *m_pos == '-')) {
+      integral = integral && *m_pos >= '0' && *m_pos <= '9';
+      m_pos++;
+    }
+    if (m_pos == start || (m_pos == start + 1 && *start == '-'))
+      fail("unexpected character");
+
+    value.m_kind = json_value::kind::number;
+
+    // Integer literals, the common case in the definitions, skip strtod
+    if (integral) {
+      bool negative = *start == '-';
+      uint64_t magnitude = 0;
+      bool overflow = m_pos - start - negative > 19;
+      for (auto p = start + negative; p < m_pos && !overflow; p++)
+        magnitude = magnitude * 10 + (*p - '0');
+      if (!overflow && (!negative || magnitude <= uint64_t(1) << 63)) {
+        value.m_integral = true;
+        value.m_int = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        value.m_number = negative ? -static_cast<double>(magnitude) : static_cast<double>(magnitude);
+        return;
+      }
+    }
+
+    std::string text(start, m_pos);
+    char *stop = nullptr;
+    value.m_number = std::strtod(text.c_str(), &stop);
+    if (*stop)
+      fail("invalid number '" + text + "'");
+  }
+
+  const char *m_begin;
+  const char *m_pos;
+  const char *m_end;
+};
+
+bool
+json_value::
+as_bool() const
+{
+  expect_kind(*this, kind::boolean);
+  return m_bool;
+}
+
+double
+json_value::
+as_double() const
+{
+  expect_kind(*this, kind::number);
+  return m_number;
+}
+
+int64_t
+json_value::
+as_int() const
+{
+  expect_kind(*this, kind::number);
+  if (m_integral)
+    return m_int;
+  if (m_number != std::floor(m_number))
+    throw std::runtime_error("Error: JSON number " + std::to_string(m_number) + " is not an integer\n");
+  return static_cast<int64_t>(m_number);
+}
+
+uint64_t
+json_value::
+as_uint() const
+{
+  auto value = as_int();
+  if (value < 0 && !(m_integral && m_number > 0))
+    throw std::runtime_error("Error: JSON number " + std::to_string(value) + " is negative\n");
+  return static_cast<uint64_t>(value);
+}
+
+const std::string&
+json_value::
+as_string() const
+{
+  expect_kind(*this, kind::string);
+  return m_string;
+}
+
+const std::vector<json_value>&
+json_value::
+as_array() const
+{
+  expect_kind(*this, kind::array);
+  return m_array;
+}
+
+const std::vector<json_value::member>&
+json_value::
+as_object() const
+{
+  expect_kind(*this, kind::object);
+  return m_object;
+}
+
+const json_value*
+json_value::
+find(const std::string &key) const
+{
+  for (auto &member : as_object()) {
+    if (member.first == key)
+      return &member.second;
+  }
+  return nullptr;
+}
+
+const json_value&
+json_value::
+at(const std::string &key) const
+{
+  auto value = find(key);
+  if (!value)
+    throw std::runtime_error("Error: JSON object has no member '" + key + "'\n");
+  return *value;
+}
+
+int64_t
+json_value::
+get_int(const std::string &key, int64_t dflt) const
+{
+  auto value = find(key);
+  return value ? value->as_int() : dflt;
+}
+
+double
+json_value::
+get_double(const std::string &key, double dflt) const
+{
+  auto value = find(key);
+  return value ? value->as_double() : dflt;
+}
+
+bool
+json_value::
+get_bool(const std::string &key, bool dflt) const
+{
+  auto value = find(key);
+  return value ? value->as_bool() : dflt;
+}
+
+std::string
+json_value::
+get_string(const std::string &key, const std::string &dflt) const
+{
+  auto value = find(key);
+  return value ? value->as_string() : dflt;
+}
+
+size_t
+json_value::
+size() const
+{
+  if (m_kind == kind::array)
+    return m_array.size();
+  if (m_kind == kind::object)
+    return m_object.size();
+  return 0;
+}
+
+json_value
+parse_json(const char *begin, const char *end)
+{
+  return json_parser(begin, end).parse_document();
+}
+
+json_value
+load_json(const std::string &fname)
+{
+  mapped_file file(fname);
+  try {
+    return parse_json(file.data(), file.data() + file.size());
+  }
+  catch (const std::runtime_error &e) {
+    throw std::runtime_error(fname + ": " + e.what());
+  }
+}
+
+std::string
+json_quote(const std::string &s)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string out = "\"";
+  for (unsigned char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += static_cast<char>(c);
+    } else if (c < 0x20) {
+      out += "\\u00";
+      out += digits[c >> 4];
+      out += digits[c & 0xf];
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+  return out + "\"";
+}
+
+} // namespace vtd
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "latency_histogram.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr double reported_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+constexpr const char *reported_names[] = {"p50", "p90", "p99", "p99.9"};
+
+} // namespace
+
+namespace vtd {
+
+void
+latency_histogram::
+merge(const latency_histogram &other)
+{
+  for (size_t i = 0; i < bucket_count; i++)
+    m_buckets[i] += other.m_buckets[i];
+  m_count += other.m_count;
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  m_sum += other.m_sum;
+  m_sum_sq += other.m_sum_sq;
+}
+
+double
+latency_histogram::
+stddev_us() const
+{
+  if (m_count < 2)
+    return 0;
+
+  double mean = m_sum / m_count;
+  double var = (m_sum_sq - mean * m_sum) / (m_count - 1);
+  return var > 0 ? std::sqrt(var) / 1e3 : 0;
+}
+
+std::pair<uint64_t, uint64_t>
+latency_histogram::
+bucket_range(size_t index)
+{
+  if (index < (1u << linear_bits))
+    return {index, index};
+
+  size_t rel = index - (1u << linear_bits);
+  unsigned int msb = static_cast<unsigned int>(rel / sub_buckets) + linear_bits;
+  unsigned int shift = msb - (linear_bits - 1);
+  uint64_t lower = (static_cast<uint64_t>(rel % sub_buckets) + sub_buckets) << shift;
+  return {lower, lower + (uint64_t(1) << shift) - 1};
+}
+
+double
+latency_histogram::
+percentile_us(double q) const
+{
+  if (!m_count)
+    return 0;
+
+  auto target = static_cast<uint64_t>(std::ceil(q * m_count));
+  target = std::max<uint64_t>(target, 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < bucket_count; i++) {
+    seen += m_buckets[i];
+    if (seen >= target)
+      return std::min(bucket_range(i).second, m_max) / 1e3;
+  }
+  return max_us();
+}
+
+void
+latency_histogram::
+print(std::ostream &os, const std::string &label) const
+{
+  auto flags = os.flags();
+  auto precision = os.precision();
+
+  os << label << " (us):" << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < std::size(reported_quantiles); i++)
+    os << " " << reported_names[i] << " " << percentile_us(reported_quantiles[i]);
+  os << " max " << max_us() << " mean " << mean_us() << " stddev " << stddev_us()
+     << " (n=" << m_count << ")\n";
+
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void
+latency_histogram::
+to_json(std::ostream &os, const std::string &name) const
+{
+  os << "{\"name\": \"" << name << "\", \"unit\": \"ns\", \"count\": " << m_count
+     << ", \"min\": " << (m_count ? m_min : 0) << ", \"max\": " << m_max
+     << ", \"mean\": " << (m_count ? m_sum / m_count : 0) << ", \"stddev\": " << stddev_us() * 1e3
+     << ", \"percentiles\": {";
+  for (size_t i = 0; i < std::size(reported_quantiles); i++) {
+    os << (i ? ", " : "") << "\"" << reported_names[i] << "\": "
+       << static_cast<uint64_t>(percentile_us(reported_quantiles[i]) * 1e3);
+  }
+  os << "}, \"buckets\": [";
+
+  bool first = true;
+  for (size_t i = 0; i < bucket_count; i++) {
+    if (!m_buckets[i])
+      continue;
+    auto range = bucket_range(i);
+    os << (first ? "" : ", ") << "[" << range.first << ", " << range.second << ", " << m_buckets[i] << "]";
+    first = false;
+  }
+  os << "]}";
+}
+
+void
+write_histograms_json(const std::string &fname,
+                      const std::vector<std::pair<std::string, latency_histogram>> &histograms)
+{
+  std::ofstream ofs(fname);
+  if (!ofs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+
+  ofs << "{\"histograms\": [\n";
+  for (size_t i = 0; i < histograms.size(); i++) {
+    ofs << "  ";
+    histograms[i].second.to_json(ofs, histograms[i].first);
+    ofs << (i + 1 < histograms.size() ? ",\n" : "\n");
+  }
+  ofs << "]}\n";
+}
+
+} // namespace vtd
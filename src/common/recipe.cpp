@@ -0,0 +1,656 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "recipe.h"
+#include "data_pattern.h"
+#include "dpu_sequence.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+// XRT includes
+#include "experimental/xrt_elf.h"
+#include "experimental/xrt_ext.h"
+#include "experimental/xrt_module.h"
+#include "experimental/xrt_xclbin.h"
+
+namespace {
+
+constexpr char binary_magic[8] = {'V', 'T', 'D', 'R', 'C', 'P', '0', '2'};
+
+template <typename Item>
+size_t
+find_index(const std::vector<Item> &items, const std::string &name, const char *what)
+{
+  for (size_t i = 0; i < items.size(); i++) {
+    if (items[i].name == name)
+      return i;
+  }
+  throw std::runtime_error(std::string("Error: Unknown ") + what + " '" + name + "' in recipe\n");
+}
+
+std::string
+resolve_path(const std::filesystem::path &dir, const std::string &path)
+{
+  if (path.empty() || std::filesystem::path(path).is_absolute())
+    return path;
+  return (dir / path).string();
+}
+
+// Arrays that are optional in the definitions, e.g. "constants" of a ve2 run
+const std::vector<vtd::json_value>&
+optional_array(const vtd::json_value &obj, const std::string &key)
+{
+  static const std::vector<vtd::json_value> empty;
+  auto value = obj.find(key);
+  return value ? value->as_array() : empty;
+}
+
+int
+to_argidx(const vtd::json_value &obj)
+{
+  auto argidx = obj.at("argidx").as_int();
+  if (argidx < 0 || argidx > std::numeric_limits<int>::max())
+    throw std::runtime_error("Error: Invalid argidx " + std::to_string(argidx) + " in recipe\n");
+  return static_cast<int>(argidx);
+}
+
+bool
+same_binding(const vtd::recipe_run &a, const vtd::recipe_run &b)
+{
+  if (a.kernel != b.kernel || a.arguments.size() != b.arguments.size() || a.constants.size() != b.constants.size())
+    return false;
+  for (size_t i = 0; i < a.arguments.size(); i++) {
+    if (a.arguments[i].buffer != b.arguments[i].buffer || a.arguments[i].argidx != b.arguments[i].argidx)
+      return false;
+  }
+  for (size_t i = 0; i < a.constants.size(); i++) {
+    if (a.constants[i].argidx != b.constants[i].argidx || a.constants[i].type != b.constants[i].type
+        || a.constants[i].value != b.constants[i].value)
+      return false;
+  }
+  return true;
+}
+
+std::string
+absolute_path(const std::string &path)
+{
+  return path.empty() ? path : std::filesystem::absolute(path).string();
+}
+
+// Little endian serialization of the binary recipe form
+class binary_writer
+{
+public:
+  void
+  put(uint64_t value)
+  {
+    for (int i = 0; i < 8; i++)
+      m_data += static_cast<char>(value >> (8 * i));
+  }
+
+  void
+  put(const std::string &str)
+  {
+    put(str.size());
+    m_data += str;
+  }
+
+  void
+  write(const std::string &fname) const
+  {
+    std::ofstream ofs(fname, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+      throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+    ofs.write(binary_magic, sizeof(binary_magic));
+    ofs.write(m_data.data(), m_data.size());
+    if (!ofs)
+      throw std::runtime_error("Error: Failure writing file " + fname + "\n");
+  }
+
+private:
+  std::string m_data;
+};
+
+class binary_reader
+{
+public:
+  binary_reader(const char *begin, const char *end, const std::string &fname)
+    : m_pos(begin + sizeof(binary_magic))
+    , m_end(end)
+    , m_fname(fname)
+  {}
+
+  uint64_t
+  get()
+  {
+    check(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+      value |= static_cast<uint64_t>(static_cast<unsigned char>(m_pos[i])) << (8 * i);
+    m_pos += 8;
+    return value;
+  }
+
+  // Element count of a list, bounded by the bytes left so corrupt files cannot
+  // trigger huge allocations
+  size_t
+  get_count()
+  {
+    auto count = get();
+    check(count);
+    return count;
+  }
+
+  std::string
+  get_string()
+  {
+    auto len = get_count();
+    std::string str(m_pos, len);
+    m_pos += len;
+    return str;
+  }
+
+  bool
+  done() const
+  {
+    return m_pos == m_end;
+  }
+
+private:
+  void
+  check(uint64_t bytes) const
+  {
+    if (bytes > static_cast<uint64_t>(m_end - m_pos))
+      throw std::runtime_error("Error: Truncated binary recipe " + m_fname + "\n");
+  }
+
+  const char *m_pos;
+  const char *m_end;
+  std::string m_fname;
+};
+
+vtd::recipe
+read_binary_recipe(const vtd::mapped_file &file, const std::string &fname)
+{
+  binary_reader in(file.data(), file.data() + file.size(), fname);
+  vtd::recipe rcp;
+
+  rcp.xclbin = in.get_string();
+  rcp.program = in.get_string();
+
+  rcp.buffers.resize(in.get_count());
+  for (auto &buffer : rcp.buffers) {
+    buffer.name = in.get_string();
+    buffer.type = in.get_string();
+    buffer.size = in.get();
+  }
+
+  rcp.kernels.resize(in.get_count());
+  for (auto &kernel : rcp.kernels) {
+    kernel.name = in.get_string();
+    kernel.instance = in.get_string();
+    kernel.ctrlcode = in.get_string();
+  }
+
+  rcp.runs.resize(in.get_count());
+  for (auto &run : rcp.runs) {
+    run.kernel = in.get();
+    run.repeat = in.get();
+    run.chain = in.get() != 0;
+    run.arguments.resize(in.get_count());
+    for (auto &arg : run.arguments) {
+      arg.buffer = in.get();
+      arg.argidx = static_cast<int>(in.get());
+    }
+    run.constants.resize(in.get_count());
+    for (auto &c : run.constants) {
+      c.argidx = static_cast<int>(in.get());
+      c.type = in.get_string();
+      c.value = static_cast<int64_t>(in.get());
+    }
+
+    bool valid = run.kernel < rcp.kernels.size() && run.repeat > 0 && (!run.chain || run.repeat > 1);
+    for (auto &arg : run.arguments)
+      valid = valid && arg.buffer < rcp.buffers.size();
+    if (!valid)
+      throw std::runtime_error("Error: Corrupt binary recipe " + fname + "\n");
+  }
+
+  if (!in.done() || rcp.runs.empty())
+    throw std::runtime_error("Error: Corrupt binary recipe " + fname + "\n");
+  return rcp;
+}
+
+vtd::recipe
+parse_json_recipe(const vtd::json_value &doc, const std::string &fname, bool fold)
+{
+  auto dir = std::filesystem::path(fname).parent_path();
+  vtd::recipe rcp;
+
+  auto &header = doc.at("header");
+  rcp.xclbin = resolve_path(dir, header.get_string("xclbin", ""));
+  rcp.program = resolve_path(dir, header.get_string("program", ""));
+  if (rcp.xclbin.empty() == rcp.program.empty())
+    throw std::runtime_error("Error: Recipe " + fname + " needs exactly one of header.xclbin and header.program\n");
+
+  auto &resources = doc.at("resources");
+  for (auto &buf : optional_array(resources, "buffers")) {
+    vtd::recipe_buffer buffer;
+    buffer.name = buf.at("name").as_string();
+    buffer.type = buf.get_string("type", "input");
+    buffer.size = buf.at("size").as_uint();
+    rcp.buffers.push_back(std::move(buffer));
+  }
+
+  for (auto &krnl : resources.at("kernels").as_array()) {
+    vtd::recipe_kernel kernel;
+    kernel.name = krnl.at("name").as_string();
+    kernel.instance = krnl.at("instance").as_string();
+    kernel.ctrlcode = resolve_path(dir, krnl.get_string("ctrlcode", ""));
+    rcp.kernels.push_back(std::move(kernel));
+  }
+
+  for (auto &r : doc.at("execution").at("runs").as_array()) {
+    vtd::recipe_run run;
+    run.kernel = find_index(rcp.kernels, r.at("name").as_string(), "kernel");
+
+    for (auto &arg : optional_array(r, "arguments"))
+      run.arguments.push_back({find_index(rcp.buffers, arg.at("name").as_string(), "buffer"), to_argidx(arg)});
+
+    for (auto &c : optional_array(r, "constants")) {
+      vtd::recipe_constant constant {to_argidx(c), c.get_string("type", "int"), c.at("value").as_int()};
+      if (constant.type != "int" && constant.type != "uint" && constant.type != "int64" && constant.type != "uint64")
+        throw std::runtime_error("Error: Unsupported constant type '" + constant.type + "' in recipe\n");
+      run.constants.push_back(std::move(constant));
+    }
+
+    // Only an explicit repeat count makes a command chain
+    bool counted = r.find("repeat") || r.find("count");
+    if (r.find("repeat") && r.find("count"))
+      throw std::runtime_error("Error: Run with both repeat and count in recipe\n");
+    auto repeat = r.get_int(r.find("count") ? "count" : "repeat", 1);
+    if (repeat < 1)
+      throw std::runtime_error("Error: Invalid repeat " + std::to_string(repeat) + " in recipe\n");
+    run.repeat = static_cast<uint64_t>(repeat);
+    run.chain = counted && repeat > 1 && r.get_bool("chain", true);
+
+    // Fold runs identical to the previous entry into one template, they are
+    // still submitted one by one
+    if (fold && !run.chain && !rcp.runs.empty() && !rcp.runs.back().chain && same_binding(rcp.runs.back(), run))
+      rcp.runs.back().repeat += run.repeat;
+    else
+      rcp.runs.push_back(std::move(run));
+  }
+
+  if (rcp.runs.empty())
+    throw std::runtime_error("Error: Recipe " + fname + " has no runs\n");
+  return rcp;
+}
+
+} // namespace
+
+namespace vtd {
+
+recipe
+load_recipe(const std::string &fname, bool fold)
+{
+  mapped_file file(fname);
+  if (file.size() >= sizeof(binary_magic) && !std::memcmp(file.data(), binary_magic, sizeof(binary_magic)))
+    return read_binary_recipe(file, fname);
+
+  json_value doc;
+  try {
+    doc = parse_json(file.data(), file.data() + file.size());
+  }
+  catch (const std::runtime_error &e) {
+    throw std::runtime_error(fname + ": " + e.what());
+  }
+  return parse_json_recipe(doc, fname, fold);
+}
+
+void
+save_recipe(const recipe &rcp, const std::string &fname)
+{
+  binary_writer out;
+  out.put(absolute_path(rcp.xclbin));
+  out.put(absolute_path(rcp.program));
+
+  out.put(rcp.buffers.size());
+  for (auto &buffer : rcp.buffers) {
+    out.put(buffer.name);
+    out.put(buffer.type);
+    out.put(buffer.size);
+  }
+
+  out.put(rcp.kernels.size());
+  for (auto &kernel : rcp.kernels) {
+    out.put(kernel.name);
+    out.put(kernel.instance);
+    out.put(absolute_path(kernel.ctrlcode));
+  }
+
+  out.put(rcp.runs.size());
+  for (auto &run : rcp.runs) {
+    out.put(run.kernel);
+    out.put(run.repeat);
+    out.put(static_cast<uint64_t>(run.chain));
+    out.put(run.arguments.size());
+    for (auto &arg : run.arguments) {
+      out.put(arg.buffer);
+      out.put(static_cast<uint64_t>(arg.argidx));
+    }
+    out.put(run.constants.size());
+    for (auto &c : run.constants) {
+      out.put(static_cast<uint64_t>(c.argidx));
+      out.put(c.type);
+      out.put(static_cast<uint64_t>(c.value));
+    }
+  }
+
+  out.write(fname);
+}
+
+void
+save_recipe_json(const recipe &rcp, const std::string &fname)
+{
+  std::ofstream ofs(fname);
+  if (!ofs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+
+  ofs << "{\n  \"version\": \"1.0\",\n  \"header\": {\n    "
+      << (rcp.xclbin.empty() ? "\"program\": " + json_quote(absolute_path(rcp.program))
+                             : "\"xclbin\": " + json_quote(absolute_path(rcp.xclbin)))
+      << "\n  },\n  \"resources\": {\n    \"buffers\": [";
+  for (size_t i = 0; i < rcp.buffers.size(); i++) {
+    auto &buffer = rcp.buffers[i];
+    ofs << (i ? ",\n" : "\n") << "      { \"name\": " << json_quote(buffer.name) << ", \"type\": "
+        << json_quote(buffer.type) << ", \"size\": " << buffer.size << " }";
+  }
+  ofs << "\n    ],\n    \"kernels\": [";
+  for (size_t i = 0; i < rcp.kernels.size(); i++) {
+    auto &kernel = rcp.kernels[i];
+    ofs << (i ? ",\n" : "\n") << "      { \"name\": " << json_quote(kernel.name) << ", \"instance\": "
+        << json_quote(kernel.instance);
+    if (!kernel.ctrlcode.empty())
+      ofs << ", \"ctrlcode\": " << json_quote(absolute_path(kernel.ctrlcode));
+    ofs << " }";
+  }
+  ofs << "\n    ]\n  },\n  \"execution\": {\n    \"runs\": [";
+  for (size_t i = 0; i < rcp.runs.size(); i++) {
+    auto &run = rcp.runs[i];
+    ofs << (i ? ",\n" : "\n") << "      {\n        \"name\": " << json_quote(rcp.kernels[run.kernel].name) << ",\n";
+    if (run.repeat > 1)
+      ofs << "        \"repeat\": " << run.repeat << ",\n";
+    if (run.repeat > 1 && !run.chain)
+      ofs << "        \"chain\": false,\n";
+    ofs << "        \"arguments\": [";
+    for (size_t j = 0; j < run.arguments.size(); j++) {
+      ofs << (j ? ", " : " ") << "{ \"name\": " << json_quote(rcp.buffers[run.arguments[j].buffer].name)
+          << ", \"argidx\": " << run.arguments[j].argidx << " }";
+    }
+    ofs << " ],\n        \"constants\": [";
+    for (size_t j = 0; j < run.constants.size(); j++) {
+      ofs << (j ? ", " : " ") << "{ \"value\": " << run.constants[j].value << ", \"type\": "
+          << json_quote(run.constants[j].type) << ", \"argidx\": " << run.constants[j].argidx << " }";
+    }
+    ofs << " ]\n      }";
+  }
+  ofs << "\n    ]\n  }\n}\n";
+
+  if (!ofs)
+    throw std::runtime_error("Error: Failure writing file " + fname + "\n");
+}
+
+uint64_t
+recipe_commands(const recipe &rcp)
+{
+  uint64_t commands = 0;
+  for (auto &run : rcp.runs)
+    commands += run.repeat;
+  return commands;
+}
+
+profile
+load_profile(const std::string &fname, const recipe &rcp)
+{
+  auto doc = load_json(fname);
+  profile prf;
+
+  auto &execution = doc.at("execution");
+  prf.iterations = execution.at("iterations").as_uint();
+  prf.verbose = execution.get_bool("verbose", false);
+  if (auto iteration = execution.find("iteration"))
+    prf.iteration_init = iteration->get_bool("init", false);
+
+  for (auto &b : optional_array(doc, "bindings")) {
+    profile_binding binding;
+    binding.buffer = find_index(rcp.buffers, b.at("name").as_string(), "binding");
+    binding.size = b.get_int("size", rcp.buffers[binding.buffer].size);
+    if (binding.size > rcp.buffers[binding.buffer].size)
+      throw std::runtime_error("Error: Binding '" + rcp.buffers[binding.buffer].name + "' is larger than its buffer\n");
+
+    if (auto init = b.find("init")) {
+      binding.init = true;
+      binding.stride = init->get_int("stride", 4);
+      binding.value = static_cast<uint32_t>(init->at("value").as_uint());
+      if (binding.stride < sizeof(uint32_t))
+        throw std::runtime_error("Error: Binding '" + rcp.buffers[binding.buffer].name + "' stride is below 4 bytes\n");
+    }
+    prf.bindings.push_back(binding);
+  }
+  return prf;
+}
+
+recipe_engine::
+recipe_engine(const xrt::device &device, const recipe &rcp, const profile &prf, unsigned int queue_depth,
+              unsigned int chain_length, bo_pool *pool)
+  : m_recipe(rcp)
+  , m_profile(prf)
+  , m_device(device)
+  , m_queue_depth(std::max(queue_depth, 1u))
+  , m_chain_length(std::max(chain_length, 1u))
+{
+  auto start = std::chrono::steady_clock::now();
+
+  if (!m_recipe.xclbin.empty()) {
+    auto xclbin = xrt::xclbin(m_recipe.xclbin);
+    m_device.register_xclbin(xclbin);
+    m_hwctx = xrt::hw_context(m_device, xclbin.get_uuid());
+    for (auto &kernel : m_recipe.kernels) {
+      if (kernel.ctrlcode.empty()) {
+        m_kernels.emplace_back(m_hwctx, kernel.instance);
+      } else {
+        xrt::elf elf(kernel.ctrlcode);
+        xrt::module mod(elf);
+        m_kernels.push_back(xrt::ext::kernel(m_hwctx, mod, kernel.instance));
+      }
+    }
+  } else {
+    xrt::elf elf(m_recipe.program);
+    m_hwctx = xrt::hw_context(m_device, elf);
+    for (auto &kernel : m_recipe.kernels)
+      m_kernels.push_back(xrt::ext::kernel(m_hwctx, kernel.instance));
+  }
+
+  // Buffers take the memory group of the first argument they are bound to
+  std::vector<int> group(m_recipe.buffers.size(), -1);
+  for (auto &run : m_recipe.runs) {
+    for (auto &arg : run.arguments) {
+      if (group[arg.buffer] < 0)
+        group[arg.buffer] = m_kernels[run.kernel].group_id(arg.argidx);
+    }
+  }
+  for (size_t i = 0; i < m_recipe.buffers.size(); i++) {
+    auto grp = std::max(group[i], 0);
+    if (pool) {
+      m_leases.push_back(pool->acquire(m_recipe.buffers[i].size, XRT_BO_FLAGS_HOST_ONLY, grp));
+      m_buffers.push_back(m_leases.back().bo());
+    } else {
+      m_buffers.emplace_back(m_device, m_recipe.buffers[i].size, XRT_BO_FLAGS_HOST_ONLY, grp);
+    }
+  }
+
+  initialize_buffers();
+
+  // A chained template is a chain of up to chain-length runs, executed again
+  // until the repeat count is reached, and a shorter chain for what is left.
+  // A run can only be on one list, so each chain has runs of its own.  Other
+  // templates cycle through as many runs as can be in flight at once.
+  m_runs.resize(m_recipe.runs.size());
+  m_chains.resize(m_recipe.runs.size());
+  for (size_t t = 0; t < m_recipe.runs.size(); t++) {
+    auto &r = m_recipe.runs[t];
+    if (!r.chain) {
+      for (uint64_t i = 0; i < std::min<uint64_t>(r.repeat, m_queue_depth); i++)
+        m_runs[t].push_back(bind_run(r));
+      continue;
+    }
+
+    auto length = std::min<uint64_t>(r.repeat, m_chain_length);
+    for (auto count : {length, r.repeat % length}) {
+      if (!count)
+        continue;
+      m_chains[t].emplace_back(m_hwctx);
+      for (uint64_t i = 0; i < count; i++)
+        m_chains[t].back().add(bind_run(r));
+    }
+  }
+
+  m_setup_time = std::chrono::steady_clock::now() - start;
+
+  if (m_profile.verbose) {
+    std::cout << "Recipe: " << (m_recipe.xclbin.empty() ? m_recipe.program : m_recipe.xclbin) << ", "
+              << m_buffers.size() << " buffers, " << m_kernels.size() << " kernels, " << m_recipe.runs.size()
+              << " run templates, " << recipe_commands(m_recipe) << " commands per iteration\n";
+    for (size_t i = 0; i < m_recipe.buffers.size(); i++)
+      std::cout << "  buffer " << m_recipe.buffers[i].name << " (" << m_recipe.buffers[i].type << ") "
+                << m_recipe.buffers[i].size << " bytes, group " << std::max(group[i], 0) << "\n";
+  }
+}
+
+xrt::run
+recipe_engine::
+bind_run(const recipe_run &r)
+{
+  xrt::run run(m_kernels[r.kernel]);
+  for (auto &c : r.constants) {
+    if (c.type == "int")
+      run.set_arg(c.argidx, static_cast<int32_t>(c.value));
+    else if (c.type == "uint")
+      run.set_arg(c.argidx, static_cast<uint32_t>(c.value));
+    else if (c.type == "int64")
+      run.set_arg(c.argidx, static_cast<int64_t>(c.value));
+    else
+      run.set_arg(c.argidx, static_cast<uint64_t>(c.value));
+  }
+  for (auto &arg : r.arguments)
+    run.set_arg(arg.argidx, m_buffers[arg.buffer]);
+  return run;
+}
+
+void
+recipe_engine::
+initialize_buffers()
+{
+  for (auto &binding : m_profile.bindings) {
+    if (!binding.init)
+      continue;
+
+    auto data = m_buffers[binding.buffer].map<char*>();
+    auto value = binding.value;
+    auto stride = binding.stride;
+    if (stride == sizeof(uint32_t)) {
+      auto words = reinterpret_cast<uint32_t*>(data);
+      parallel_chunks(binding.size / stride, 0, [words, value](size_t begin, size_t end) {
+        std::fill(words + begin, words + end, value);
+      });
+    } else {
+      parallel_chunks(binding.size / stride, 0, [data, value, stride](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          std::memcpy(data + i * stride, &value, sizeof(value));
+      });
+    }
+  }
+
+  for (size_t i = 0; i < m_buffers.size(); i++) {
+    if (m_recipe.buffers[i].type != "output")
+      m_buffers[i].sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  }
+}
+
+recipe_result
+recipe_engine::
+execute(uint64_t iterations)
+{
+  recipe_result result;
+  result.iterations = iterations ? iterations : m_profile.iterations;
+  result.commands = result.iterations * recipe_commands(m_recipe);
+
+  // Ring of the runs in flight, completions are reaped in submission order
+  std::vector<xrt::run*> inflight(m_queue_depth);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t it = 0; it < result.iterations; it++) {
+    if (m_profile.iteration_init && it)
+      initialize_buffers();
+
+    // All runs are bound already, an iteration only submits and reaps them.
+    // A chain follows the runs before it, so those are reaped first.
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t submitted = 0;
+    uint64_t reaped = 0;
+    auto reap = [&](uint64_t keep) {
+      while (submitted - reaped > keep)
+        inflight[reaped++ % m_queue_depth]->wait2();
+    };
+    for (size_t t = 0; t < m_recipe.runs.size(); t++) {
+      auto &chains = m_chains[t];
+      if (chains.empty()) {
+        auto &runs = m_runs[t];
+        for (uint64_t i = 0; i < m_recipe.runs[t].repeat; i++) {
+          reap(m_queue_depth - 1);
+          auto &slot = inflight[submitted++ % m_queue_depth];
+          slot = &runs[i % runs.size()];
+          slot->start();
+        }
+        continue;
+      }
+
+      reap(0);
+      auto full = m_recipe.runs[t].repeat / std::min<uint64_t>(m_recipe.runs[t].repeat, m_chain_length);
+      for (uint64_t i = 0; i < full; i++) {
+        chains[0].execute();
+        chains[0].wait();
+      }
+      if (chains.size() > 1) {
+        chains[1].execute();
+        chains[1].wait();
+      }
+    }
+    reap(0);
+    result.latency.record(std::chrono::steady_clock::now() - begin);
+  }
+  result.elapsed = std::chrono::steady_clock::now() - start;
+
+  for (size_t i = 0; i < m_buffers.size(); i++) {
+    if (m_recipe.buffers[i].type != "input")
+      m_buffers[i].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+  }
+  return result;
+}
+
+xrt::bo&
+recipe_engine::
+buffer(const std::string &name)
+{
+  return m_buffers[find_index(m_recipe.buffers, name, "buffer")];
+}
+
+} // namespace vtd
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "results.h"
+#include "device_control.h"
+#include "json.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace vtd {
+
+void
+result_set::
+add(const std::string &test, const std::string &unit, double value, double noise_pct)
+{
+  for (auto &metric : metrics) {
+    if (metric.test == test) {
+      metric.samples.push_back(value);
+      metric.noise_pct = std::max(metric.noise_pct, noise_pct);
+      return;
+    }
+  }
+  metrics.push_back({test, unit, {value}, noise_pct});
+}
+
+void
+set_result_device(result_set &results, const xrt::device &device)
+{
+  // The results are still worth writing when xrt-smi is not usable
+  auto control = make_device_control(device);
+  try {
+    results.device_id = control->device_id();
+  }
+  catch (const std::exception&) {
+  }
+  try {
+    results.pmode = control->power_mode();
+  }
+  catch (const std::exception&) {
+  }
+}
+
+void
+write_results_json(const std::string &fname, const result_set &results)
+{
+  std::ofstream ofs(fname);
+  if (!ofs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+
+  ofs << std::setprecision(std::numeric_limits<double>::max_digits10);
+  ofs << "{\"app\": " << json_quote(results.app) << ", \"device_id\": " << json_quote(results.device_id)
+      << ", \"pmode\": " << json_quote(results.pmode) << ",\n \"results\": [";
+  for (size_t i = 0; i < results.metrics.size(); i++) {
+    auto &metric = results.metrics[i];
+    ofs << (i ? ",\n" : "\n") << "  {\"test\": " << json_quote(metric.test) << ", \"unit\": "
+        << json_quote(metric.unit) << ", \"samples\": [";
+    for (size_t s = 0; s < metric.samples.size(); s++)
+      ofs << (s ? ", " : "") << metric.samples[s];
+    ofs << "]";
+    if (metric.noise_pct > 0)
+      ofs << ", \"noise_pct\": " << metric.noise_pct;
+    ofs << "}";
+  }
+  ofs << "\n]}\n";
+}
+
+result_set
+load_results(const std::string &fname)
+{
+  auto doc = load_json(fname);
+  try {
+    result_set results;
+    results.app = doc.get_string("app", "");
+    results.device_id = doc.get_string("device_id", "unknown");
+    results.pmode = doc.get_string("pmode", "unknown");
+    for (auto &entry : doc.at("results").as_array()) {
+      result_metric metric;
+      metric.test = entry.at("test").as_string();
+      metric.unit = entry.get_string("unit", "");
+      for (auto &sample : entry.at("samples").as_array())
+        metric.samples.push_back(sample.as_double());
+      metric.noise_pct = entry.get_double("noise_pct", 0);
+      results.metrics.push_back(std::move(metric));
+    }
+    return results;
+  }
+  catch (const std::runtime_error &e) {
+    throw std::runtime_error(fname + ": " + e.what());
+  }
+}
+
+bool
+lower_is_better(const std::string &test)
+{
+  static const std::string power = "-power";
+  if (test.size() >= power.size() && test.compare(test.size() - power.size(), power.size(), power) == 0)
+    return true;
+  return test.find("latency") != std::string::npos || test.find("overhead") != std::string::npos;
+}
+
+} // namespace vtd
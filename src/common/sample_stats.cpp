@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "sample_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+// t(0.975, dof) for 1 to 30 degrees of freedom
+constexpr double t_table[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+} // namespace
+
+namespace vtd {
+
+double
+t_quantile_95(size_t dof)
+{
+  if (dof == 0)
+    return 0;
+  if (dof <= std::size(t_table))
+    return t_table[dof - 1];
+  // Beyond the table the quantile approaches the normal one, this expansion
+  // is within 0.001 of the exact value
+  double d = static_cast<double>(dof);
+  return 1.959964 + 2.37228 / d + 2.82202 / (d * d);
+}
+
+sample_stats
+summarize_samples(const std::vector<double> &samples)
+{
+  sample_stats stats;
+  stats.count = samples.size();
+  if (samples.empty())
+    return stats;
+
+  auto range = std::minmax_element(samples.begin(), samples.end());
+  stats.min = *range.first;
+  stats.max = *range.second;
+
+  // Welford's update keeps the variance accurate for large, close values
+  double mean = 0;
+  double m2 = 0;
+  size_t n = 0;
+  for (auto x : samples) {
+    n++;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+  }
+  stats.mean = mean;
+  if (n > 1) {
+    stats.stddev = std::sqrt(m2 / (n - 1));
+    stats.ci95 = t_quantile_95(n - 1) * stats.stddev / std::sqrt(static_cast<double>(n));
+  }
+  return stats;
+}
+
+double
+sample_percentile(std::vector<double> samples, double q)
+{
+  if (samples.empty())
+    return 0;
+  auto rank = static_cast<size_t>(std::ceil(std::clamp(q, 0.0, 1.0) * samples.size()));
+  auto nth = samples.begin() + (rank ? rank - 1 : 0);
+  std::nth_element(samples.begin(), nth, samples.end());
+  return *nth;
+}
+
+line_fit
+fit_line(const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &weights)
+{
+  line_fit fit;
+  size_t n = std::min(x.size(), y.size());
+  if (n == 0)
+    return fit;
+
+  // Weighted means first, then the centered sums, which stay accurate when x
+  // is large compared to its spread
+  double sw = 0, mx = 0, my = 0;
+  for (size_t i = 0; i < n; i++) {
+    double w = i < weights.size() ? weights[i] : 1;
+    sw += w;
+    mx += w * x[i];
+    my += w * y[i];
+  }
+  if (sw <= 0)
+    return fit;
+  mx /= sw;
+  my /= sw;
+
+  double sxx = 0, sxy = 0, syy = 0;
+  for (size_t i = 0; i < n; i++) {
+    double w = i < weights.size() ? weights[i] : 1;
+    sxx += w * (x[i] - mx) * (x[i] - mx);
+    sxy += w * (x[i] - mx) * (y[i] - my);
+    syy += w * (y[i] - my) * (y[i] - my);
+  }
+  fit.slope = sxx > 0 ? sxy / sxx : 0;
+  fit.intercept = my - fit.slope * mx;
+  fit.r2 = sxx > 0 && syy > 0 ? sxy * sxy / (sxx * syy) : 1;
+  return fit;
+}
+
+} // namespace vtd
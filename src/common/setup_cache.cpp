@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "setup_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+// XRT includes
+#include "experimental/xrt_elf.h"
+#include "experimental/xrt_ext.h"
+#include "experimental/xrt_module.h"
+
+namespace vtd {
+
+setup_cache::
+setup_cache(const xrt::device &device, startup_profile *profile)
+  : m_device(device)
+  , m_profile(profile)
+{}
+
+setup_cache::xclbin_entry&
+setup_cache::
+load(const std::string &fname)
+{
+  auto it = m_xclbins.find(fname);
+  if (it != m_xclbins.end())
+    return it->second;
+
+  xclbin_entry entry;
+  entry.xclbin = miss("xclbin load", [&fname] { return xrt::xclbin(fname); });
+  entry.uuid = entry.xclbin.get_uuid().to_string();
+
+  // Copies of one xclbin under another name are registered once
+  if (m_registered.count(entry.uuid))
+    m_stats.hits++;
+  else {
+    miss("xclbin register", [this, &entry] { return m_device.register_xclbin(entry.xclbin); });
+    m_registered.insert(entry.uuid);
+  }
+  return m_xclbins.emplace(fname, std::move(entry)).first->second;
+}
+
+xrt::hw_context
+setup_cache::
+context(xclbin_entry &entry, unsigned int slot)
+{
+  auto key = std::make_pair(entry.uuid, slot);
+  auto it = m_contexts.find(key);
+  if (it != m_contexts.end()) {
+    m_stats.hits++;
+    return it->second;
+  }
+
+  auto hwctx = miss("hw_context", [this, &entry] { return xrt::hw_context(m_device, entry.xclbin.get_uuid()); });
+  m_contexts.emplace(key, hwctx);
+  return hwctx;
+}
+
+const xrt::xclbin&
+setup_cache::
+xclbin(const std::string &fname)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_stats.hits += m_xclbins.count(fname);
+  return load(fname).xclbin;
+}
+
+std::string
+setup_cache::
+dpu_kernel_name(const std::string &fname)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto &entry = load(fname);
+  if (!entry.dpu_kernel.empty()) {
+    m_stats.hits++;
+    return entry.dpu_kernel;
+  }
+
+  entry.dpu_kernel = miss("kernel lookup", [&entry] {
+    auto xkernels = entry.xclbin.get_kernels();
+    auto xkernel = std::find_if(xkernels.begin(), xkernels.end(), [](xrt::xclbin::kernel& k) {
+      auto name = k.get_name();
+      // Starts with "DPU" or "dpu"
+      return name.rfind("DPU", 0) == 0 || name.rfind("dpu", 0) == 0;
+    });
+    if (xkernel == xkernels.end())
+      return std::string();
+    return xkernel->get_name();
+  });
+  if (entry.dpu_kernel.empty())
+    throw std::runtime_error("Error: Failure to find DPU kernel in " + fname + "\n");
+  return entry.dpu_kernel;
+}
+
+xrt::hw_context
+setup_cache::
+hw_context(const std::string &fname, unsigned int slot)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return context(load(fname), slot);
+}
+
+xrt::kernel
+setup_cache::
+kernel(const std::string &fname, unsigned int slot, const std::string &name)
+{
+  auto kname = name.empty() ? dpu_kernel_name(fname) : name;
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto &entry = load(fname);
+  auto key = std::make_tuple(entry.uuid, slot, std::string(), kname);
+  auto it = m_kernels.find(key);
+  if (it != m_kernels.end()) {
+    m_stats.hits++;
+    return it->second;
+  }
+
+  auto hwctx = context(entry, slot);
+  auto k = miss("kernel", [&hwctx, &kname] { return xrt::kernel(hwctx, kname); });
+  m_kernels.emplace(key, k);
+  return k;
+}
+
+xrt::kernel
+setup_cache::
+elf_kernel(const std::string &fname, const std::string &elf, unsigned int slot, const std::string &name)
+{
+  auto kname = name.empty() ? dpu_kernel_name(fname) : name;
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto &entry = load(fname);
+  auto key = std::make_tuple(entry.uuid, slot, elf, kname);
+  auto it = m_kernels.find(key);
+  if (it != m_kernels.end()) {
+    m_stats.hits++;
+    return it->second;
+  }
+
+  auto hwctx = context(entry, slot);
+  auto mod = miss("ELF load", [&elf] { return xrt::module(xrt::elf(elf)); });
+  auto k = miss("kernel", [&hwctx, &mod, &kname] { return xrt::kernel(xrt::ext::kernel(hwctx, mod, kname)); });
+  m_kernels.emplace(key, k);
+  return k;
+}
+
+void
+setup_cache::
+release(const std::string &fname)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_xclbins.find(fname);
+  if (it == m_xclbins.end())
+    return;
+
+  // Kernels first, they hold on to their context
+  auto &uuid = it->second.uuid;
+  for (auto k = m_kernels.begin(); k != m_kernels.end();)
+    k = std::get<0>(k->first) == uuid ? m_kernels.erase(k) : std::next(k);
+  for (auto c = m_contexts.begin(); c != m_contexts.end();)
+    c = c->first.first == uuid ? m_contexts.erase(c) : std::next(c);
+}
+
+setup_cache_stats
+setup_cache::
+stats() const
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_stats;
+}
+
+void
+setup_cache::
+print_stats(std::ostream &os) const
+{
+  auto s = stats();
+  os << "Setup cache: " << s.misses << " misses, " << s.hits << " hits\n";
+}
+
+} // namespace vtd
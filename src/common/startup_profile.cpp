@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#include "startup_profile.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+double
+to_ms(int64_t ns)
+{
+  return ns / 1e6;
+}
+
+} // namespace
+
+namespace vtd {
+
+startup_profile::
+startup_profile()
+  : m_origin(std::chrono::steady_clock::now())
+{}
+
+void
+startup_profile::
+record(const std::string &name, std::chrono::steady_clock::time_point start,
+       std::chrono::steady_clock::time_point end)
+{
+  startup_phase phase;
+  phase.name = name;
+  phase.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_origin).count();
+  phase.end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_origin).count();
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_phases.push_back(std::move(phase));
+}
+
+std::vector<startup_phase>
+startup_profile::
+phases() const
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_phases;
+}
+
+std::chrono::nanoseconds
+startup_profile::
+elapsed() const
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  int64_t end = 0;
+  for (auto &p : m_phases)
+    end = std::max(end, p.end_ns);
+  return std::chrono::nanoseconds(end);
+}
+
+void
+startup_profile::
+print(std::ostream &os, const std::string &title) const
+{
+  struct phase_total
+  {
+    std::string name;
+    int count = 0;
+    int64_t total_ns = 0;
+    int64_t first_ns = 0;
+  };
+
+  // Phases that ran on several threads at once can add up to more than the
+  // startup, time in between phases is what none of them covers
+  auto all = phases();
+  std::vector<phase_total> totals;
+  std::vector<std::pair<int64_t, int64_t>> spans;
+  for (auto &p : all) {
+    auto t = std::find_if(totals.begin(), totals.end(), [&p](const phase_total &pt) { return pt.name == p.name; });
+    if (t == totals.end())
+      t = totals.insert(totals.end(), {p.name, 0, 0, p.start_ns});
+    t->count++;
+    t->total_ns += p.end_ns - p.start_ns;
+    spans.emplace_back(p.start_ns, p.end_ns);
+  }
+  std::sort(spans.begin(), spans.end());
+  int64_t covered = 0;
+  int64_t covered_end = 0;
+  for (auto &s : spans) {
+    auto begin = std::max(s.first, covered_end);
+    if (s.second > begin)
+      covered += s.second - begin;
+    covered_end = std::max(covered_end, s.second);
+  }
+
+  int64_t startup = elapsed().count();
+  auto share = [startup](int64_t ns) { return startup ? 100.0 * ns / startup : 0.0; };
+  auto flags = os.flags();
+  auto precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << title << ": " << to_ms(startup) << " ms\n";
+  os << "  " << std::left << std::setw(24) << "Phase" << std::right << std::setw(8) << "Count" << std::setw(12)
+     << "Total ms" << std::setw(9) << "Share" << std::setw(12) << "First at" << "\n";
+  for (auto &t : totals)
+    os << "  " << std::left << std::setw(24) << t.name << std::right << std::setw(8) << t.count << std::setw(12)
+       << to_ms(t.total_ns) << std::setw(8) << std::setprecision(1) << share(t.total_ns) << "%" << std::setw(12)
+       << std::setprecision(3) << to_ms(t.first_ns) << "\n";
+  os << "  " << std::left << std::setw(24) << "(unaccounted)" << std::right << std::setw(8) << "" << std::setw(12)
+     << to_ms(startup - covered) << std::setw(8) << std::setprecision(1) << share(startup - covered) << "%\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+} // namespace vtd
@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Measures what it costs to share the NPU between hw_contexts.  Every context
+ * loops back a small buffer with the given DPU sequence, one thread per
+ * context, and each sample runs three phases:
+ *
+ * - solo: a single context, the baseline.
+ * - spatial: --contexts contexts side by side on disjoint columns.  Ideally
+ *   every context keeps the solo rate, the extra time per command is the
+ *   spatial sharing overhead.
+ * - temporal: --contexts contexts on every partition of the device, so each
+ *   set of columns is oversubscribed and time shared.  Ideally the contexts of
+ *   a partition split the solo rate, the extra time per command is the
+ *   temporal sharing overhead (context switches).
+ *
+ * The partition width comes from the xclbin, --columns overrides it, and the
+ * device is taken to have --device-columns (default 8) columns.  XRT does not
+ * report where a context lands, so the printed placement is the expected one.
+ *
+ * Contexts are opened before each phase and warmed up outside the timed
+ * region, their buffers come from a vtd::bo_pool so later phases reuse them.
+ * The xclbin is loaded and registered once through a vtd::setup_cache, whose
+ * contexts are released after every phase, and the setup phases are profiled.
+ * Every other sample runs the phases in reverse order.
+ * Per phase the throughput loss against the solo baseline and the command
+ * latency percentiles are reported, and --results-json records the per
+ * sample overheads as spatial-sharing-overhead and temporal-sharing-overhead.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_kernel.h"
+
+#include "bo_pool.h"
+#include "device_control.h"
+#include "dpu_sequence.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "sample_stats.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
+#include "thread_barrier.h"
+
+constexpr unsigned long int host_app = 1;
+
+// One tenant of the NPU with its own context, kernel, buffers and run object
+struct sharing_context
+{
+  xrt::hw_context hwctx;
+  xrt::kernel dpu;
+  vtd::dpu_instr instr;
+  vtd::bo_lease in;
+  vtd::bo_lease out;
+  xrt::run run;
+  vtd::latency_histogram latency;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+  std::exception_ptr error;
+};
+
+// Timing of one phase over all of its contexts
+struct phase_result
+{
+  double elapsed_us;
+  vtd::latency_histogram latency;
+};
+
+struct sharing_setup
+{
+  xrt::device device;
+  std::string xclbin;
+  std::string dpu_sequence;
+  vtd::setup_cache *cache;
+  vtd::startup_profile *profile;
+  vtd::bo_pool *pool;
+  size_t bytes;
+  int iterations;
+  int warmup;
+};
+
+// Every context of a phase has a cache slot of its own
+void
+open_context(sharing_context &ctx, const sharing_setup &setup, int idx)
+{
+  ctx.hwctx = setup.cache->hw_context(setup.xclbin, idx);
+  ctx.dpu = setup.cache->kernel(setup.xclbin, idx);
+  ctx.instr = setup.profile->time("DPU sequence", [&] {
+    return vtd::load_dpu_sequence(setup.device, ctx.dpu, setup.dpu_sequence);
+  });
+  setup.profile->time("BO allocation", [&] {
+    ctx.in = setup.pool->acquire(setup.bytes, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(1));
+    ctx.out = setup.pool->acquire(setup.bytes, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(3));
+  });
+
+  // Every context loops back its own data so that mixed up outputs are caught
+  auto in_mapped = ctx.in.bo().map<uint8_t*>();
+  for (size_t i = 0; i < setup.bytes; i++)
+    in_mapped[i] = static_cast<uint8_t>(i * 7 + idx + 1);
+  ctx.in.bo().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  std::memset(ctx.out.bo().map<void*>(), 0, setup.bytes);
+  ctx.out.bo().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+  ctx.run = xrt::run(ctx.dpu);
+  ctx.run.set_arg(0, host_app);
+  ctx.run.set_arg(1, ctx.in.bo());
+  ctx.run.set_arg(2, NULL);
+  ctx.run.set_arg(3, ctx.out.bo());
+  ctx.run.set_arg(4, NULL);
+  ctx.run.set_arg(5, ctx.instr.bo);
+  ctx.run.set_arg(6, ctx.instr.size);
+  ctx.run.set_arg(7, NULL);
+}
+
+void
+run_context(sharing_context &ctx, vtd::thread_barrier &barrier, const sharing_setup &setup)
+{
+  try {
+    for (int i = 0; i < setup.warmup; i++) {
+      ctx.run.start();
+      ctx.run.wait2();
+    }
+
+    // All contexts start submitting together
+    barrier.arrive_and_wait();
+
+    ctx.start = std::chrono::steady_clock::now();
+    for (int i = 0; i < setup.iterations; i++) {
+      auto submitted = std::chrono::steady_clock::now();
+      ctx.run.start();
+      ctx.run.wait2();
+      ctx.latency.record(std::chrono::steady_clock::now() - submitted);
+    }
+    ctx.end = std::chrono::steady_clock::now();
+  } catch (...) {
+    ctx.error = std::current_exception();
+  }
+}
+
+// Open 'count' contexts, run them concurrently and check their outputs
+phase_result
+run_phase(const sharing_setup &setup, int count)
+{
+  std::vector<sharing_context> contexts(count);
+  for (int c = 0; c < count; c++)
+    open_context(contexts[c], setup, c);
+
+  vtd::thread_barrier barrier(count);
+  std::vector<std::thread> threads;
+  for (auto &ctx : contexts)
+    threads.emplace_back(run_context, std::ref(ctx), std::ref(barrier), std::cref(setup));
+
+  for (auto& th : threads)
+    th.join();
+
+  phase_result result {};
+  auto first_start = contexts[0].start;
+  auto last_end = contexts[0].end;
+  for (int c = 0; c < count; c++) {
+    auto &ctx = contexts[c];
+    if (ctx.error)
+      std::rethrow_exception(ctx.error);
+
+    ctx.out.bo().sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto in_mapped = ctx.in.bo().map<uint8_t*>();
+    auto out_mapped = ctx.out.bo().map<uint8_t*>();
+    if (std::memcmp(in_mapped, out_mapped, setup.bytes))
+      throw std::runtime_error("Error: Output data mismatch in context " + std::to_string(c) + "!\nTEST FAILED!\n");
+
+    first_start = std::min(first_start, ctx.start);
+    last_end = std::max(last_end, ctx.end);
+    result.latency.merge(ctx.latency);
+  }
+  result.elapsed_us = std::chrono::duration<double, std::micro>(last_end - first_start).count();
+
+  // The contexts close with 'contexts', the next phase opens its own
+  setup.cache->release(setup.xclbin);
+  return result;
+}
+
+void
+print_phase(const std::string &label, const std::vector<double> &elapsed_us, int commands,
+            const std::vector<double> &overhead_us, double solo_rate, double ideal,
+            const vtd::latency_histogram &latency)
+{
+  auto elapsed = vtd::summarize_samples(elapsed_us);
+  double rate = commands * 1e6 / elapsed.mean;
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << label << ": " << rate << " commands/s";
+  if (ideal > 0)
+    std::cout << ", " << (1 - rate / (ideal * solo_rate)) * 100 << "% below " << ideal << "x solo";
+  std::cout << std::endl;
+  if (!overhead_us.empty()) {
+    auto overhead = vtd::summarize_samples(overhead_us);
+    std::cout << "  Overhead per command (us): mean " << overhead.mean << " +/- " << overhead.ci95
+              << " (95% CI) min " << overhead.min << " max " << overhead.max << std::endl;
+  }
+  std::cout << std::defaultfloat;
+  latency.print(std::cout, "  Command latency");
+}
+
+void
+run(int argc, char **argv)
+{
+  vtd::startup_profile profile;
+  int contexts = 2;
+  int samples = 5;
+  int ctx_cols = 0, device_cols = 8;
+  std::string histogram_json;
+  std::string results_json;
+  sharing_setup setup {xrt::device(), "", "", nullptr, nullptr, nullptr, 4096, 1000, 10};
+  const std::string usage = "Usage: " + std::string(argv[0]) + " <XCLBIN File> <DPU Sequence File>"
+                            " [--contexts <n>] [--samples <n>] [--iterations <n>] [--warmup <n>] [--bytes <n>]"
+                            " [--columns <columns per context>] [--device-columns <n>] [--histogram-json <file>]"
+                            " [--results-json <file>]\n";
+
+  if (argc < 3)
+    throw std::runtime_error(usage);
+
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--contexts" && i + 1 < argc)
+      contexts = std::stoi(argv[++i]);
+    else if (arg == "--samples" && i + 1 < argc)
+      samples = std::stoi(argv[++i]);
+    else if (arg == "--iterations" && i + 1 < argc)
+      setup.iterations = std::stoi(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc)
+      setup.warmup = std::stoi(argv[++i]);
+    else if (arg == "--bytes" && i + 1 < argc)
+      setup.bytes = std::stoul(argv[++i]);
+    else if (arg == "--columns" && i + 1 < argc)
+      ctx_cols = std::stoi(argv[++i]);
+    else if (arg == "--device-columns" && i + 1 < argc)
+      device_cols = std::stoi(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else
+      throw std::runtime_error(usage);
+  }
+
+  if (contexts < 2 || samples < 1 || setup.iterations < 1 || setup.warmup < 0 || setup.bytes < 1 || ctx_cols < 0)
+    throw std::runtime_error(usage);
+
+  setup.device = profile.time("device open", [] { return xrt::device(0); });
+  vtd::setup_cache cache(setup.device, &profile);
+  setup.cache = &cache;
+  setup.profile = &profile;
+  setup.xclbin = argv[1];
+  setup.dpu_sequence = argv[2];
+  if (!ctx_cols)
+    ctx_cols = vtd::xclbin_partition_columns(cache.xclbin(setup.xclbin));
+
+  // Spatial sharing needs a partition per context
+  int partitions = device_cols / ctx_cols;
+  if (contexts > partitions)
+    throw std::runtime_error("Error: " + std::to_string(contexts) + " contexts of " + std::to_string(ctx_cols)
+                             + " columns do not fit side by side in " + std::to_string(device_cols)
+                             + " columns\n");
+
+  vtd::bo_pool pool(setup.device);
+  setup.pool = &pool;
+
+  int temporal_contexts = contexts * partitions;
+  std::cout << "Partition: " << ctx_cols << " columns of " << device_cols << ", expected placement:\n";
+  std::cout << "Solo: 1 context, columns 0-" << ctx_cols - 1 << "\n";
+  std::cout << "Spatial: " << contexts << " contexts, columns";
+  for (int c = 0; c < contexts; c++)
+    std::cout << (c ? ", " : " ") << c * ctx_cols << "-" << (c + 1) * ctx_cols - 1;
+  std::cout << "\n";
+  std::cout << "Temporal: " << temporal_contexts << " contexts, " << contexts << " on each of " << partitions
+            << " partitions\n";
+  std::cout << samples << " samples of " << setup.iterations << " runs per context" << std::endl;
+
+  // Every other sample runs the phases in reverse order, so drift of the
+  // device does not favor the phases that run first
+  std::vector<double> solo_us, spatial_us, temporal_us;
+  std::vector<double> spatial_overhead_us, temporal_overhead_us;
+  vtd::latency_histogram solo_latency, spatial_latency, temporal_latency;
+  for (int s = 0; s < samples; s++) {
+    std::vector<int> counts = {1, contexts, temporal_contexts};
+    if (s % 2)
+      std::reverse(counts.begin(), counts.end());
+    std::vector<phase_result> phases;
+    for (auto count : counts)
+      phases.push_back(run_phase(setup, count));
+    if (s % 2)
+      std::reverse(phases.begin(), phases.end());
+    auto &solo = phases[0];
+    auto &spatial = phases[1];
+    auto &temporal = phases[2];
+
+    solo_us.push_back(solo.elapsed_us);
+    spatial_us.push_back(spatial.elapsed_us);
+    temporal_us.push_back(temporal.elapsed_us);
+    solo_latency.merge(solo.latency);
+    spatial_latency.merge(spatial.latency);
+    temporal_latency.merge(temporal.latency);
+
+    // Side by side every context should finish in the solo time, time shared
+    // the contexts of a partition should take their sum
+    spatial_overhead_us.push_back((spatial.elapsed_us - solo.elapsed_us) / setup.iterations);
+    temporal_overhead_us.push_back((temporal.elapsed_us - contexts * solo.elapsed_us)
+                                   / (contexts * setup.iterations));
+  }
+
+  double solo_rate = setup.iterations * 1e6 / vtd::summarize_samples(solo_us).mean;
+  profile.print(std::cout, "Setup of all phases");
+  cache.print_stats(std::cout);
+  pool.print_stats(std::cout);
+  print_phase("Solo", solo_us, setup.iterations, {}, solo_rate, 0, solo_latency);
+  print_phase("Spatial sharing", spatial_us, contexts * setup.iterations, spatial_overhead_us, solo_rate, contexts,
+              spatial_latency);
+  print_phase("Temporal sharing", temporal_us, temporal_contexts * setup.iterations, temporal_overhead_us, solo_rate,
+              partitions, temporal_latency);
+
+  if (!histogram_json.empty()) {
+    vtd::write_histograms_json(histogram_json, {{"ctx_sharing solo", solo_latency},
+                                                {"ctx_sharing spatial", spatial_latency},
+                                                {"ctx_sharing temporal", temporal_latency}});
+  }
+  if (!results_json.empty()) {
+    vtd::result_set results;
+    results.app = "ctx_sharing";
+    for (auto sample : spatial_overhead_us)
+      results.add("spatial-sharing-overhead", "us", sample);
+    for (auto sample : temporal_overhead_us)
+      results.add("temporal-sharing-overhead", "us", sample);
+    vtd::set_result_device(results, setup.device);
+    vtd::write_results_json(results_json, results);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
@@ -8,11 +8,64 @@
  * restricted to just the Shim tile. No memtile DMA or memtile memory is
  * utilized.  While the BD addressing scheme is linear, the DPU sequence polls
  * for the BD completion. The data size for one test iteration is 1GB.
+ *
+ * With --contexts N the loopback runs from N hw_contexts at once, one thread
+ * per context, to show how the shim DMA bandwidth scales when several tenants
+ * share the NPU.  Per context and aggregate bandwidth are reported together
+ * with the columns each context is expected to occupy.
+ *
+ * With --queue-depth K each context keeps K runs in flight instead of the
+ * serialized start/wait loop, reaping completions in order.  A list of depths
+ * reports bandwidth and per command latency at every depth, which separates
+ * the DMA ceiling from the host submission overhead.  --ping-pong alternates
+ * the in-flight runs between two in/out buffer pairs.  Command latency
+ * percentiles are printed for every depth and --histogram-json dumps the raw
+ * histograms.
+ *
+ * Input data is a counter based pattern generated on all cores and outputs are
+ * checked with SIMD compares.  --verify regen checks the outputs against the
+ * pattern regenerated from --seed instead of against the input buffer.
+ *
+ * Buffers come from a vtd::bo_pool.  --bo-backing 2m|1g|thp backs them with
+ * huge pages instead of driver allocated memory and --prefault touches and
+ * syncs every page before the timed loop, the pool reports what that cost.
+ *
+ * --sweep 4K:1G[:4] repeats the measurement over a geometric range of transfer
+ * sizes on sub-buffers of one buffer pair.  Each size uses the sequence
+ * sequences/df_bw_4col_<size>.txt when there is one, otherwise the shim BD
+ * lengths of the 1GB sequence are patched.  The size -> bandwidth and latency
+ * table is followed by a fit of the time per command to a fixed overhead plus
+ * the transfer time at an asymptotic bandwidth, and the transfer size at which
+ * half of that bandwidth is reached.
+ *
+ * --stream <frame size> streams frames the way an inference pipeline does:
+ * every frame is generated and uploaded, looped back, read back and checked.
+ * The frames first run serially and then double buffered, where a helper
+ * thread reads back frame i-1 and uploads frame i+1 while frame i executes.
+ * Both passes report the end to end throughput and the share of the host
+ * staging time hidden behind command execution.
+ *
+ * The setup up to the first run is timed phase by phase, xclbin load and
+ * registration, hw_context and kernel creation, sequence load and data init,
+ * and printed as a startup breakdown.
+ *
+ * --cpus 2,4-5 pins the submission thread of context c to the c-th CPU of the
+ * list, wrapping around, and --numa-node <n>|local binds the huge page backed
+ * buffers to a node, local being the node of the first of those CPUs.  The
+ * clock read cost and OS jitter of the CPUs used are calibrated for
+ * --calibrate-ms before the runs (0 skips it) and every result carries the
+ * host noise floor that follows for its time per command.
  */
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -22,176 +75,702 @@
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_kernel.h"
 
-constexpr unsigned long int dpu_instr_str_len = 8;
+#include "async_stage.h"
+#include "bo_pool.h"
+#include "cmdline.h"
+#include "data_pattern.h"
+#include "dpu_sequence.h"
+#include "host_timing.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "run_pipeline.h"
+#include "sample_stats.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
+#include "thread_barrier.h"
+
 constexpr unsigned long int host_app = 1;
 constexpr unsigned long int tnx_len_gb = 1;
 constexpr unsigned long int tnx_len = tnx_len_gb * 1024 * 1024 * 1024;
 constexpr unsigned long int tnx_word_count = tnx_len / 4;
+// Bandwidths are reported in units of tnx_len / tnx_len_gb bytes
+constexpr double bytes_per_gb = static_cast<double>(tnx_len) / tnx_len_gb;
 
 std::string dpu_instr("sequences/df_bw_4col.txt");
 
-/* Copy values from text file into buff, expecting values are ASCII encoded
- * 4-Byte hexadecimal values.
+// One tenant of the NPU.  Every context owns its hw_context, kernel, instruction
+// and output buffers while all contexts loop back the same input buffer.
+// With ping-pong buffering, in-flight runs alternate between two in/out pairs.
+struct df_context
+{
+  xrt::hw_context hwctx;
+  xrt::kernel dpu;
+  vtd::dpu_instr instr;
+  vtd::dpu_instr sized_instr;                 // Sequence of the swept size
+  std::array<vtd::bo_lease, 2> out;
+  std::array<vtd::bo_lease, 2> frame_in;      // Double buffered stream frames
+  std::array<vtd::bo_lease, 2> frame_out;
+  std::chrono::nanoseconds exec {};           // Stream command execution
+  std::chrono::nanoseconds staging {};        // Stream upload and readback
+  std::vector<xrt::run> runs;
+  std::string columns;
+  vtd::latency_histogram latency;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+  int cpu = -1;                               // Unpinned
+  std::exception_ptr error;
+};
+
+/* Columns the driver is expected to assign to context 'idx'.  Contexts are
+ * packed first fit from column 0, once the device is full further contexts
+ * time share the existing partitions round robin.
  */
+std::string
+column_mapping(int idx, int ctx_cols, int device_cols)
+{
+  int slots = device_cols / ctx_cols;
+  if (slots == 0)
+    return "unknown";
+
+  int start_col = (idx % slots) * ctx_cols;
+  std::string mapping = std::to_string(start_col) + "-" + std::to_string(start_col + ctx_cols - 1);
+  if (idx >= slots)
+    mapping += " (time shared)";
+  return mapping;
+}
+
 void
-init_instr_buf(xrt::bo &bo_instr)
+run_test_iterations(df_context &ctx, vtd::thread_barrier &barrier, int it_max)
 {
-  auto instr = bo_instr.map<int*>();
-  std::string line;
-  std::ifstream ifs(dpu_instr);
+  try {
+    if (ctx.cpu >= 0)
+      vtd::pin_thread(ctx.cpu);
+
+    // All contexts start submitting together
+    barrier.arrive_and_wait();
+
+    // All iterations in the same thread share the same hw context, the number
+    // of runs is the number of commands kept in flight
+    ctx.start = std::chrono::steady_clock::now();
+    vtd::run_pipelined(ctx.runs, it_max, [&ctx](auto latency) { ctx.latency.record(latency); });
+    ctx.end = std::chrono::steady_clock::now();
+  } catch (...) {
+    ctx.error = std::current_exception();
+  }
+}
 
-  if (!ifs.is_open())
-    throw std::runtime_error("Error: Failure opening file " + dpu_instr + " for reading!!\n");
+/* Stream 'frames' frames through the context, frame f is the pattern for
+ * seed + f.  Serially every frame is uploaded, executed and read back in
+ * turn.  Overlapped, the helper stage reads back frame f - 1 and uploads
+ * frame f + 1 in the other buffer pair while frame f executes.
+ */
+void
+run_stream(df_context &ctx, vtd::thread_barrier &barrier, int frames, uint64_t seed, bool overlap)
+{
+  try {
+    size_t words = ctx.frame_in[0].bo().size() / sizeof(uint32_t);
+    auto upload = [&](int f) {
+      auto &in = ctx.frame_in[f % 2].bo();
+      vtd::fill_pattern(in.map<uint32_t*>(), words, seed + f);
+      in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    };
+    auto readback = [&](int f) {
+      auto &out = ctx.frame_out[f % 2].bo();
+      out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+      if (vtd::verify_pattern(out.map<const uint32_t*>(), words, seed + f) != vtd::pattern_match)
+        throw std::runtime_error("Error: Output data mismatch in frame " + std::to_string(f) + "\nTEST FAILED!\n");
+    };
+    auto execute = [&](int f) {
+      auto submit = std::chrono::steady_clock::now();
+      ctx.runs[f % 2].start();
+      ctx.runs[f % 2].wait2();
+      auto elapsed = std::chrono::steady_clock::now() - submit;
+      ctx.exec += elapsed;
+      ctx.latency.record(elapsed);
+    };
+    auto staged = [&](auto &&func) {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      ctx.staging += std::chrono::steady_clock::now() - start;
+    };
+
+    // The helper thread is up before the timed region.  It is started before
+    // the submission thread is pinned, so it does not compete for that CPU.
+    vtd::async_stage stage;
+    if (ctx.cpu >= 0)
+      vtd::pin_thread(ctx.cpu);
+    barrier.arrive_and_wait();
+
+    ctx.start = std::chrono::steady_clock::now();
+    if (!overlap) {
+      for (int f = 0; f < frames; f++) {
+        staged([&] { upload(f); });
+        execute(f);
+        staged([&] { readback(f); });
+      }
+    }
+    else {
+      staged([&] { upload(0); });
+      for (int f = 0; f < frames; f++) {
+        ctx.runs[f % 2].start();
+        stage.post([&, f] {
+          if (f > 0)
+            readback(f - 1);
+          if (f + 1 < frames)
+            upload(f + 1);
+        });
+        // The submit to completion time excludes the post
+        auto submit = std::chrono::steady_clock::now();
+        ctx.runs[f % 2].wait2();
+        auto elapsed = std::chrono::steady_clock::now() - submit;
+        ctx.exec += elapsed;
+        ctx.latency.record(elapsed);
+        stage.wait();
+      }
+      staged([&] { readback(frames - 1); });
+      ctx.staging += stage.busy();
+    }
+    ctx.end = std::chrono::steady_clock::now();
+  } catch (...) {
+    ctx.error = std::current_exception();
+  }
+}
 
-  // Copy 4-Byte hex values to the instruction buffer, ignoring comments
-  while (getline(ifs, line)) {
-    if (line.at(0) == '#')
-      continue;
+// End to end throughput of one stream pass
+struct stream_result
+{
+  double bw = 0;                              // Aggregate GB/s
+  double overlap_pct = 0;
+  double frame_us = 0;                        // Wall time per frame
+};
 
-    std::stringstream ss(line);
-    unsigned int word = 0;
+/* Host staging that is not hidden shows up as wall time on top of the
+ * command execution, everything else of the staging time overlapped.
+ */
+stream_result
+report_stream(const std::vector<df_context> &contexts, int frames, size_t bytes, const std::string &mode,
+              const std::string &name, std::vector<std::pair<std::string, vtd::latency_histogram>> &histograms)
+{
+  auto first_start = contexts[0].start;
+  auto last_end = contexts[0].end;
+  double exec_us = 0, staging_us = 0, hidden_us = 0;
+  vtd::latency_histogram latency;
+  for (auto &ctx : contexts) {
+    first_start = std::min(first_start, ctx.start);
+    last_end = std::max(last_end, ctx.end);
+    double wall = std::chrono::duration<double, std::micro>(ctx.end - ctx.start).count();
+    double exec = std::chrono::duration<double, std::micro>(ctx.exec).count();
+    double staging = std::chrono::duration<double, std::micro>(ctx.staging).count();
+    exec_us += exec;
+    staging_us += staging;
+    hidden_us += std::max(0.0, staging - std::max(0.0, wall - exec));
+    latency.merge(ctx.latency);
+  }
 
-    ss.seekp(0, std::ios::end);
-    if (ss.tellp() != dpu_instr_str_len)
-      throw std::runtime_error("Error: Invalid DPU instruction size\n");
+  double total = static_cast<double>(frames) * contexts.size();
+  double wall_us = std::chrono::duration<double, std::micro>(last_end - first_start).count();
+  stream_result result;
+  result.bw = bytes / bytes_per_gb * total * 2 * 1e6 / wall_us;
+  result.overlap_pct = staging_us > 0 ? std::min(100.0, hidden_us / staging_us * 100) : 0;
+  result.frame_us = wall_us / frames;
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Stream " << mode << ": " << result.frame_us << " us per frame, " << total * 1e6 / wall_us
+            << " frames/s, " << result.bw << " GB/s end to end\n"
+            << "  Per frame " << exec_us / total << " us execution, " << staging_us / total
+            << " us host staging, " << result.overlap_pct << "% of the staging overlapped\n";
+  std::cout << std::defaultfloat;
+  latency.print(std::cout, "  Command latency");
+  histograms.emplace_back(name, latency);
+  return result;
+}
 
-    ss >> std::hex >> word;
-    *(instr++) = word;
+// Measurement of one transfer size at one depth
+struct df_point
+{
+  size_t bytes = 0;
+  int depth = 0;
+  double elapsed_us = 0;
+  double bw = 0;                              // Aggregate GB/s
+  double p50_us = 0;
+  double p99_us = 0;
+  double noise_pct = 0;                       // Host noise floor
+};
+
+// Print the bandwidth and latency of one depth
+df_point
+report(const std::vector<df_context> &contexts, int it_max, size_t bytes, int depth, bool show_depth,
+       const std::string &name, std::vector<std::pair<std::string, vtd::latency_histogram>> &histograms)
+{
+  // 'bytes' are read and written in parallel by every iteration
+  double gb = bytes / bytes_per_gb;
+  if (show_depth)
+    std::cout << "Queue depth: " << depth << "\n";
+
+  auto first_start = contexts[0].start;
+  auto last_end = contexts[0].end;
+  vtd::latency_histogram latency;
+  for (size_t c = 0; c < contexts.size(); c++) {
+    auto &ctx = contexts[c];
+    first_start = std::min(first_start, ctx.start);
+    last_end = std::max(last_end, ctx.end);
+    latency.merge(ctx.latency);
+
+    if (contexts.size() == 1)
+      break;
+
+    double elapsedSecs = std::chrono::duration_cast<std::chrono::microseconds>(ctx.end - ctx.start).count();
+    double bw = (gb * it_max * 2 * 1e6) / (elapsedSecs);
+    std::cout << "Context " << c << " (columns " << ctx.columns << "): " << elapsedSecs << " us, " << bw
+              << " GB/s, command latency p50 " << ctx.latency.percentile_us(0.5) << " us p99 "
+              << ctx.latency.percentile_us(0.99) << " us\n";
+    histograms.emplace_back(name + " context " + std::to_string(c), ctx.latency);
   }
+
+  double elapsedSecs = std::chrono::duration_cast<std::chrono::microseconds>(last_end - first_start).count();
+  double bw = (gb * it_max * 2 * 1e6 * contexts.size()) / (elapsedSecs);
+  std::cout << "Time taken: " << elapsedSecs << " us\n";
+  std::cout << (contexts.size() == 1 ? "AIE DF bandwidth: " : "Aggregate AIE DF bandwidth: ") << bw << " GB/s\n";
+  latency.print(std::cout, "Command latency");
+  histograms.emplace_back(name, latency);
+  return {bytes, depth, elapsedSecs, bw, latency.percentile_us(0.5), latency.percentile_us(0.99)};
 }
 
-size_t
-get_instr_size(std::string &fname)
+/* Instruction BO for loopback transfers of 'bytes' per direction: the
+ * sequence file made for that size when there is one, else a copy of the
+ * context's sequence with the BD lengths of the full transfer patched.
+ */
+vtd::dpu_instr
+sized_sequence(const xrt::device &device, df_context &ctx, size_t bytes)
 {
-  std::string line;
-  size_t size = 0;
-
-  std::ifstream file(fname);
-  if (!file.is_open())
-    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
+  auto dot = dpu_instr.rfind('.');
+  auto fname = dpu_instr.substr(0, dot) + "_" + vtd::format_size(bytes) + dpu_instr.substr(dot);
+  if (std::ifstream(fname).good())
+    return vtd::load_dpu_sequence(device, ctx.dpu, fname);
+
+  vtd::dpu_instr instr;
+  instr.size = ctx.instr.size;
+  instr.bo = xrt::bo(device, instr.size * sizeof(uint32_t), XCL_BO_FLAGS_CACHEABLE, ctx.dpu.group_id(5));
+  auto words = instr.bo.map<uint32_t*>();
+  std::memcpy(words, ctx.instr.bo.map<const uint32_t*>(), instr.size * sizeof(uint32_t));
+  if (!vtd::patch_dpu_sequence_bd_lengths(words, instr.size, tnx_word_count, bytes / 4))
+    throw std::runtime_error("Error: " + dpu_instr + " has no BD moving " + std::to_string(tnx_len) +
+                             " bytes to patch, provide " + fname + "\n");
+  instr.bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  return instr;
+}
 
-  // DPU sequence text file is list of 32-bit hex values separated by newline
-  // Comments within the file are identified by a '#' prefix
-  while (getline(file, line)) {
-    if (line.at(0) != '#')
-      size++;
+// Fixed per command overhead and asymptotic aggregate bandwidth of a sweep
+struct df_fit
+{
+  bool valid = false;
+  double overhead_us = 0;
+  double bw = 0;
+};
+
+// Size -> bandwidth and latency table of one depth followed by the fit
+df_fit
+report_sweep(const std::vector<df_point> &points, int depth, size_t contexts, int it_max)
+{
+  // Time per command against the bytes every command moves in both directions
+  std::vector<double> x, y, w;
+  std::cout << "Transfer size sweep, queue depth " << depth << ":\n"
+            << "      Size   Time/cmd (us)      GB/s   p50 (us)   p99 (us)\n";
+  for (auto &p : points) {
+    if (p.depth != depth)
+      continue;
+    double us = p.elapsed_us / it_max;
+    std::cout << std::setw(10) << vtd::format_size(p.bytes) << std::fixed << std::setprecision(3) << std::setw(16)
+              << us << std::setw(10) << p.bw << std::setw(11) << p.p50_us << std::setw(11) << p.p99_us << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+    x.push_back(2.0 * p.bytes * contexts);
+    y.push_back(us);
+    w.push_back(1 / (us * us));
   }
 
-  if (size == 0)
-    throw std::runtime_error("Error: Invalid DPU instruction length");
+  auto fit = vtd::fit_line(x, y, w);
+  if (x.size() < 2 || fit.slope <= 0) {
+    std::cout << "Too few sizes to fit overhead and bandwidth\n";
+    return {};
+  }
 
-  return size;
+  // The half bandwidth size is the one whose transfer time equals the overhead
+  double bw = 1e6 / (fit.slope * bytes_per_gb);
+  double half = fit.intercept > 0 ? fit.intercept / fit.slope / (2.0 * contexts) : 0;
+  std::cout << "Fitted fixed overhead: " << fit.intercept << " us per command, asymptotic bandwidth: " << bw
+            << " GB/s, half bandwidth at " << static_cast<size_t>(half) << " bytes (r^2 " << fit.r2 << ")\n";
+  return {true, fit.intercept, bw};
 }
 
+// Create 'depth' runs for the context moving 'bytes', run k uses buffer pair
+// k % 2 when ping-pong buffering is enabled.  Smaller transfers use
+// sub-buffers at the start of the buffers.
 void
-run_test_iterations(const std::string &xclbinFileName, xrt::device &device, int tid, int it_max)
+create_runs(df_context &ctx, const std::array<vtd::bo_lease, 2> &in, const std::array<vtd::bo_lease, 2> &out,
+            size_t bytes, int depth, bool ping_pong)
 {
-  auto xclbin = xrt::xclbin(xclbinFileName);
-
-  // Determine The DPU Kernel Name
-  auto xkernels = xclbin.get_kernels();
-  auto xkernel = *std::find_if(xkernels.begin(), xkernels.end(), [](xrt::xclbin::kernel& k) {
-    auto name = k.get_name();
-    // Starts with "DPU"
-    return name.rfind("DPU", 0) == 0;
-  });
-
-  if (!xkernel)
-    throw std::runtime_error("Error: Failure to find DPU kernel in the XCLBIN!\n");
-
-  auto kernelName = xkernel.get_name();
-
-  device.register_xclbin(xclbin);
-  xrt::hw_context context(device, xclbin.get_uuid());
+  std::array<xrt::bo, 2> in_sized = {in[0].bo(), in[1].bo()};
+  std::array<xrt::bo, 2> out_sized = {out[0].bo(), out[1].bo()};
+  for (int p = 0; p < 2; p++) {
+    if (in[p] && bytes < in[p].bo().size()) {
+      in_sized[p] = xrt::bo(in[p].bo(), bytes, 0);
+      out_sized[p] = xrt::bo(out[p].bo(), bytes, 0);
+    }
+  }
 
-  auto dpu = xrt::kernel(context, kernelName);
+  ctx.runs.clear();
+  for (int k = 0; k < depth; k++) {
+    int pair = ping_pong ? k % 2 : 0;
+    auto run = xrt::run(ctx.dpu);
+    run.set_arg(0, host_app);
+    run.set_arg(1, in_sized[pair]);
+    run.set_arg(2, NULL);
+    run.set_arg(3, out_sized[pair]);
+    run.set_arg(4, NULL);
+    run.set_arg(5, ctx.sized_instr.bo);
+    run.set_arg(6, ctx.sized_instr.size);
+    run.set_arg(7, NULL);
+    ctx.runs.push_back(std::move(run));
+  }
+}
 
-  size_t instr_size = get_instr_size(dpu_instr);
+// Serial and overlapped stream passes of 'frames' frames per context
+void
+stream_frames(const xrt::device &device, vtd::bo_pool &pool, std::vector<df_context> &contexts, size_t frame_len,
+              int frames, uint64_t seed, const vtd::host_calibration &calibration, vtd::result_set &results,
+              std::vector<std::pair<std::string, vtd::latency_histogram>> &histograms)
+{
+  std::cout << "Stream frame size: " << vtd::format_size(frame_len) << "\n";
+  for (auto &ctx : contexts) {
+    for (int p = 0; p < 2; p++) {
+      ctx.frame_in[p] = pool.acquire(frame_len, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(1));
+      ctx.frame_out[p] = pool.acquire(frame_len, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(3));
+    }
+    ctx.sized_instr = frame_len == tnx_len ? ctx.instr : sized_sequence(device, ctx, frame_len);
+    create_runs(ctx, ctx.frame_in, ctx.frame_out, frame_len, 2, true);
+  }
 
-  auto instr = xrt::bo(device, instr_size * sizeof(int), XCL_BO_FLAGS_CACHEABLE, dpu.group_id(5));
-  auto in = xrt::bo(device, tnx_len, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(1));
-  auto out = xrt::bo(device, tnx_len, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(3));
+  std::array<stream_result, 2> passes;
+  for (int overlap = 0; overlap < 2; overlap++) {
+    for (auto &ctx : contexts) {
+      ctx.latency.reset();
+      ctx.exec = ctx.staging = {};
+    }
+
+    vtd::thread_barrier barrier(contexts.size());
+    std::vector<std::thread> threads;
+    for (auto &ctx : contexts)
+      threads.emplace_back(run_stream, std::ref(ctx), std::ref(barrier), frames, seed, overlap);
+    for (auto& th : threads)
+      th.join();
+    for (auto &ctx : contexts) {
+      if (ctx.error)
+        std::rethrow_exception(ctx.error);
+    }
+
+    std::string mode = overlap ? "overlapped" : "serial";
+    passes[overlap] = report_stream(contexts, frames, frame_len, mode, "df_bw stream " + mode, histograms);
+  }
+  std::cout << "Stream speedup from overlap: " << passes[0].frame_us / passes[1].frame_us << "x\n";
+
+  results.add("df-bw-stream-serial", "GB/s", passes[0].bw, calibration.noise_pct(passes[0].frame_us));
+  results.add("df-bw-stream", "GB/s", passes[1].bw, calibration.noise_pct(passes[1].frame_us));
+  results.add("df-bw-stream-overlap", "%", passes[1].overlap_pct, calibration.noise_pct(passes[1].frame_us));
+
+  // The frame buffers go back to the pool
+  for (auto &ctx : contexts) {
+    ctx.runs.clear();
+    for (int p = 0; p < 2; p++) {
+      ctx.frame_in[p].release();
+      ctx.frame_out[p].release();
+    }
+  }
+}
 
-  init_instr_buf(instr);
+// Geometric range of transfer sizes "<min>:<max>[:<factor>]", factor 4 by
+// default, e.g. 4K:1G
+std::vector<size_t>
+parse_sweep(const std::string &arg)
+{
+  auto first = arg.find(':');
+  auto second = arg.find(':', first == std::string::npos ? first : first + 1);
+  if (first == std::string::npos)
+    throw std::runtime_error("Error: Invalid sweep '" + arg + "', expected <min>:<max>[:<factor>]\n");
+
+  size_t min = vtd::parse_size(arg.substr(0, first));
+  size_t max = vtd::parse_size(arg.substr(first + 1, second == std::string::npos ? second : second - first - 1));
+  size_t factor = second == std::string::npos ? 4 : std::stoul(arg.substr(second + 1));
+  if (min % 4 || max % 4 || min > max || factor < 2)
+    throw std::runtime_error("Error: Invalid sweep '" + arg + "', sizes must be multiples of 4 and factor 2 or more\n");
+
+  std::vector<size_t> sizes;
+  for (size_t bytes = min; bytes <= max; bytes *= factor)
+    sizes.push_back(bytes);
+  if (sizes.back() != max)
+    sizes.push_back(max);
+  return sizes;
+}
 
-  instr.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+void
+usage(const std::string &app)
+{
+  throw std::runtime_error("Usage: " + app + " <XCLBIN File> [iterations] [--contexts <n>]"
+                           " [--columns <columns per context>] [--device-columns <n>]"
+                           " [--queue-depth <k>[,<k>...]] [--ping-pong] [--histogram-json <file>]"
+                           " [--seed <n>] [--verify compare|regen] [--results-json <file>]"
+                           " [--bo-backing driver|thp|2m|1g] [--prefault] [--sweep <min>:<max>[:<factor>]]"
+                           " [--stream <frame size>] [--cpus <list>] [--numa-node <n>|local] [--calibrate-ms <ms>]");
+}
 
-  std::cout << "Transaction word count: 0x" << std::hex << tnx_word_count << "\n";
-  auto in_mapped = in.map<int*>();
-  auto out_mapped = out.map<int*>();
-  for (unsigned long int i = 0; i < tnx_word_count; i++) {
-    in_mapped[i] = rand() % 8192;
-    out_mapped[i] = 0;
+void
+run(int argc, char **argv)
+{
+  vtd::startup_profile profile;
+  int num_thread = 1, it_max = 600;
+  int ctx_cols = 4, device_cols = 8;
+  std::vector<int> depths = {1};
+  bool ping_pong = false;
+  std::string histogram_json;
+  std::string results_json;
+  uint64_t seed = 1;
+  bool regenerate = false;
+  auto backing = vtd::bo_backing::driver;
+  bool prefault = false;
+  std::vector<size_t> sizes = {tnx_len};
+  size_t frame_len = 0;
+  std::vector<int> cpus;
+  std::string numa_node;
+  int calibrate_ms = 100;
+
+  // Set the number of threads/contexts and iterations
+  // Default: 1 thread, 600 iterations
+  if (argc < 2)
+    usage(argv[0]);
+
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i == 2 && std::isdigit(static_cast<unsigned char>(arg[0])))
+      it_max = std::stoi(arg);
+    else if (arg == "--contexts" && i + 1 < argc)
+      num_thread = std::stoi(argv[++i]);
+    else if (arg == "--columns" && i + 1 < argc)
+      ctx_cols = std::stoi(argv[++i]);
+    else if (arg == "--device-columns" && i + 1 < argc)
+      device_cols = std::stoi(argv[++i]);
+    else if (arg == "--queue-depth" && i + 1 < argc)
+      depths = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--ping-pong")
+      ping_pong = true;
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else if (arg == "--seed" && i + 1 < argc)
+      seed = std::stoull(argv[++i]);
+    else if (arg == "--verify" && i + 1 < argc && (argv[i + 1] == std::string("compare") || argv[i + 1] == std::string("regen")))
+      regenerate = std::string(argv[++i]) == "regen";
+    else if (arg == "--bo-backing" && i + 1 < argc)
+      backing = vtd::parse_bo_backing(argv[++i]);
+    else if (arg == "--prefault")
+      prefault = true;
+    else if (arg == "--sweep" && i + 1 < argc)
+      sizes = parse_sweep(argv[++i]);
+    else if (arg == "--stream" && i + 1 < argc)
+      frame_len = vtd::parse_size(argv[++i]);
+    else if (arg == "--cpus" && i + 1 < argc)
+      cpus = vtd::parse_cpu_list(argv[++i]);
+    else if (arg == "--numa-node" && i + 1 < argc)
+      numa_node = argv[++i];
+    else if (arg == "--calibrate-ms" && i + 1 < argc)
+      calibrate_ms = std::stoi(argv[++i]);
+    else
+      usage(argv[0]);
   }
-  in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-  out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
 
-  std::cout << "Iteration count: " << std::dec << it_max << "\n" ;
-
-  auto run = xrt::run(dpu);
-  run.set_arg(0, host_app);
-  run.set_arg(1, in);
-  run.set_arg(2, NULL);
-  run.set_arg(3, out);
-  run.set_arg(4, NULL);
-  run.set_arg(5, instr);
-  run.set_arg(6, instr_size);
-  run.set_arg(7, NULL);
+  if (num_thread < 1 || it_max < 1 || ctx_cols < 1 || frame_len % 4 || calibrate_ms < 0)
+    usage(argv[0]);
+  if (std::any_of(depths.begin(), depths.end(), [](int depth) { return depth < 1; }))
+    throw std::runtime_error("Error: Queue depths must be positive\n");
+  // Run k uses pair k % 2, at depth 1 the second pair would never be written
+  if (ping_pong && *std::max_element(depths.begin(), depths.end()) < 2)
+    throw std::runtime_error("Error: --ping-pong needs a queue depth of 2 or more\n");
+
+  // The local node is that of the first submission CPU, or of this thread
+  int node = -1;
+  if (numa_node == "local") {
+    int cpu = cpus.empty() ? vtd::current_cpu() : cpus[0];
+    node = cpu < 0 ? -1 : vtd::cpu_numa_node(cpu);
+    if (node < 0)
+      throw std::runtime_error("Error: NUMA node of CPU " + std::to_string(cpu) + " is unknown\n");
+  }
+  else if (!numa_node.empty())
+    node = std::stoi(numa_node);
 
-  // All iterations in the same thread share the same hw context
-  auto start = std::chrono::high_resolution_clock::now();
-  for (int i = 0; i < it_max; i++) {
-    run.start();
-    run.wait2();
+  std::string xclbinFileName = argv[1];
+  auto device = profile.time("device open", [] { return xrt::device(0); });
+
+  // The xclbin is registered once and shared by all contexts, each context
+  // has a cache slot of its own
+  vtd::setup_cache cache(device, &profile);
+
+  // The pool outlives every BO it hands out
+  vtd::bo_pool pool(device, backing, prefault, node);
+  std::vector<df_context> contexts(num_thread);
+  for (int i = 0; i < num_thread; i++) {
+    auto &ctx = contexts[i];
+    ctx.cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+    ctx.hwctx = cache.hw_context(xclbinFileName, i);
+    ctx.dpu = cache.kernel(xclbinFileName, i);
+    ctx.instr = profile.time("DPU sequence", [&] { return vtd::load_dpu_sequence(device, ctx.dpu, dpu_instr); });
+    ctx.columns = column_mapping(i, ctx_cols, device_cols);
   }
-  auto end = std::chrono::high_resolution_clock::now();
 
-  std::cout << "Data transfer complete. Checking results...\n";
+  // The input buffers are shared by all contexts, the second pair is only
+  // needed for ping-pong buffering.  They hold the largest transfer.
+  int pairs = ping_pong ? 2 : 1;
+  std::array<vtd::bo_lease, 2> in;
+  size_t buf_len = sizes.back();
+  size_t buf_word_count = buf_len / 4;
+
+  // Buffers are filled and cleared on all cores, every word of the input is a
+  // function of the seed and its index
+  auto init_start = std::chrono::steady_clock::now();
+  std::cout << "Transaction word count: 0x" << std::hex << buf_word_count << "\n";
+  for (int p = 0; p < pairs; p++) {
+    in[p] = pool.acquire(buf_len, XRT_BO_FLAGS_HOST_ONLY, contexts[0].dpu.group_id(1));
+    vtd::fill_pattern(in[p].bo().map<uint32_t*>(), buf_word_count, seed);
+    in[p].bo().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  }
 
-  out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+  for (auto &ctx : contexts) {
+    for (int p = 0; p < pairs; p++) {
+      ctx.out[p] = pool.acquire(buf_len, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(3));
+      auto out_mapped = ctx.out[p].bo().map<char*>();
+      vtd::parallel_chunks(buf_len, 0, [out_mapped](size_t begin, size_t end) {
+        std::memset(out_mapped + begin, 0, end - begin);
+      });
+      ctx.out[p].bo().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    }
+  }
+  auto init_end = std::chrono::steady_clock::now();
+  profile.record("data init", init_start, init_end);
+  std::cout << "Data init time: " << std::dec
+            << std::chrono::duration_cast<std::chrono::milliseconds>(init_end - init_start).count() << " ms ("
+            << vtd::pattern_isa() << ")\n";
+  pool.print_stats(std::cout);
+  profile.print(std::cout);
+
+  // Calibrate on the CPUs the submission threads are pinned to, or unpinned
+  vtd::host_calibration calibration;
+  if (calibrate_ms) {
+    std::vector<int> used;
+    for (auto &ctx : contexts) {
+      if (ctx.cpu >= 0 && std::find(used.begin(), used.end(), ctx.cpu) == used.end())
+        used.push_back(ctx.cpu);
+    }
+    calibration = vtd::calibrate_host(used, std::chrono::milliseconds(calibrate_ms));
+    calibration.print(std::cout);
+  }
 
-  for (unsigned long int i = 0; i < tnx_word_count; i++) {
-    if (out_mapped[i] == in_mapped[i])
-      continue;
+  std::cout << "Iteration count: " << std::dec << it_max << "\n";
+  std::cout << "Context count: " << num_thread << "\n";
+
+  std::vector<std::pair<std::string, vtd::latency_histogram>> histograms;
+  vtd::result_set results;
+  results.app = "df_bw";
+  bool sweep = sizes.size() > 1 || sizes[0] != tnx_len;
+  std::vector<df_point> points;
+  // Sizes ascend, so the last transfer rewrites the whole output for the check
+  for (auto bytes : sizes) {
+    for (auto &ctx : contexts)
+      ctx.sized_instr = bytes == tnx_len ? ctx.instr : sized_sequence(device, ctx, bytes);
+    if (sweep)
+      std::cout << "Transfer size: " << vtd::format_size(bytes) << "\n";
+
+    for (auto depth : depths) {
+      for (auto &ctx : contexts) {
+        create_runs(ctx, in, ctx.out, bytes, depth, ping_pong);
+        ctx.latency.reset();
+      }
+
+      vtd::thread_barrier barrier(num_thread);
+      std::vector<std::thread> threads;
+      for (auto &ctx : contexts)
+        threads.emplace_back(run_test_iterations, std::ref(ctx), std::ref(barrier), it_max);
+
+      for (auto& th : threads)
+        th.join();
+
+      for (auto &ctx : contexts) {
+        if (ctx.error)
+          std::rethrow_exception(ctx.error);
+      }
+
+      // The full size keeps the benchmark test name, other sizes add theirs
+      std::string size_name = bytes == tnx_len ? "" : "-" + vtd::format_size(bytes);
+      std::string depth_name = depths.size() == 1 ? "" : "-qd" + std::to_string(depth);
+      auto name = "df_bw " + (sweep ? vtd::format_size(bytes) + " " : "") + "depth " + std::to_string(depth);
+      points.push_back(report(contexts, it_max, bytes, depth, depths.size() > 1 || depth > 1, name, histograms));
+      auto &point = points.back();
+      point.noise_pct = calibration.noise_pct(point.elapsed_us / it_max);
+      if (calibrate_ms)
+        std::cout << "Host noise floor: " << std::fixed << std::setprecision(3) << point.noise_pct << "%\n"
+                  << std::defaultfloat;
+      results.add("df-bw" + size_name + depth_name, "GB/s", point.bw, point.noise_pct);
+    }
+  }
 
-    std::cout << "In[" << i << "]: " << in_mapped[i] << " | Out[" << i << "]: " << out_mapped[i] << "\n";
-    throw std::runtime_error("Error: Output data mismatch!\nTEST FAILED!\n");
+  if (sweep) {
+    for (auto depth : depths) {
+      auto fit = report_sweep(points, depth, contexts.size(), it_max);
+      if (!fit.valid)
+        continue;
+      // The overhead is as exposed to the clock reads as a command of that
+      // length, the asymptotic bandwidth as the largest transfer
+      std::string depth_name = depths.size() == 1 ? "" : "-qd" + std::to_string(depth);
+      auto largest = std::find_if(points.rbegin(), points.rend(), [depth](auto &p) { return p.depth == depth; });
+      results.add("df-bw-overhead" + depth_name, "us", fit.overhead_us, calibration.noise_pct(fit.overhead_us));
+      results.add("df-bw-asymptotic" + depth_name, "GB/s", fit.bw, largest->noise_pct);
+    }
   }
 
-  double elapsedSecs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-  // tnx_len_gb data is read and written in parallel
-  double bw = (tnx_len_gb * it_max * 2 * 1e6) / (elapsedSecs);
+  if (frame_len)
+    stream_frames(device, pool, contexts, frame_len, it_max, seed, calibration, results, histograms);
 
-  std::cout << "Time taken: " << elapsedSecs << " us\n";
-  std::cout << "AIE DF bandwidth: " << bw << " GB/s\n";
-}
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, histograms);
 
-void
-run(int argc, char **argv)
-{
-  int num_thread, it_max;
+  std::cout << "Data transfer complete. Checking results...\n";
 
-  // Set the number of threads and iterations
-  // Default: 1 thread, 1 iteration
-  if (argc == 2) {
-    num_thread = 1;
-    it_max = 600;
-  } else if (argc == 3) {
-    num_thread = 1;
-    it_max = atoi(argv[2]);
-  } else {
-    throw std::runtime_error("Usage: " + std::string(argv[0]) + " <XCLBIN File> <iterations>");
+  // Outputs are checked against the input buffer, or against the pattern
+  // regenerated from the seed which does not need to read the input back
+  auto verify_start = std::chrono::steady_clock::now();
+  auto in_mapped = in[0].bo().map<uint32_t*>();
+  for (int c = 0; c < num_thread; c++) {
+    for (int p = 0; p < pairs; p++) {
+      auto &out = contexts[c].out[p].bo();
+      out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+      auto out_mapped = out.map<uint32_t*>();
+
+      auto i = regenerate ? vtd::verify_pattern(out_mapped, buf_word_count, seed)
+                          : vtd::compare_words(out_mapped, in_mapped, buf_word_count);
+      if (i == vtd::pattern_match)
+        continue;
+
+      std::cout << "Context " << c << " In[" << i << "]: " << vtd::pattern_word(seed, i) << " | Out[" << i << "]: "
+                << out_mapped[i] << " (byte offset 0x" << std::hex << i * sizeof(uint32_t) << std::dec << ")\n";
+      throw std::runtime_error("Error: Output data mismatch!\nTEST FAILED!\n");
+    }
+  }
+  auto verify_end = std::chrono::steady_clock::now();
+  std::cout << "Data verify time: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(verify_end - verify_start).count() << " ms\n";
+
+  // Only verified runs produce results
+  if (!results_json.empty()) {
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
   }
-
-  std::string xclbinFileName = argv[1];
-  auto device = xrt::device(0);
-
-  std::vector<std::thread> threads;
-  for (int i = 0; i < num_thread; i++)
-    threads.emplace_back(std::thread(run_test_iterations, xclbinFileName, std::ref(device), i, it_max));
-
-  for (auto& th : threads)
-    th.join();
 }
 
 int
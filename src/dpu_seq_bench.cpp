@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application measures how fast a DPU sequence text file is turned
+ * into instruction words.  It compares the getline + stringstream parser the
+ * host applications used to carry with the shared single pass loader, and
+ * with reading the cached binary image.  No device is needed, the words are
+ * decoded into host memory.  Without a sequence file a synthetic one with the
+ * requested number of words is generated.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dpu_sequence.h"
+
+constexpr int dpu_instr_str_len = 8;
+constexpr size_t default_word_count = 4 * 1024 * 1024;
+
+// Legacy two pass parser, kept verbatim as the baseline
+size_t
+legacy_get_instr_size(const std::string &fname)
+{
+  std::string line;
+  size_t size = 0;
+
+  std::ifstream file(fname);
+  if (!file.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
+
+  while (getline(file, line)) {
+    if (line.at(0) != '#')
+      size++;
+  }
+
+  return size;
+}
+
+void
+legacy_init_instr_buf(const std::string &fname, uint32_t *instr)
+{
+  std::string line;
+  std::ifstream ifs(fname);
+
+  while (getline(ifs, line)) {
+    if (line.at(0) == '#')
+      continue;
+
+    std::stringstream ss(line);
+    unsigned int word = 0;
+
+    ss.seekp(0, std::ios::end);
+    if (ss.tellp() != dpu_instr_str_len)
+      throw std::runtime_error("Error: Invalid DPU instruction size\n");
+
+    ss >> std::hex >> word;
+    *(instr++) = word;
+  }
+}
+
+void
+generate_sequence(const std::string &fname, size_t words)
+{
+  std::ofstream ofs(fname);
+  if (!ofs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+
+  std::mt19937 gen(0);
+  ofs << "# Synthetic DPU sequence\n" << std::hex << std::setfill('0');
+  for (size_t i = 0; i < words; i++) {
+    if (i % 4096 == 0)
+      ofs << "# block " << i << "\n";
+    ofs << std::setw(dpu_instr_str_len) << gen() << "\n";
+  }
+}
+
+template <typename Func>
+double
+time_us(Func &&func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+void
+report(const std::string &name, size_t words, double us, double baseline_us)
+{
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << us << " us" << std::setw(14) << words / us << " Mwords/s"
+            << std::setw(9) << baseline_us / us << "x\n";
+}
+
+void
+run(int argc, char **argv)
+{
+  std::string fname;
+  size_t words = default_word_count;
+  bool synthetic = true;
+
+  if (argc == 2) {
+    fname = argv[1];
+    synthetic = false;
+  } else if (argc == 3 && std::string(argv[1]) == "-n") {
+    words = std::stoul(argv[2]);
+  } else if (argc != 1) {
+    throw std::runtime_error("Usage: " + std::string(argv[0]) + " [<DPU Sequence File> | -n <word count>]");
+  }
+
+  if (synthetic) {
+    fname = "dpu_seq_bench.txt";
+    generate_sequence(fname, words);
+  }
+
+  // Baseline: count the lines, then parse every line through a stringstream
+  std::vector<uint32_t> legacy;
+  double legacy_us = time_us([&] {
+    legacy.resize(legacy_get_instr_size(fname));
+    legacy_init_instr_buf(fname, legacy.data());
+  });
+  words = legacy.size();
+
+  // Shared loader: map the file and decode once into a buffer sized up front
+  std::vector<uint32_t> decoded;
+  double parse_us = time_us([&] {
+    vtd::mapped_file file(fname);
+    decoded.resize(vtd::dpu_sequence_max_words(file.size()));
+    decoded.resize(vtd::parse_dpu_sequence(file.data(), file.data() + file.size(), decoded.data()));
+  });
+
+  if (decoded != legacy)
+    throw std::runtime_error("Error: Decoded DPU sequence does not match the baseline parser\n");
+
+  // Cached image: what later runs pay once the binary image exists
+  std::string image = vtd::dpu_sequence_cache_name(fname) + ".bench";
+  {
+    std::ofstream ofs(image, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(decoded.data()), decoded.size() * sizeof(uint32_t));
+  }
+  std::vector<uint32_t> cached(decoded.size());
+  double cache_us = time_us([&] {
+    std::ifstream ifs(image, std::ios::binary);
+    ifs.read(reinterpret_cast<char*>(cached.data()), cached.size() * sizeof(uint32_t));
+  });
+  std::remove(image.c_str());
+
+  if (cached != legacy)
+    throw std::runtime_error("Error: Cached DPU sequence does not match the baseline parser\n");
+
+  std::cout << "DPU sequence: " << fname << " (" << words << " words)\n";
+  report("getline + stringstream", words, legacy_us, legacy_us);
+  report("single pass mmap", words, parse_us, legacy_us);
+  report("cached binary image", words, cache_us, legacy_us);
+
+  if (synthetic)
+    std::remove(fname.c_str());
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
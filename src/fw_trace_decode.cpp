@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Decodes raw NPU firmware event trace and log buffers into Chrome trace JSON
+ * using the firmware_configs schemas of the archive, and reports the firmware
+ * side durations of every begin/end span, EXECUTE_BUFFER, CMD_CHAIN and
+ * preemption among them.  These line up with the host side latencies of
+ * tct_tp and preempt, --histogram-json writes them in the same format.
+ *
+ * --generate <n> first writes a synthetic trace of n records (and a log when
+ * --log is given) to the input files, so the decoder can be exercised and
+ * its throughput measured without a device.  Without --output only the span
+ * summary is produced.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dpu_sequence.h"
+#include "fw_trace.h"
+#include "latency_histogram.h"
+
+// Fixed seed xorshift, the synthetic files are reproducible
+struct xorshift
+{
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+
+  uint64_t
+  next()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+};
+
+class record_file
+{
+public:
+  explicit record_file(const std::string &fname)
+    : m_fname(fname)
+    , m_file(std::fopen(fname.c_str(), "wb"))
+  {
+    if (!m_file)
+      throw std::runtime_error("Error: Failure opening file " + fname + " for writing!!\n");
+    m_buf.reserve(1 << 20);
+  }
+
+  ~record_file()
+  {
+    std::fclose(m_file);
+  }
+
+  void
+  append(const void *data, size_t size)
+  {
+    auto bytes = static_cast<const char*>(data);
+    m_buf.insert(m_buf.end(), bytes, bytes + size);
+    if (m_buf.size() >= (1 << 20))
+      flush();
+  }
+
+  void
+  flush()
+  {
+    if (!m_buf.empty() && std::fwrite(m_buf.data(), 1, m_buf.size(), m_file) != m_buf.size())
+      throw std::runtime_error("Error: Failure writing " + m_fname + "\n");
+    m_buf.clear();
+  }
+
+private:
+  std::string m_fname;
+  std::FILE *m_file;
+  std::vector<char> m_buf;
+};
+
+// Value of the lookup entry called 'name' of 'field'
+uint64_t
+lookup_value(const vtd::trace_schema &schema, const vtd::trace_field &field, const std::string &name)
+{
+  auto &table = schema.names(field.table);
+  auto quoted = "\"" + name + "\"";
+  for (size_t v = 0; v < table.index.size(); v++) {
+    if (table.index[v] >= 0 && table.names[table.index[v]] == quoted)
+      return v;
+  }
+  throw std::runtime_error("Error: Trace schema has no lookup entry " + name + "\n");
+}
+
+class trace_generator
+{
+public:
+  trace_generator(const vtd::trace_schema &schema, const std::string &fname)
+    : m_schema(schema)
+    , m_out(fname)
+  {}
+
+  void
+  emit(uint32_t id, uint64_t ticks, uint64_t context, uint64_t opcode = 0, uint64_t op_id = 0)
+  {
+    auto ev = m_schema.find(id);
+    uint64_t payload = 0;
+    for (auto &field : ev->fields) {
+      uint64_t value = field.key == "\"context_id\":" ? context : field.key == "\"msg_opcode\":" ? opcode
+                       : field.key == "\"op_id\":" ? op_id : 0;
+      payload |= value << field.start;
+    }
+    uint64_t record[2] = {ticks, id | (payload << m_schema.event_bits())};
+    m_out.append(record, sizeof(record));
+    m_records++;
+  }
+
+  uint64_t
+  records() const
+  {
+    return m_records;
+  }
+
+  void
+  flush()
+  {
+    m_out.flush();
+  }
+
+private:
+  const vtd::trace_schema &m_schema;
+  record_file m_out;
+  uint64_t m_records = 0;
+};
+
+/* Four contexts take turns submitting EXECUTE_BUFFER, command chains and
+ * preemptible DPU commands, the latter are preempted at a few control code
+ * points.  Durations are random within a realistic range.
+ */
+void
+generate_trace(const vtd::trace_schema &schema, const std::string &fname, uint64_t records, double ticks_per_us)
+{
+  auto msg_start = schema.id("PROCESS_APP_MSG_START");
+  auto msg_done = schema.id("PROCESS_APP_MSG_DONE");
+  auto preempt_start = schema.id("PREEMPT_CTRL_START");
+  auto preempt_done = schema.id("PREEMPT_CTRL_DONE");
+  auto save_start = schema.id("L2SAVE_START");
+  auto save_done = schema.id("L2SAVE_DONE");
+  auto start_ev = schema.find(msg_start);
+  auto &opcode_field = start_ev->fields[start_ev->name_field];
+  const uint64_t opcodes[] = {
+    lookup_value(schema, opcode_field, "IPU_MSG_EXECUTE_BUFFER"),
+    lookup_value(schema, opcode_field, "IPU_MSG_EXEC_NPU_CMD_CHAIN"),
+    lookup_value(schema, opcode_field, "IPU_MSG_EXEC_DPU_PREEMPT"),
+  };
+
+  trace_generator gen(schema, fname);
+  xorshift rng;
+  uint64_t ticks = 0;
+  auto us = [&](uint64_t lo, uint64_t hi) {
+    return static_cast<uint64_t>((lo + rng.next() % (hi - lo + 1)) * ticks_per_us);
+  };
+
+  for (uint64_t cmd = 0; gen.records() < records; cmd++) {
+    auto context = cmd % 4;
+    auto kind = cmd % 3;
+    gen.emit(msg_start, ticks += us(2, 10), context, opcodes[kind]);
+    if (kind == 2) {
+      for (uint64_t op = 0; op < 4 && gen.records() + 3 < records; op++) {
+        gen.emit(preempt_start, ticks += us(5, 20), context, 0, op);
+        gen.emit(save_start, ticks += us(1, 2), context);
+        gen.emit(save_done, ticks += us(3, 6), context);
+        gen.emit(preempt_done, ticks += us(1, 3), context, 0, op);
+      }
+    }
+    gen.emit(msg_done, ticks += us(kind == 1 ? 40 : 10, kind == 1 ? 120 : 60), context, opcodes[kind]);
+  }
+  gen.flush();
+}
+
+void
+set_field(uint8_t *header, size_t header_size, const vtd::trace_field &field, uint64_t value)
+{
+  uint64_t bits = 0;
+  size_t offset = field.start / 8;
+  size_t size = std::min<size_t>(sizeof(bits), header_size - offset);
+  std::memcpy(&bits, header + offset, size);
+  bits |= value << (field.start % 8);
+  std::memcpy(header + offset, &bits, size);
+}
+
+// Concise messages with two arguments, every eighth one in full format
+void
+generate_log(const vtd::log_schema &schema, const std::string &fname, uint64_t messages, double ticks_per_us)
+{
+  record_file out(fname);
+  xorshift rng;
+  std::vector<uint8_t> header(schema.header_size());
+  auto &fields = schema.fields();
+  int format = schema.field("format");
+  int level = schema.field("level");
+  uint64_t ticks = 0;
+
+  for (uint64_t i = 0; i < messages; i++) {
+    ticks += static_cast<uint64_t>((5 + rng.next() % 50) * ticks_per_us);
+    bool full = format >= 0 && i % 8 == 7;
+    char text[32] = {};
+    uint32_t args[2] = {static_cast<uint32_t>(i % 4), static_cast<uint32_t>(rng.next())};
+    uint64_t argc = 2;
+    if (full) {
+      std::snprintf(text, sizeof(text), "context %u idle", args[0]);
+      argc = sizeof(text) / sizeof(uint32_t);
+    }
+
+    std::fill(header.begin(), header.end(), 0);
+    set_field(header.data(), header.size(), fields[schema.field("timestamp")], ticks);
+    set_field(header.data(), header.size(), fields[schema.field("argc")], argc);
+    if (format >= 0)
+      set_field(header.data(), header.size(), fields[format], schema.enum_value(format, full ? "full" : "concise"));
+    if (level >= 0)
+      set_field(header.data(), header.size(), fields[level], schema.enum_value(level, i % 16 ? "inf" : "wrn"));
+    for (auto name : {"module", "line", "appn"}) {
+      int index = schema.field(name);
+      if (index >= 0)
+        set_field(header.data(), header.size(), fields[index], 1 + rng.next() % 200);
+    }
+    out.append(header.data(), header.size());
+    if (full)
+      out.append(text, sizeof(text));
+    else
+      out.append(args, sizeof(args));
+  }
+  out.flush();
+}
+
+double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void
+run(int argc, char **argv)
+{
+  std::string schema_file = "../archive/strx/firmware_configs/trace_events.json";
+  std::string log_schema_file = "../archive/strx/firmware_configs/firmware_log.json";
+  std::string trace_file;
+  std::string log_file;
+  std::string output;
+  std::string histogram_json;
+  double ticks_per_us = 1000;
+  uint64_t generate = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--schema" && i + 1 < argc)
+      schema_file = argv[++i];
+    else if (arg == "--log-schema" && i + 1 < argc)
+      log_schema_file = argv[++i];
+    else if (arg == "--trace" && i + 1 < argc)
+      trace_file = argv[++i];
+    else if (arg == "--log" && i + 1 < argc)
+      log_file = argv[++i];
+    else if (arg == "--output" && i + 1 < argc)
+      output = argv[++i];
+    else if (arg == "--ticks-per-us" && i + 1 < argc)
+      ticks_per_us = std::stod(argv[++i]);
+    else if (arg == "--generate" && i + 1 < argc)
+      generate = std::stoull(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else
+      throw std::runtime_error("Usage: " + std::string(argv[0]) + " [--trace <file>] [--log <file>]"
+                               " [--output <trace.json>] [--schema <trace_events.json>]"
+                               " [--log-schema <firmware_log.json>] [--ticks-per-us <n>] [--generate <records>]"
+                               " [--histogram-json <file>]\n");
+  }
+  if (trace_file.empty() && log_file.empty())
+    throw std::runtime_error("Error: Nothing to decode, pass --trace and/or --log\n");
+  if (ticks_per_us <= 0)
+    throw std::runtime_error("Error: --ticks-per-us must be positive\n");
+
+  auto start = std::chrono::steady_clock::now();
+  auto schema = vtd::trace_schema::load(schema_file);
+  auto log_schema = vtd::log_schema::load(log_schema_file);
+  std::cout << "Schema setup time: " << seconds_since(start) * 1e3 << " ms" << std::endl;
+
+  if (generate) {
+    start = std::chrono::steady_clock::now();
+    if (!trace_file.empty())
+      generate_trace(schema, trace_file, generate, ticks_per_us);
+    if (!log_file.empty())
+      generate_log(log_schema, log_file, generate / 8, ticks_per_us);
+    std::cout << "Generated synthetic input in " << seconds_since(start) << " s" << std::endl;
+  }
+
+  std::unique_ptr<vtd::trace_json_writer> out;
+  if (!output.empty())
+    out = std::make_unique<vtd::trace_json_writer>(output);
+
+  if (!trace_file.empty()) {
+    vtd::mapped_file input(trace_file);
+    vtd::trace_decoder decoder(schema, ticks_per_us);
+    start = std::chrono::steady_clock::now();
+    decoder.decode(input.data(), input.data() + input.size(), out.get());
+    double secs = seconds_since(start);
+
+    std::cout << "Trace: " << decoder.records() << " records, " << decoder.unknown() << " unknown, "
+              << decoder.unmatched() << " unmatched ends" << std::endl;
+    if (input.size() % 16)
+      std::cout << "Trace: ignored a truncated record of " << input.size() % 16 << " bytes" << std::endl;
+    std::cout << "Trace decode: " << input.size() / 1e6 << " MB in " << secs * 1e3 << " ms, "
+              << input.size() / secs / 1e9 << " GB/s" << std::endl;
+
+    auto spans = decoder.spans();
+    for (auto &span : spans)
+      span.second.print(std::cout, "  " + span.first);
+    if (!histogram_json.empty())
+      vtd::write_histograms_json(histogram_json, spans);
+  }
+
+  if (!log_file.empty()) {
+    vtd::mapped_file input(log_file);
+    start = std::chrono::steady_clock::now();
+    auto messages = log_schema.decode(input.data(), input.data() + input.size(), ticks_per_us, out.get());
+    double secs = seconds_since(start);
+    std::cout << "Log: " << messages << " messages, " << input.size() / 1e6 << " MB in " << secs * 1e3 << " ms, "
+              << input.size() / secs / 1e9 << " GB/s" << std::endl;
+  }
+
+  if (out)
+    out->finish();
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
@@ -11,192 +11,344 @@
  * 4. GOPS/core = 192K/(Cycle_count*HCLK period)= 192*1024/(229*1 ns)= 0.8585*10^12 OP/s= 0.8585 TOPS/core
  * 5. Repeat #4 for each core - ensure you enter cycle count for each core.
  * 6. HCLK period will be a function of the DPM state (for DPM7, it will be 1/1.8GHz).
+ *
+ * The H clock and the power mode are queried from the device and the core
+ * count follows from the columns of the xclbin partition, --clock-mhz and
+ * --cores override them.  Once the run completes the result buffer is polled
+ * until every core has reported, then all record timer entries are decoded
+ * and TOPS is reported per core, per column and in aggregate.
+ *
+ * --warmup runs the sequence before measuring, --runs takes a list of sample
+ * counts to sweep.  Each sweep point reports the steady state device (cycle
+ * count) and host (submit to completion) TOPS with 95% confidence intervals
+ * and warns when the host figure falls more than --divergence percent short.
+ * The setup phases before the first run are printed as a startup breakdown.
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
-#include <chrono>
 #include <thread>
+#include <vector>
 
 // XRT includes
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_bo.h"
 
-#include "CLI11.hpp"
-#include <cstdlib>
+#include "cmdline.h"
+#include "device_control.h"
+#include "dpu_sequence.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "sample_stats.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
 
 #define HOST_APP 1
 
-size_t get_instr_size(std::string &fname) {
-  std::ifstream myfile (fname);
-  size_t i = 0;
-  if (myfile.is_open())
-  {
-    printf("Open instr successfully!\n");
-    std::string line;
-    while (getline (myfile,line))
-    {
-      if(line.at(0)!='#'){
-        i++;
-      }
-    }
-    myfile.close();
-  }
-  return i;
-}
-
-// Copy values from text files into buff, expecting values are ascii encoded hex
-void init_hex_buf(int* buff, size_t bytesize, std::string &filename) {
-  std::ifstream ifs(filename);
-
-  if (!ifs.is_open()) {
-    std::cout << "Failure opening file " + filename + " for reading!!" << std::endl;
-    abort();
-  }
-
-  std::string line;
-  while (getline (ifs,line))
-  {
-    if(line.at(0)!='#'){
-      unsigned int temp = 0;
-      std::stringstream ss(line);
-      ss >> std::hex >> temp;
-      *(buff++) = temp;
-    }
+// Core rows per AIE column on NPU4 class devices
+static constexpr uint32_t core_rows = 4;
+
+// Results BO layout: record timer entries in the first 3K, one cycle count
+// per core from offset 3K on
+static constexpr uint32_t size_4K   = 0x1000;
+static constexpr uint32_t offset_3K = 0x0C00;
+
+/* Each record timer entry has 32bit ID and 32bit AIE Timer low value.
+ * Also, the first 32 bit in the buffer is used to store total number
+ * of record timer entries written so far. So, max_count_in_size_3K is 1 less
+ * than total number of entries possible in 3K buffer section.
+ */
+static constexpr uint32_t max_count_in_size_3K = (offset_3K / (2 * sizeof(uint32_t))) - 1;
+
+struct record_timer
+{
+  uint32_t id;
+  uint32_t timestamp;
+};
+
+// Timestamps seen for one record timer ID
+struct timer_span
+{
+  uint32_t count = 0;
+  uint32_t first = 0;
+  uint32_t last = 0;
+};
+
+// Sync the results back until the entry count and every core's cycle count
+// are in, the result write-back can trail the command completion
+bool
+wait_for_results(xrt::bo &bo_result, uint32_t cores, std::chrono::milliseconds timeout)
+{
+  auto words = bo_result.map<const uint32_t*>();
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  auto backoff = std::chrono::microseconds(50);
+
+  while (true) {
+    bo_result.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto cycles = words + offset_3K / sizeof(uint32_t);
+    if (words[0] && std::all_of(cycles, cycles + cores, [](uint32_t c) { return c != 0; }))
+      return true;
+    if (std::chrono::steady_clock::now() >= deadline)
+      return false;
+    std::this_thread::sleep_for(backoff);
+    backoff = std::min(backoff * 2, std::chrono::microseconds(2000));
   }
 }
 
-void init_instr_buf(xrt::bo &bo_instr, size_t instr_size, std::string& instr_path) {
-  init_hex_buf(bo_instr.map<int*>(), instr_size, instr_path);
-}
-
-int main() {
+int main(int argc, char **argv) {
+  vtd::startup_profile profile;
   unsigned int failed = 0;
   std::string instr_path = "sequences/gemm_int8.txt";
+  std::string xclbinFileName = "gemm_npu4.xclbin";
+  std::string histogram_json;
+  std::string results_json;
+  unsigned int clock_override = 0;
+  uint32_t cores_override = 0;
+  int timeout_ms = 1000;
+  int warmup = 0;
+  std::vector<int> run_counts = {1};
+  double divergence_pct = 20;
 
   try {
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--histogram-json" && i + 1 < argc)
+        histogram_json = argv[++i];
+      else if (arg == "--results-json" && i + 1 < argc)
+        results_json = argv[++i];
+      else if (arg == "--xclbin" && i + 1 < argc)
+        xclbinFileName = argv[++i];
+      else if (arg == "--clock-mhz" && i + 1 < argc)
+        clock_override = std::stoul(argv[++i]);
+      else if (arg == "--cores" && i + 1 < argc)
+        cores_override = std::stoul(argv[++i]);
+      else if (arg == "--timeout-ms" && i + 1 < argc)
+        timeout_ms = std::stoi(argv[++i]);
+      else if (arg == "--warmup" && i + 1 < argc)
+        warmup = std::stoi(argv[++i]);
+      else if (arg == "--runs" && i + 1 < argc)
+        run_counts = vtd::parse_int_list(argv[++i]);
+      else if (arg == "--divergence" && i + 1 < argc)
+        divergence_pct = std::stod(argv[++i]);
+      else
+        throw std::runtime_error("Usage: " + std::string(argv[0]) + " [--xclbin <file>] [--clock-mhz <MHz>]"
+                                 " [--cores <n>] [--timeout-ms <ms>] [--warmup <n>] [--runs <n>[,<n>...]]"
+                                 " [--divergence <pct>] [--histogram-json <file>] [--results-json <file>]");
+    }
+
     std::cout << "Host test code start..." << std::endl;
     std::cout << "Host test code is creating device object..." << std::endl;
     unsigned int device_index = 0;
-    auto device = xrt::device(device_index);
-    std::string xclbinFileName = "gemm_npu4.xclbin";
+    auto device = profile.time("device open", [device_index] { return xrt::device(device_index); });
+    vtd::setup_cache cache(device, &profile);
     std::cout << "Host test code is loading xclbin object..." << xclbinFileName << std::endl;
-    auto xclbin = xrt::xclbin(xclbinFileName);
-
-    // Determine The DPU Kernel Name
-    auto xkernels = xclbin.get_kernels();
-
-    auto iteratorFound = std::find_if(xkernels.begin(), xkernels.end(), [](xrt::xclbin::kernel& k) {
-      auto name = k.get_name();
-
-      bool found = ((name.rfind("DPU",0) == 0) || // Starts with "DPU"
-                    (name.rfind("dpu",0) == 0));   // Starts with "dpu"
-      return found;
-    });
-
-    if (iteratorFound == xkernels.end())
-        throw std::runtime_error("Error: xclbin does not have a valid kernel");
+    auto &xclbin = cache.xclbin(xclbinFileName);
 
-    xrt::xclbin::kernel& xkernel = *iteratorFound;
-    auto kernelName = xkernel.get_name();
-    
+    auto kernelName = cache.dpu_kernel_name(xclbinFileName);
     std::cout << "Host test code found kernel: " << kernelName << std::endl;
-    std::cout << "Host code is registering xclbin to the device..." << std::endl;
-    device.register_xclbin(xclbin);
 
     std::cout << "Host code is creating hw_context..." << std::endl;
-    xrt::hw_context context(device, xclbin.get_uuid());
+    auto context = cache.hw_context(xclbinFileName);
 
     std::cout << "Host test code is creating kernel object..." << std::endl;
-    auto kernel = xrt::kernel(context, kernelName);
+    auto kernel = cache.kernel(xclbinFileName);
 
-    // Create BOs
-    static constexpr uint32_t size_4K   = 0x1000;
-    static constexpr uint32_t offset_3K = 0x0C00;
-
-    size_t instr_word_size = get_instr_size(instr_path);
-    if (instr_word_size == 0)
-        throw std::runtime_error("Error: Why do instructions have zero length?");
-
-    // Create BOs
-    auto bo_instr = xrt::bo(device, instr_word_size * sizeof(int), XCL_BO_FLAGS_CACHEABLE, kernel.group_id(5));
-
-    // Init BOs
-    // Load them with data from files
-    init_instr_buf(bo_instr, instr_word_size, instr_path); // DPU sequence gemm_int8.txt
-    
-    // Sync Input BO
-    bo_instr.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    // Create and load the instruction BO from the DPU sequence gemm_int8.txt
+    auto instr = profile.time("DPU sequence", [&] { return vtd::load_dpu_sequence(device, kernel, instr_path); });
 
     // results BO syncs profile result from device
-    auto bo_result = xrt::bo(device, size_4K, XCL_BO_FLAGS_CACHEABLE, kernel.group_id(5));
+    auto bo_result = profile.time("BO allocation", [&] {
+      return xrt::bo(device, size_4K, XCL_BO_FLAGS_CACHEABLE, kernel.group_id(5));
+    });
 
     // Set kernel argument and trigger it to run
     uint64_t opcode = HOST_APP;
 
-    /* Each record timer entry has 32bit ID and 32bit AIE Timer low value.
-    * Also, the first 32 bit in the buffer is used to store total number 
-    * of record timer entries written so far. So, max_count_in_size_3K is 1 less 
-    * than total number of entries possible in 3K buffer section.
-    */ 
-    static constexpr uint32_t max_count_in_size_3K = (offset_3K / (2 * sizeof(uint32_t))) - 1;
-
-    auto Total_TOPS = 0.0;
-    auto Total_cycle_count = 0.0;
-    auto temp_TOPS_per_core = 0.0;
+    // The clock follows the DPM state, so it is read for every run
+    auto control = vtd::make_device_control(device);
+    std::string power_mode = "unknown";
+    try {
+      power_mode = control->power_mode();
+    }
+    catch (const std::exception&) {
+      // Only reported, the clock below is what the numbers depend on
+    }
+    unsigned int IPUHCLK = clock_override;
+    if (!IPUHCLK) {
+      try {
+        IPUHCLK = control->aie_clock_mhz();
+      }
+      catch (const std::exception& ex) {
+        throw std::runtime_error(std::string(ex.what()) + "Pass --clock-mhz to set the AIE clock\n");
+      }
+    }
+    std::cout << "Running the performance test with " << IPUHCLK << " MHz AIE clock, power mode "
+              << power_mode << "..." << std::endl;
 
-    // This number is hardcoded temporarily, but it will be queried from the xbutil
-    int IPUHCLK = 1810; //in MHz
-    std::cout<<"Running the performance test with "<< IPUHCLK <<" MHz AIE clock..." << std::endl;
+    uint32_t num_cols = vtd::xclbin_partition_columns(xclbin);
+    uint32_t NumofCores = cores_override ? cores_override : num_cols * core_rows;
+    if (NumofCores > (size_4K - offset_3K) / sizeof(uint32_t))
+      throw std::runtime_error("Error: " + std::to_string(NumofCores) + " cores do not fit the result buffer\n");
+    std::cout << "Partition: " << num_cols << " columns, " << NumofCores << " cores" << std::endl;
 
-    auto IPUHCLK_Period= 1000000000.0/(IPUHCLK*1000000); //1810 MHz
+    auto IPUHCLK_Period = 1000.0 / IPUHCLK; // ns
 
     auto Number_MACs = 8*8*8; //512
     auto Number_OPs = Number_MACs*2; //1024
     auto Total_inner_outer_loop_count=2*2*12*4; //192
     auto Total_OPs = Number_OPs*Total_inner_outer_loop_count; //192K OPs
 
-    auto run = kernel(opcode, NULL, NULL, NULL, NULL, bo_instr, instr_word_size, NULL);
-    run.wait2();
-
     std::cout << "Total OPs: " << Total_OPs << std::endl;
 
-    auto result_bo_map = bo_result.map<uint8_t*>();
+    // One run object with its arguments set once, every sample reuses it
+    // together with the instruction and result BOs
+    xrt::run run(kernel);
+    run.set_arg(0, opcode);
+    for (int arg = 1; arg <= 4; arg++)
+      run.set_arg(arg, NULL);
+    run.set_arg(5, instr.bo);
+    run.set_arg(6, instr.size);
+    run.set_arg(7, NULL);
+
+    auto result_words = bo_result.map<const uint32_t*>();
+    auto cycles = result_words + offset_3K / sizeof(uint32_t);
+    profile.print(std::cout);
+
+    // Clear the results outside the timed region, wait for the write-back
+    // afterwards and return the host side latency of the run
+    auto run_once = [&]() {
+      std::memset(bo_result.map<void*>(), 0, size_4K);
+      bo_result.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+      auto start = std::chrono::steady_clock::now();
+      run.start();
+      run.wait2();
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      if (!wait_for_results(bo_result, NumofCores, std::chrono::milliseconds(timeout_ms)))
+        throw std::runtime_error("Error: Not every core reported a cycle count within " + std::to_string(timeout_ms)
+                                 + " ms\n");
+      return elapsed;
+    };
+
+    for (int i = 0; i < warmup; i++)
+      run_once();
+    if (warmup)
+      std::cout << "Completed " << warmup << " warm-up runs" << std::endl;
+
+    /* Device TOPS is what the cores report in cycles, host TOPS is the same
+     * work over the submit to completion latency.  The gap between the two is
+     * command processing, firmware and driver overhead, which is invisible in
+     * the cycle counts.
+     */
+    std::vector<std::pair<std::string, vtd::latency_histogram>> histograms;
+    vtd::result_set results;
+    results.app = "host_hal";
+    for (auto count : run_counts) {
+      vtd::latency_histogram latency;
+      std::vector<double> host_tops;
+      std::vector<double> device_tops;
+      std::vector<double> device_ns;
+      for (int i = 0; i < count; i++) {
+        auto elapsed = run_once();
+        latency.record(elapsed);
+        double host_ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        double tops = 0;
+        uint32_t max_cycles = 0;
+        for (uint32_t c = 0; c < NumofCores; c++) {
+          tops += Total_OPs / (IPUHCLK_Period * cycles[c] * 1000);
+          max_cycles = std::max(max_cycles, cycles[c]);
+        }
+        device_tops.push_back(tops);
+        device_ns.push_back(IPUHCLK_Period * max_cycles);
+        host_tops.push_back(NumofCores * Total_OPs / (host_ns * 1000));
+        results.add("gemm", "TOPS", device_tops.back());
+        results.add("gemm-host", "TOPS", host_tops.back());
+      }
 
-    bo_result.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-    // Add time delay to wait till the device has transferred data back to the host
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-    uint32_t* core_ptr = reinterpret_cast<uint32_t*>(result_bo_map+offset_3K);
-    uint32_t NumofCores = 32;
-
-    Total_TOPS = 0.0;
-    Total_cycle_count = 0.0;
-    temp_TOPS_per_core = 0.0;
-    if (NumofCores <= max_count_in_size_3K) {
-      for (uint32_t i = 0 ; i < NumofCores; i++) {
-        auto Cycle_Count = *core_ptr;
-        temp_TOPS_per_core = Total_OPs/(IPUHCLK_Period*Cycle_Count*1000);
-        Total_cycle_count = Total_cycle_count + Cycle_Count;
-        Total_TOPS = Total_TOPS + temp_TOPS_per_core;
-        core_ptr++;
+      auto host = vtd::summarize_samples(host_tops);
+      auto dev = vtd::summarize_samples(device_tops);
+      std::cout << std::fixed << std::setprecision(4);
+      std::cout << "Steady state over " << count << " runs:" << std::endl;
+      std::cout << "  Device TOPS: " << dev.mean << " +/- " << dev.ci95 << " (95% CI, min " << dev.min << " max "
+                << dev.max << ", CV " << dev.cv() * 100 << "%)" << std::endl;
+      std::cout << "  Host TOPS:   " << host.mean << " +/- " << host.ci95 << " (95% CI, min " << host.min << " max "
+                << host.max << ", CV " << host.cv() * 100 << "%)" << std::endl;
+      std::cout << std::defaultfloat;
+      latency.print(std::cout, "GEMM run latency, " + std::to_string(count) + " runs");
+
+      if (host.mean < dev.mean * (1 - divergence_pct / 100)) {
+        double overhead_us = latency.mean_us() - vtd::summarize_samples(device_ns).mean / 1000;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "WARNING: Host TOPS is " << (1 - host.mean / dev.mean) * 100 << "% below device TOPS, "
+                  << overhead_us << " us per run spent outside the cores" << std::endl;
+        std::cout << std::defaultfloat;
       }
-    
+      histograms.emplace_back(run_counts.size() == 1 ? "gemm" : "gemm_" + std::to_string(count) + "_runs",
+                              latency);
+    }
+    if (!histogram_json.empty())
+      vtd::write_histograms_json(histogram_json, histograms);
+
+
+    // The detailed report covers the last run, decode every record timer
+    // entry in one pass, grouped by ID
+    uint32_t entry_count = result_words[0];
+    if (entry_count > max_count_in_size_3K)
+      throw std::runtime_error("Error: Record timer count " + std::to_string(entry_count) + " exceeds the buffer\n");
+    auto entries = reinterpret_cast<const record_timer*>(result_words + 2);
+    std::map<uint32_t, timer_span> timers;
+    for (uint32_t i = 0; i < entry_count; i++) {
+      auto &span = timers[entries[i].id];
+      if (!span.count++)
+        span.first = entries[i].timestamp;
+      span.last = entries[i].timestamp;
+    }
+
+    // Cycle counts are stored column by column, core_rows per column
+    std::vector<double> core_tops(NumofCores);
+    std::vector<double> column_tops((NumofCores + core_rows - 1) / core_rows);
+    double Total_cycle_count = 0;
+    for (uint32_t i = 0; i < NumofCores; i++) {
+      core_tops[i] = Total_OPs / (IPUHCLK_Period * cycles[i] * 1000);
+      column_tops[i / core_rows] += core_tops[i];
+      Total_cycle_count += cycles[i];
+    }
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Record timer entries: " << entry_count << " (" << timers.size() << " IDs)" << std::endl;
+    for (auto &timer : timers) {
+      // AIE timer low values wrap, unsigned differences stay correct
+      std::cout << "  ID 0x" << std::hex << timer.first << std::dec << ": " << timer.second.count << " entries, "
+                << static_cast<uint32_t>(timer.second.last - timer.second.first) << " cycles first to last"
+                << std::endl;
+    }
+    for (uint32_t i = 0; i < NumofCores; i++) {
+      std::cout << "Core " << i << " (col " << i / core_rows << ", row " << i % core_rows << "): " << cycles[i]
+                << " cycles, " << core_tops[i] << " TOPS" << std::endl;
+    }
+    for (size_t c = 0; c < column_tops.size(); c++)
+      std::cout << "Column " << c << ": " << column_tops[c] << " TOPS" << std::endl;
+
+    auto core_spread = vtd::summarize_samples(core_tops);
+    auto column_spread = vtd::summarize_samples(column_tops);
+    std::cout << "Per core TOPS min " << core_spread.min << " max " << core_spread.max << " spread "
+              << (core_spread.max - core_spread.min) << std::endl;
+    std::cout << "Per column TOPS min " << column_spread.min << " max " << column_spread.max << " spread "
+              << (column_spread.max - column_spread.min) << std::endl;
     std::cout << "Average cycle count: " << Total_cycle_count/NumofCores << std::endl;
     std::cout << "Total execution time: " << IPUHCLK_Period*(Total_cycle_count/NumofCores) << " ns"<< std::endl;
-    std::cout << "Total TOPS with "<< IPUHCLK <<" MHz AIE frequency: " << Total_TOPS << std::endl;
-    }
+    std::cout << "Total TOPS with "<< IPUHCLK <<" MHz AIE frequency: " << core_spread.mean * core_spread.count << std::endl;
 
-    /*
-    1.	Essentially, we are doing 4 unrolled loop of 8x8_8x8 matmult.
-    2.	Each 8x8_8x8 matmult involves 8x8x8=512 MAC or 512*2 OP=1024 OPs.
-    3.	Total inner*outer loop count= 2*2*12*4 (4 for unrolled loop)=192.
-    4.	Total OPs= 192*1024= 192K OPs.
-    5.	GOPS/core = 192K/(Cycle_count*HCLK period)= 192*1024/(232*1 ns)= 0.82*10^12 OP/s= 0.82 TOPS
-    6.	Repeat #5 for each core- ensure you enter cycle count for each core.
-    7.	HCLK period will be a function of the DPM state (for DPM7, it will be 1/1.8GHz).
-    */
+    if (!results_json.empty()) {
+      vtd::set_result_device(results, device);
+      vtd::write_results_json(results_json, results);
+    }
   }
   catch (const std::exception& ex) {
     std::cout << "ERROR: Caught exception: " << ex.what() << '\n';
@@ -212,4 +364,3 @@ int main() {
 
   return (failed ? EXIT_FAILURE : EXIT_SUCCESS);
 }
-
@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* MobileNet inference benchmark on the ELF flow.
+ *
+ * The weights in mobilenet_param.bin are mapped straight into a user pointer
+ * BO and synced once, and the intermediate and microcode buffers are set up
+ * once as well.  The xclbin, hw_context and kernel come from a
+ * vtd::setup_cache and the setup is profiled phase by phase.  Then --frames
+ * IFM frames are streamed through the network,
+ * --batch of them per submission: the frames of a batch are copied into their
+ * own IFM buffers and synced, their runs are submitted as one xrt::runlist
+ * command chain, and their outputs are synced back.  Buffer sizes come from
+ * buffer_sizes.json next to the input files.
+ *
+ * Every frame is the same IFM, so every OFM must match the first one.  The
+ * OFMs are filled with a marker before the first run, an OFM still holding
+ * it was never written.  The check runs after the frame latency is taken.
+ *
+ * Reported are frames/s, the frame latency percentiles (from staging the
+ * batch to having its outputs on the host) and the host overhead per frame,
+ * the part of the batch time spent staging, submitting and reading back
+ * rather than waiting for the device.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_kernel.h"
+
+#include "bo_pool.h"
+#include "dpu_sequence.h"
+#include "json.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
+
+constexpr unsigned long int host_app = 3;
+
+// ELF flow argument index of every MobileNet buffer
+constexpr int arg_ifm = 3;
+constexpr int arg_param = 4;
+constexpr int arg_ofm = 5;
+constexpr int arg_inter = 6;
+constexpr int arg_mc = 7;
+
+// Fills the OFMs before the first run
+constexpr uint8_t ofm_marker = 0xa5;
+
+struct buffer_sizes
+{
+  size_t ifm = 0;
+  size_t param = 0;
+  size_t inter = 0;
+  size_t mc = 0;
+  size_t ofm = 0;
+};
+
+// One frame of a batch, with its own IFM and OFM buffers and run
+struct frame_slot
+{
+  xrt::bo ifm;
+  xrt::bo ofm;
+  xrt::run run;
+};
+
+buffer_sizes
+load_buffer_sizes(const std::string &fname)
+{
+  auto doc = vtd::load_json(fname);
+  try {
+    auto &sizes = doc.at("buffer_sizes");
+    buffer_sizes s;
+    s.ifm = sizes.at("ifm_size").as_uint();
+    s.param = sizes.at("param_size").as_uint();
+    s.inter = sizes.at("inter_size").as_uint();
+    s.mc = sizes.at("mc_size").as_uint();
+    s.ofm = sizes.at("ofm_size").as_uint();
+    return s;
+  }
+  catch (const std::exception& ex) {
+    throw std::runtime_error(fname + ": " + ex.what());
+  }
+}
+
+double
+elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void
+run(int argc, char **argv)
+{
+  vtd::startup_profile profile;
+  std::string xclbin_path = "../xclbin_prod/mobilenet_elf_npu4_4x4.xclbin";
+  std::string elf_path = "../elf/mobilenet_4col.elf";
+  std::string data_dir = "../input_data/mobilenet";
+  std::string histogram_json;
+  std::string results_json;
+  int frames = 1000;
+  int batch = 1;
+  int warmup = 10;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--xclbin" && i + 1 < argc)
+      xclbin_path = argv[++i];
+    else if (arg == "--elf" && i + 1 < argc)
+      elf_path = argv[++i];
+    else if (arg == "--data-dir" && i + 1 < argc)
+      data_dir = argv[++i];
+    else if (arg == "--frames" && i + 1 < argc)
+      frames = std::stoi(argv[++i]);
+    else if (arg == "--batch" && i + 1 < argc)
+      batch = std::stoi(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::stoi(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else
+      throw std::runtime_error("Usage: " + std::string(argv[0]) + " [--xclbin <file>] [--elf <file>]"
+                               " [--data-dir <dir>] [--frames <n>] [--batch <n>] [--warmup <n>]"
+                               " [--histogram-json <file>] [--results-json <file>]\n");
+  }
+  if (frames < 1 || batch < 1 || warmup < 0)
+    throw std::runtime_error("Error: --frames and --batch must be positive\n");
+
+  auto dir = std::filesystem::path(data_dir);
+  auto sizes = load_buffer_sizes((dir / "buffer_sizes.json").string());
+
+  // The frame every slot is loaded with, it is copied per frame like a
+  // camera frame would be
+  vtd::mapped_file ifm_file((dir / "mobilenet_ifm.bin").string());
+  if (ifm_file.size() < sizes.ifm)
+    throw std::runtime_error("Error: mobilenet_ifm.bin holds fewer than the " + std::to_string(sizes.ifm)
+                             + " bytes expected\n");
+
+  auto device = profile.time("device open", [] { return xrt::device(0); });
+  vtd::setup_cache cache(device, &profile);
+  auto context = cache.hw_context(xclbin_path);
+  auto dpu = cache.elf_kernel(xclbin_path, elf_path);
+
+  // Weights, intermediate and microcode buffers are shared by every frame
+  // and set up once
+  auto load_start = std::chrono::steady_clock::now();
+  vtd::file_bo param(device, (dir / "mobilenet_param.bin").string(), sizes.param, dpu.group_id(arg_param));
+  param.bo().sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  profile.record("weights", load_start, std::chrono::steady_clock::now());
+  std::cout << "Weights: " << sizes.param << " bytes mapped and synced in " << elapsed_ms(load_start) << " ms\n";
+
+  auto inter = profile.time("BO allocation", [&] {
+    return xrt::bo(device, sizes.inter, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(arg_inter));
+  });
+  auto mc = profile.time("BO allocation", [&] {
+    return xrt::bo(device, sizes.mc, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(arg_mc));
+  });
+  inter.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  mc.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+  std::vector<frame_slot> slots(batch);
+  for (auto &slot : slots) {
+    profile.time("BO allocation", [&] {
+      slot.ifm = xrt::bo(device, sizes.ifm, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(arg_ifm));
+      slot.ofm = xrt::bo(device, sizes.ofm, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(arg_ofm));
+    });
+    slot.run = xrt::run(dpu);
+    slot.run.set_arg(0, host_app);
+    slot.run.set_arg(1, 0);
+    slot.run.set_arg(2, 0);
+    slot.run.set_arg(arg_ifm, slot.ifm);
+    slot.run.set_arg(arg_param, param.bo());
+    slot.run.set_arg(arg_ofm, slot.ofm);
+    slot.run.set_arg(arg_inter, inter);
+    slot.run.set_arg(arg_mc, mc);
+    std::memset(slot.ofm.map<void*>(), ofm_marker, sizes.ofm);
+    slot.ofm.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  }
+  profile.print(std::cout);
+
+  // A batch of several frames is one chain of the runs of its slots.  A run
+  // can only be on one list, so the chain is rebuilt when the count changes
+  // and dropped before a single run is started on its own.
+  xrt::runlist chain;
+  int chained = 0;
+  auto submit = [&](int count) {
+    if (count == 1) {
+      if (chained)
+        chain.reset();
+      chained = 0;
+      slots[0].run.start();
+      return;
+    }
+    if (chained != count) {
+      if (chained)
+        chain.reset();
+      else
+        chain = xrt::runlist(context);
+      for (int k = 0; k < count; k++)
+        chain.add(slots[k].run);
+      chained = count;
+    }
+    chain.execute();
+  };
+  auto wait = [&](int count) {
+    if (count == 1)
+      slots[0].run.wait2();
+    else
+      chain.wait();
+  };
+
+  std::vector<uint8_t> reference;
+  auto check = [&](int count) {
+    for (int k = 0; k < count; k++) {
+      auto ofm = slots[k].ofm.map<const uint8_t*>();
+      if (reference.empty()) {
+        if (std::all_of(ofm, ofm + sizes.ofm, [](uint8_t b) { return b == ofm_marker; }))
+          throw std::runtime_error("Error: MobileNet did not write its output!\nTEST FAILED!\n");
+        reference.assign(ofm, ofm + sizes.ofm);
+      }
+      else if (std::memcmp(ofm, reference.data(), sizes.ofm))
+        throw std::runtime_error("Error: Output of frame slot " + std::to_string(k)
+                                 + " differs from the first frame!\nTEST FAILED!\n");
+    }
+  };
+
+  // Stage, submit and read back one batch of 'count' frames.  Host time is
+  // everything but waiting for the runs.
+  vtd::latency_histogram latency;
+  std::chrono::nanoseconds host {};
+  auto run_batch = [&](int count, bool record) {
+    auto stage = std::chrono::steady_clock::now();
+    for (int k = 0; k < count; k++) {
+      slots[k].ifm.write(ifm_file.data());
+      slots[k].ifm.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    }
+    submit(count);
+    auto submitted = std::chrono::steady_clock::now();
+    wait(count);
+    auto completed = std::chrono::steady_clock::now();
+    for (int k = 0; k < count; k++)
+      slots[k].ofm.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto done = std::chrono::steady_clock::now();
+    check(count);
+
+    if (!record)
+      return;
+    for (int k = 0; k < count; k++)
+      latency.record(done - stage);
+    host += (submitted - stage) + (done - completed);
+  };
+
+  for (int i = 0; i < warmup; i++)
+    run_batch(batch, false);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int done = 0; done < frames; done += batch)
+    run_batch(std::min(batch, frames - done), true);
+  double wall_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  double fps = frames * 1e6 / wall_us;
+  double host_us = std::chrono::duration<double, std::micro>(host).count() / frames;
+  std::cout << "Frames: " << frames << ", batch size " << batch << "\n";
+  std::cout << "Time taken: " << wall_us << " us\n";
+  std::cout << "Throughput: " << fps << " frames/s\n";
+  latency.print(std::cout, "Frame latency");
+  std::cout << "Host overhead per frame: " << host_us << " us (" << host_us * frames / wall_us * 100
+            << "% of the time)\n";
+
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, {{"mobilenet batch " + std::to_string(batch), latency}});
+
+  if (!results_json.empty()) {
+    std::string suffix = batch > 1 ? "-b" + std::to_string(batch) : "";
+    vtd::result_set results;
+    results.app = "mobilenet";
+    results.add("mobilenet" + suffix, "fps", fps);
+    results.add("mobilenet-latency" + suffix, "us", latency.percentile_us(0.5));
+    results.add("mobilenet-host-overhead" + suffix, "us", host_us);
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_ELF_H
+#define VTD_MOCK_XRT_ELF_H
+
+#include <string>
+
+namespace xrt {
+
+// Stand-in for xrt::elf, only the file name is kept
+class elf
+{
+public:
+  explicit elf(const std::string &filename) : m_filename(filename) {}
+
+  const std::string&
+  get_filename() const
+  {
+    return m_filename;
+  }
+
+private:
+  std::string m_filename;
+};
+
+} // namespace xrt
+
+#endif
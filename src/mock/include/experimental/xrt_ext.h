@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_EXT_H
+#define VTD_MOCK_XRT_EXT_H
+
+#include <string>
+
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_module.h"
+
+namespace xrt::ext {
+
+// Stand-in for xrt::ext::kernel, the control code comes from the module
+class kernel : public xrt::kernel
+{
+public:
+  kernel(const hw_context &ctx, const module &mod, const std::string &name);
+
+  kernel(const hw_context &ctx, const std::string &name);
+};
+
+} // namespace xrt::ext
+
+#endif
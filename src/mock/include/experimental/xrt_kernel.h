@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_EXPERIMENTAL_KERNEL_H
+#define VTD_MOCK_XRT_EXPERIMENTAL_KERNEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+
+namespace xrt {
+
+class runlist_impl;
+
+// Stand-in for xrt::runlist.  The runs of a list are submitted to their
+// hw_context as one command chain, only the first of them pays the
+// submission cost, and the list completes with its last run.
+class runlist
+{
+public:
+  runlist() = default;
+
+  explicit runlist(const hw_context &hwctx);
+
+  void
+  add(const run &run);
+
+  void
+  execute();
+
+  void
+  wait() const;
+
+  std::cv_status
+  wait(const std::chrono::milliseconds &timeout) const;
+
+  ert_cmd_state
+  state() const;
+
+  void
+  reset();
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  std::shared_ptr<runlist_impl> m_impl;
+};
+
+} // namespace xrt
+
+#endif
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_MODULE_H
+#define VTD_MOCK_XRT_MODULE_H
+
+#include "experimental/xrt_elf.h"
+
+namespace xrt {
+
+// Stand-in for xrt::module
+class module
+{
+public:
+  explicit module(const elf &elf) : m_elf(elf) {}
+
+  const elf&
+  get_elf() const
+  {
+    return m_elf;
+  }
+
+private:
+  elf m_elf;
+};
+
+} // namespace xrt
+
+#endif
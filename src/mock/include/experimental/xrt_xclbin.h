@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_XCLBIN_H
+#define VTD_MOCK_XRT_XCLBIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xrt/xrt_uuid.h"
+#include "xrt/detail/xclbin.h"
+
+namespace xrt {
+
+class xclbin_impl;
+
+// Stand-in for xrt::xclbin.  The file is hashed into the UUID when it can be
+// read, otherwise the name is used so tests do not need real xclbins.
+class xclbin
+{
+public:
+  class kernel
+  {
+  public:
+    kernel() = default;
+
+    explicit kernel(const std::string &name) : m_name(name) {}
+
+    std::string
+    get_name() const
+    {
+      return m_name;
+    }
+
+    explicit operator bool() const
+    {
+      return !m_name.empty();
+    }
+
+  private:
+    std::string m_name;
+  };
+
+  xclbin() = default;
+
+  explicit xclbin(const std::string &filename);
+
+  std::vector<kernel>
+  get_kernels() const;
+
+  uuid
+  get_uuid() const;
+
+  // Raw section of the container, nullptr when the xclbin has none
+  template <typename SectionType>
+  SectionType
+  get_axlf_section(axlf_section_kind kind) const
+  {
+    return reinterpret_cast<SectionType>(get_section(kind));
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  const void*
+  get_section(axlf_section_kind kind) const;
+
+  std::shared_ptr<xclbin_impl> m_impl;
+};
+
+} // namespace xrt
+
+#endif
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_DEVICE_H
+#define VTD_MOCK_DEVICE_H
+
+/* Controls of the simulated NPU that a real device exposes through xrt-smi
+ * rather than the XRT API.  vtd::device_control uses these in mock builds.
+ */
+
+#include <string>
+
+#include "xrt/xrt_device.h"
+
+namespace vtd_mock {
+
+// VTD_MOCK_DEVICE_ID, by default the id of an NPU4 device
+std::string
+device_id(const xrt::device &device);
+
+// Current AIE (H) clock, follows the power mode unless VTD_MOCK_CLOCK_MHZ is set
+unsigned int
+aie_clock_mhz(const xrt::device &device);
+
+std::string
+power_mode(const xrt::device &device);
+
+// One of default, powersaver, balanced, performance and turbo
+void
+set_power_mode(const xrt::device &device, const std::string &mode);
+
+void
+set_force_preemption(const xrt::device &device, bool enable);
+
+// Average power of the simulated NPU since the previous call, including the
+// runs of other processes
+double
+power_watts(const xrt::device &device);
+
+} // namespace vtd_mock
+
+#endif
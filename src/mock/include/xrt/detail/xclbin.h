@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_DETAIL_XCLBIN_H
+#define VTD_MOCK_XRT_DETAIL_XCLBIN_H
+
+#include <cstdint>
+
+// The xclbin container sections the host applications read, with the layout
+// of the XRT definitions
+
+enum axlf_section_kind {
+  AIE_PARTITION = 32,
+};
+
+struct array_offset
+{
+  uint32_t size;
+  uint32_t offset;
+};
+
+struct aie_partition_info
+{
+  uint16_t column_width;
+  uint8_t padding[6];
+  struct array_offset start_columns;
+  uint8_t reserved[72];
+};
+
+struct aie_partition
+{
+  uint8_t schema_version;
+  uint8_t padding0[3];
+  uint32_t mpo_name;
+  uint32_t operations_per_cycle;
+  uint8_t padding[4];
+  uint64_t inference_fingerprint;
+  uint64_t pre_post_fingerprint;
+  struct aie_partition_info info;
+  struct array_offset aie_pdi;
+  uint32_t kernel_commit_id;
+  uint8_t reserved[52];
+};
+
+#endif
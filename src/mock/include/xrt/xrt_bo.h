@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_BO_H
+#define VTD_MOCK_XRT_BO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+
+enum xclBOSyncDirection {
+  XCL_BO_SYNC_BO_TO_DEVICE = 0,
+  XCL_BO_SYNC_BO_FROM_DEVICE,
+  XCL_BO_SYNC_BO_GMIO_TO_AIE,
+  XCL_BO_SYNC_BO_AIE_TO_GMIO,
+};
+
+#define XCL_BO_FLAGS_NONE      (0)
+#define XCL_BO_FLAGS_CACHEABLE (1U << 24)
+#define XCL_BO_FLAGS_HOST_ONLY (1U << 29)
+#define XRT_BO_FLAGS_HOST_ONLY XCL_BO_FLAGS_HOST_ONLY
+
+using xrtBufferFlags = uint32_t;
+using xrtMemoryGroup = uint32_t;
+
+namespace xrt {
+
+class bo_impl;
+
+// Stand-in for xrt::bo backed by page aligned host memory
+class bo
+{
+public:
+  bo() = default;
+
+  bo(const device &device, size_t size, xrtBufferFlags flags, xrtMemoryGroup grp);
+
+  bo(const hw_context &hwctx, size_t size, xrtBufferFlags flags, xrtMemoryGroup grp);
+
+  // User pointer BO, 'userptr' must be page aligned and outlive the BO
+  bo(const device &device, void *userptr, size_t size, xrtMemoryGroup grp);
+
+  // Sub-buffer of 'size' bytes at 'offset' in 'parent', which it keeps alive
+  bo(const bo &parent, size_t size, size_t offset);
+
+  template <typename MapType>
+  MapType
+  map()
+  {
+    return reinterpret_cast<MapType>(map_address());
+  }
+
+  void
+  sync(xclBOSyncDirection dir, size_t size, size_t offset);
+
+  void
+  sync(xclBOSyncDirection dir)
+  {
+    sync(dir, size(), 0);
+  }
+
+  void
+  write(const void *src, size_t size, size_t seek);
+
+  void
+  write(const void *src)
+  {
+    write(src, size(), 0);
+  }
+
+  void
+  read(void *dst, size_t size, size_t skip);
+
+  void
+  read(void *dst)
+  {
+    read(dst, size(), 0);
+  }
+
+  size_t
+  size() const;
+
+  uint64_t
+  address() const;
+
+  // A reference, as in XRT, so holding it does not add an owner
+  const std::shared_ptr<bo_impl>&
+  get_handle() const
+  {
+    return m_impl;
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  void*
+  map_address();
+
+  std::shared_ptr<bo_impl> m_impl;
+};
+
+} // namespace xrt
+
+#endif
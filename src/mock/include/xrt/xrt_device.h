@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_DEVICE_H
+#define VTD_MOCK_XRT_DEVICE_H
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "xrt/xrt_uuid.h"
+#include "experimental/xrt_xclbin.h"
+
+namespace xrt::info {
+
+// Device queries used by the host applications
+enum class device : unsigned int {
+  bdf = 0,
+  name = 3,
+};
+
+template <typename Type, Type param>
+struct param_traits;
+
+template <>
+struct param_traits<device, device::bdf>
+{
+  using return_type = std::string;
+};
+
+template <>
+struct param_traits<device, device::name>
+{
+  using return_type = std::string;
+};
+
+} // namespace xrt::info
+
+namespace xrt {
+
+class device_impl;
+
+// Stand-in for xrt::device.  Every handle opened on the same index or BDF
+// shares one simulated NPU, so column allocation is visible across handles.
+class device
+{
+public:
+  device() = default;
+
+  explicit device(unsigned int index);
+
+  explicit device(const std::string &bdf);
+
+  uuid
+  register_xclbin(const xclbin &xclbin);
+
+  template <info::device param>
+  typename info::param_traits<info::device, param>::return_type
+  get_info() const
+  {
+    return get_info_string(param);
+  }
+
+  std::shared_ptr<device_impl>
+  get_handle() const
+  {
+    return m_impl;
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  std::string
+  get_info_string(info::device param) const;
+
+  std::shared_ptr<device_impl> m_impl;
+};
+
+} // namespace xrt
+
+#endif
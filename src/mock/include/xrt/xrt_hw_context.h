@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_HW_CONTEXT_H
+#define VTD_MOCK_XRT_HW_CONTEXT_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_uuid.h"
+#include "experimental/xrt_elf.h"
+
+namespace xrt {
+
+class hw_context_impl;
+
+// Stand-in for xrt::hw_context.  Creating a context claims a column partition
+// of the simulated NPU; contexts that do not fit share an existing partition.
+class hw_context
+{
+public:
+  using qos_type = std::map<std::string, uint32_t>;
+
+  enum class access_mode : uint8_t { exclusive = 0, shared = 1 };
+
+  hw_context() = default;
+
+  hw_context(const device &device, const uuid &xclbin_id, const qos_type &qos);
+
+  hw_context(const device &device, const uuid &xclbin_id, access_mode mode);
+
+  hw_context(const device &device, const uuid &xclbin_id);
+
+  // Full ELF flow, the program carries the configuration instead of an xclbin
+  hw_context(const device &device, const elf &program);
+
+  device
+  get_device() const;
+
+  uuid
+  get_xclbin_uuid() const;
+
+  std::shared_ptr<hw_context_impl>
+  get_handle() const
+  {
+    return m_impl;
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  std::shared_ptr<hw_context_impl> m_impl;
+};
+
+} // namespace xrt
+
+#endif
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_KERNEL_H
+#define VTD_MOCK_XRT_KERNEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_hw_context.h"
+
+enum ert_cmd_state {
+  ERT_CMD_STATE_NEW = 1,
+  ERT_CMD_STATE_QUEUED = 2,
+  ERT_CMD_STATE_RUNNING = 3,
+  ERT_CMD_STATE_COMPLETED = 4,
+  ERT_CMD_STATE_ERROR = 5,
+  ERT_CMD_STATE_ABORT = 6,
+  ERT_CMD_STATE_SUBMITTED = 7,
+  ERT_CMD_STATE_TIMEOUT = 8,
+  ERT_CMD_STATE_NORESPONSE = 9,
+};
+
+namespace xrt {
+
+class kernel;
+class kernel_impl;
+class run_impl;
+
+// Stand-in for xrt::run.  Started runs are executed in order by the simulated
+// column partition owning the kernel's hw_context.
+class run
+{
+public:
+  run() = default;
+
+  explicit run(const kernel &krnl);
+
+  void
+  start();
+
+  ert_cmd_state
+  wait(const std::chrono::milliseconds &timeout = std::chrono::milliseconds{0}) const;
+
+  void
+  wait2() const;
+
+  ert_cmd_state
+  state() const;
+
+  void
+  set_arg(int index, const bo &bo);
+
+  template <typename ArgType>
+  std::enable_if_t<std::is_arithmetic_v<ArgType>>
+  set_arg(int index, ArgType value)
+  {
+    set_scalar_arg(index, static_cast<uint64_t>(value));
+  }
+
+  void
+  set_arg(int index, std::nullptr_t)
+  {
+    set_scalar_arg(index, 0);
+  }
+
+  std::shared_ptr<run_impl>
+  get_handle() const
+  {
+    return m_impl;
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+private:
+  void
+  set_scalar_arg(int index, uint64_t value);
+
+  std::shared_ptr<run_impl> m_impl;
+};
+
+// Stand-in for xrt::kernel.  Group ids are the argument index.
+class kernel
+{
+public:
+  kernel() = default;
+
+  kernel(const hw_context &ctx, const std::string &name);
+
+  int
+  group_id(int argno) const
+  {
+    return argno;
+  }
+
+  template <typename... Args>
+  run
+  operator()(Args&&... args)
+  {
+    run r(*this);
+    set_args(r, 0, std::forward<Args>(args)...);
+    r.start();
+    return r;
+  }
+
+  hw_context
+  get_hw_context() const;
+
+  std::string
+  get_name() const;
+
+  std::shared_ptr<kernel_impl>
+  get_handle() const
+  {
+    return m_impl;
+  }
+
+  explicit operator bool() const
+  {
+    return m_impl != nullptr;
+  }
+
+protected:
+  std::shared_ptr<kernel_impl> m_impl;
+
+private:
+  static void
+  set_args(run&, int)
+  {}
+
+  template <typename Arg, typename... Args>
+  static void
+  set_args(run &r, int index, Arg &&arg, Args&&... args)
+  {
+    r.set_arg(index, std::forward<Arg>(arg));
+    set_args(r, index + 1, std::forward<Args>(args)...);
+  }
+};
+
+} // namespace xrt
+
+#endif
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef VTD_MOCK_XRT_UUID_H
+#define VTD_MOCK_XRT_UUID_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace xrt {
+
+class uuid
+{
+public:
+  uuid() : m_bytes{} {}
+
+  explicit uuid(const std::array<uint8_t, 16> &bytes) : m_bytes(bytes) {}
+
+  std::string
+  to_string() const
+  {
+    static const char digits[] = "0123456789abcdef";
+    std::string str;
+    for (size_t i = 0; i < m_bytes.size(); i++) {
+      if (i == 4 || i == 6 || i == 8 || i == 10)
+        str += '-';
+      str += digits[m_bytes[i] >> 4];
+      str += digits[m_bytes[i] & 0xf];
+    }
+    return str;
+  }
+
+  bool
+  operator==(const uuid &other) const
+  {
+    return m_bytes == other.m_bytes;
+  }
+
+  bool
+  operator!=(const uuid &other) const
+  {
+    return m_bytes != other.m_bytes;
+  }
+
+  bool
+  operator<(const uuid &other) const
+  {
+    return m_bytes < other.m_bytes;
+  }
+
+  explicit operator bool() const
+  {
+    return m_bytes != std::array<uint8_t, 16>{};
+  }
+
+private:
+  std::array<uint8_t, 16> m_bytes;
+};
+
+} // namespace xrt
+
+#endif
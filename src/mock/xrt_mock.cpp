@@ -0,0 +1,1276 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Simulated NPU behind the subset of the XRT API used by the host
+ * applications.  It lets the scheduling and reporting logic of the apps run on
+ * machines without an NPU.  The model is deliberately simple:
+ *
+ * - The device has VTD_MOCK_COLUMNS columns (default 8).  Each hw_context
+ *   claims VTD_MOCK_CONTEXT_COLUMNS contiguous columns (default 4), first fit.
+ *   A context that does not fit shares the least used partition of the same
+ *   width, and runs of contexts sharing a partition are serialized.  A run
+ *   whose context differs from the previous run on the partition first pays
+ *   VTD_MOCK_SWITCH_US (default 30) for the context switch.
+ * - Every run costs VTD_MOCK_LATENCY_US (default 20) plus the time to move its
+ *   data at VTD_MOCK_SHIM_GBPS per column and direction (default 7).
+ * - Transaction format sequences additionally pay VTD_MOCK_TCT_US (default 2)
+ *   per TCT sync op.  With a BO in argument 4 every token is recorded there
+ *   like the host_hal record timers: an entry count, then {column, AIE timer}
+ *   pairs from the third word on.
+ * - Other opcode 1 sequences are GEMM runs: every core of the partition takes
+ *   VTD_MOCK_GEMM_CYCLES (default 229) AIE cycles, +-5% jitter.  Like the
+ *   device firmware, which writes profile results to a cacheable BO the host
+ *   allocated but never passes to the run, the mock picks the most recent
+ *   cacheable BO of 4K or more on the device that no run has as an argument
+ *   and writes the host_hal layout there: one record timer entry per core
+ *   and the cycle counts from offset 3K on.
+ * - DF loopback runs really copy the input BO to the output BO, opcode 1 uses
+ *   argument 1 -> 3 and opcode 3 (ELF flow) uses argument 3 -> 5.  The copy
+ *   stands in for the data movement; when it is slower than the modeled DMA
+ *   the other costs of the run are paid after it, the excess shows up as
+ *   overshoot in the VTD_MOCK_REPORT accounting.
+ * - An xclbin whose name contains _4x<N> describes an N column partition,
+ *   others use VTD_MOCK_CONTEXT_COLUMNS.  hw_contexts claim that many columns.
+ * - The power mode selects the AIE clock, VTD_MOCK_CLOCK_MHZ pins it.  All
+ *   costs but the data movement scale with 1500 MHz (the default mode) over
+ *   the clock.  The power mode starts as VTD_MOCK_PMODE and setting it exports
+ *   that variable, so processes started afterwards, like the apps the
+ *   pmode_matrix runner starts, see the mode the way they would on a device.
+ * - The device draws VTD_MOCK_IDLE_W (default 0.5) plus VTD_MOCK_COLUMN_W
+ *   (default 0.75) per column while a run executes on it, the latter growing
+ *   with the cube of the clock.  The energy of the runs of every process is
+ *   summed in a shared memory counter, so one process reads the power another
+ *   one draws.
+ * - The device reports the PCI id VTD_MOCK_DEVICE_ID (default 17f0_10).
+ * - With force preemption enabled every run additionally pays
+ *   VTD_MOCK_PREEMPT_US (default 100) for saving and restoring its context.
+ * - Runs of a kernel whose ELF name contains "reconfig" reconfigure the array
+ *   and pay VTD_MOCK_RECONFIG_US (default 2500) on top.
+ * - VTD_MOCK_JITTER_PCT (default 0) spreads the time of every run uniformly by
+ *   that many percent either way, so the statistics of the apps see noise.
+ * - The last VTD_MOCK_SPIN_US (default 200) of a run are spun rather than
+ *   slept for accuracy, 0 only sleeps which suits machines with few cores.
+ * - With VTD_MOCK_REPORT=1 the accounting of every hw_context is printed to
+ *   stderr when the process exits: the commands run, the modeled device time,
+ *   how far the runs overshot the model and how long the context sat idle
+ *   between commands waiting for the host.  The idle time is the overhead of
+ *   the host application's submission loop.
+ */
+
+#include "xrt/xrt_bo.h"
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_hw_context.h"
+#include "xrt/xrt_kernel.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_ext.h"
+#include "mock_device.h"
+#include "power_modes.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t page_size = 4096;
+
+double
+env_value(const char *name, double dflt)
+{
+  const char *value = std::getenv(name);
+  return value ? std::atof(value) : dflt;
+}
+
+struct mock_config
+{
+  unsigned int columns;
+  unsigned int context_columns;
+  double latency_us;
+  double shim_gbps;
+  double preempt_us;
+  double switch_us;
+  double tct_us;
+  double reconfig_us;
+  double submit_us;
+  double jitter_pct;
+  double spin_us;
+  bool report;
+  double idle_w;
+  double column_w;
+  double gemm_cycles;
+
+  static const mock_config&
+  get()
+  {
+    static const mock_config config = {
+      static_cast<unsigned int>(env_value("VTD_MOCK_COLUMNS", 8)),
+      static_cast<unsigned int>(env_value("VTD_MOCK_CONTEXT_COLUMNS", 4)),
+      env_value("VTD_MOCK_LATENCY_US", 20),
+      env_value("VTD_MOCK_SHIM_GBPS", 7),
+      env_value("VTD_MOCK_PREEMPT_US", 100),
+      env_value("VTD_MOCK_SWITCH_US", 30),
+      env_value("VTD_MOCK_TCT_US", 2),
+      env_value("VTD_MOCK_RECONFIG_US", 2500),
+      env_value("VTD_MOCK_SUBMIT_US", 10),
+      env_value("VTD_MOCK_JITTER_PCT", 0),
+      env_value("VTD_MOCK_SPIN_US", 200),
+      env_value("VTD_MOCK_REPORT", 0) != 0,
+      env_value("VTD_MOCK_IDLE_W", 0.5),
+      env_value("VTD_MOCK_COLUMN_W", 0.75),
+      env_value("VTD_MOCK_GEMM_CYCLES", 229),
+    };
+    return config;
+  }
+};
+
+// Clock the modeled costs are given at
+constexpr double reference_clock_mhz = 1500;
+
+// host_hal results BO: record timer entries, then a cycle count per core from
+// offset 3K on, for the AIE rows of every column
+constexpr size_t results_size = 0x1000;
+constexpr size_t results_cycles_offset = 0x0C00;
+constexpr unsigned int core_rows = 4;
+
+// Power mode a new process starts in
+std::string
+initial_power_mode()
+{
+  auto mode = std::getenv("VTD_MOCK_PMODE");
+  return mode && vtd::pmode_clocks().count(mode) ? mode : "default";
+}
+
+/* Energy in nJ of the runs of all processes, in shared memory so the power
+ * one process draws can be read from another one.  Without shared memory the
+ * counter is private to the process.
+ */
+std::atomic<uint64_t>&
+energy_counter()
+{
+  static std::atomic<uint64_t> local {0};
+  static std::atomic<uint64_t> *counter = [] {
+#ifndef _WIN32
+    auto name = "/dev/shm/vtd_mock_energy_" + std::to_string(getuid());
+    int fd = open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd >= 0) {
+      void *addr = MAP_FAILED;
+      if (ftruncate(fd, page_size) == 0)
+        addr = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (addr != MAP_FAILED)
+        return static_cast<std::atomic<uint64_t>*>(addr);
+    }
+#endif
+    return &local;
+  }();
+  return *counter;
+}
+
+// Partition width encoded in the xclbin name, e.g. validate_npu4_elf_4x2.xclbin
+unsigned int
+xclbin_columns(const std::string &filename)
+{
+  auto base = filename.substr(filename.find_last_of("/\\") + 1);
+  auto pos = base.find("_4x");
+  if (pos != std::string::npos && pos + 3 < base.size() && std::isdigit(static_cast<unsigned char>(base[pos + 3])))
+    return static_cast<unsigned int>(std::atoi(base.c_str() + pos + 3));
+  return mock_config::get().context_columns;
+}
+
+std::array<uint8_t, 16>
+hash_uuid(const std::string &data)
+{
+  std::array<uint8_t, 16> bytes {};
+  uint64_t h1 = std::hash<std::string>{}(data);
+  uint64_t h2 = std::hash<std::string>{}(data + "#");
+  std::memcpy(bytes.data(), &h1, sizeof(h1));
+  std::memcpy(bytes.data() + sizeof(h1), &h2, sizeof(h2));
+  return bytes;
+}
+
+struct tct_sync
+{
+  uint32_t column;
+  uint32_t col_num;
+  uint32_t row_num;
+};
+
+// TCT sync ops of a transaction format sequence, the way the firmware walks
+// it.  Legacy sequences have none.
+std::vector<tct_sync>
+tct_syncs(const uint32_t *words, size_t count)
+{
+  std::vector<tct_sync> syncs;
+  if (count < 4 || words[3] < 16 || words[3] > count * sizeof(uint32_t))
+    return syncs;
+
+  size_t end = words[3] / sizeof(uint32_t);
+  size_t pos = 4;
+  for (uint32_t op = 0; op < words[2] && pos < end; op++) {
+    uint32_t opcode = words[pos] & 0xff;
+    size_t size;
+    if (opcode == 0x00)
+      size = 6;
+    else if (opcode == 0x03 || opcode == 0x04)
+      size = 7;
+    else if ((opcode == 0x01 && pos + 3 < end) || (opcode >= 0x80 && pos + 1 < end))
+      size = words[pos + (opcode == 0x01 ? 3 : 1)] / sizeof(uint32_t);
+    else
+      return {};
+    if (size < 2 || pos + size > end)
+      return {};
+
+    if (opcode == 0x80 && size >= 4) {
+      syncs.push_back({(words[pos + 2] >> 16) & 0xff, std::max((words[pos + 3] >> 16) & 0xff, 1u),
+                       std::max((words[pos + 3] >> 8) & 0xff, 1u)});
+    }
+    pos += size;
+  }
+  return syncs;
+}
+
+// Sleep for the bulk of the wait and spin for the rest, plain sleeps overshoot
+// by tens of microseconds which is the scale of a single command
+void
+wait_until(std::chrono::steady_clock::time_point deadline)
+{
+  auto spin = std::chrono::nanoseconds(static_cast<int64_t>(mock_config::get().spin_us * 1e3));
+  auto now = std::chrono::steady_clock::now();
+  if (deadline - now > spin)
+    std::this_thread::sleep_until(deadline - spin);
+  while (std::chrono::steady_clock::now() < deadline)
+    ;
+}
+
+// Accounting of one hw_context, its worker updates it after every command
+struct context_stats
+{
+  unsigned int id;
+  unsigned int start_col;
+  unsigned int ncol;
+  std::mutex lock;
+  uint64_t commands = 0;
+  double modeled_us = 0;
+  std::chrono::steady_clock::duration busy {0};
+  std::chrono::steady_clock::duration idle {0};
+};
+
+// Keeps the accounting of every hw_context and prints it at exit.  Contexts
+// may be destroyed on their own detached worker, that can race with exit, so
+// the report does not wait for their destructors.
+class stats_report
+{
+public:
+  static stats_report&
+  get()
+  {
+    static stats_report report;
+    return report;
+  }
+
+  std::shared_ptr<context_stats>
+  add(unsigned int start_col, unsigned int ncol)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto stats = std::make_shared<context_stats>();
+    stats->id = static_cast<unsigned int>(m_contexts.size());
+    stats->start_col = start_col;
+    stats->ncol = ncol;
+    m_contexts.push_back(stats);
+    return stats;
+  }
+
+  ~stats_report()
+  {
+    if (!m_enabled)
+      return;
+
+    using ms = std::chrono::duration<double, std::milli>;
+    using us = std::chrono::duration<double, std::micro>;
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::cerr << std::fixed << std::setprecision(3);
+    for (auto &stats : m_contexts) {
+      std::lock_guard<std::mutex> stats_guard(stats->lock);
+      auto n = stats->commands;
+      auto overshoot_us = us(stats->busy).count() - stats->modeled_us;
+      std::cerr << "mock xrt: context " << stats->id << " on columns " << stats->start_col << "-"
+                << stats->start_col + stats->ncol - 1 << ": " << n << " commands, modeled "
+                << stats->modeled_us / 1e3 << " ms, ran " << ms(stats->busy).count() << " ms (+"
+                << (n ? overshoot_us / n : 0.0) << " us per command), idle " << ms(stats->idle).count()
+                << " ms waiting for the host (" << (n > 1 ? us(stats->idle).count() / (n - 1) : 0.0)
+                << " us per command)\n";
+    }
+    std::cerr << std::defaultfloat;
+  }
+
+private:
+  bool m_enabled = mock_config::get().report;
+  std::mutex m_lock;
+  std::vector<std::shared_ptr<context_stats>> m_contexts;
+};
+
+} // namespace
+
+namespace xrt {
+
+class bo_impl;
+
+// Contiguous columns claimed by one or more hw_contexts
+struct partition
+{
+  unsigned int start_col;
+  unsigned int ncol;
+  unsigned int users = 0;
+  std::mutex busy;
+  const void *last_context = nullptr;   // Guarded by busy
+};
+
+class device_impl
+{
+public:
+  static std::shared_ptr<device_impl>
+  open(const std::string &key)
+  {
+    static std::mutex lock;
+    static std::map<std::string, std::weak_ptr<device_impl>> devices;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto impl = devices[key].lock();
+    if (!impl) {
+      impl = std::make_shared<device_impl>(key);
+      devices[key] = impl;
+    }
+    return impl;
+  }
+
+  explicit device_impl(const std::string &bdf)
+    : m_bdf(bdf)
+    , m_pmode(initial_power_mode())
+    , m_power_time(std::chrono::steady_clock::now())
+    , m_power_energy(energy_counter().load())
+  {}
+
+  void
+  register_columns(const uuid &xclbin_id, unsigned int ncol)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_xclbin_columns[xclbin_id] = ncol;
+  }
+
+  unsigned int
+  columns(const uuid &xclbin_id)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_xclbin_columns.find(xclbin_id);
+    return it == m_xclbin_columns.end() ? mock_config::get().context_columns : it->second;
+  }
+
+  std::string
+  power_mode()
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_pmode;
+  }
+
+  void
+  set_power_mode(const std::string &mode)
+  {
+    if (!vtd::pmode_clocks().count(mode))
+      throw std::runtime_error("mock xrt: unknown power mode " + mode);
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_pmode = mode;
+#ifndef _WIN32
+    setenv("VTD_MOCK_PMODE", mode.c_str(), 1);
+#else
+    _putenv_s("VTD_MOCK_PMODE", mode.c_str());
+#endif
+  }
+
+  // Average power since the previous reading, or since the device was opened
+  double
+  power_watts()
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto now = std::chrono::steady_clock::now();
+    uint64_t energy = energy_counter().load();
+    double ns = std::chrono::duration<double, std::nano>(now - m_power_time).count();
+    double watts = mock_config::get().idle_w + (ns > 0 ? (energy - m_power_energy) / ns : 0);
+    m_power_time = now;
+    m_power_energy = energy;
+    return watts;
+  }
+
+  bool
+  force_preemption()
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_force_preemption;
+  }
+
+  void
+  set_force_preemption(bool enable)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_force_preemption = enable;
+  }
+
+  // Cacheable BOs large enough for the GEMM profile results, in allocation order
+  void
+  add_result_bo(const std::shared_ptr<bo_impl> &bo)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_result_bos.erase(std::remove_if(m_result_bos.begin(), m_result_bos.end(),
+                                      [](auto &weak) { return weak.expired(); }),
+                       m_result_bos.end());
+    m_result_bos.push_back(bo);
+  }
+
+  std::vector<std::shared_ptr<bo_impl>>
+  result_bos()
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::vector<std::shared_ptr<bo_impl>> bos;
+    for (auto &weak : m_result_bos) {
+      if (auto bo = weak.lock())
+        bos.push_back(std::move(bo));
+    }
+    return bos;
+  }
+
+  const std::string m_bdf;
+
+  partition*
+  claim(unsigned int ncol)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto columns = mock_config::get().columns;
+
+    // First fit over the unclaimed columns
+    for (unsigned int start = 0; start + ncol <= columns; start++) {
+      bool free = true;
+      for (auto &part : m_partitions)
+        free = free && (start + ncol <= part->start_col || part->start_col + part->ncol <= start);
+      if (!free)
+        continue;
+
+      auto part = std::make_unique<partition>();
+      part->start_col = start;
+      part->ncol = ncol;
+      part->users = 1;
+      m_partitions.push_back(std::move(part));
+      return m_partitions.back().get();
+    }
+
+    // Oversubscribed, time share the least used partition of the same width
+    partition *shared = nullptr;
+    for (auto &part : m_partitions) {
+      if (part->ncol == ncol && (!shared || part->users < shared->users))
+        shared = part.get();
+    }
+    if (!shared)
+      throw std::runtime_error("mock xrt: no " + std::to_string(ncol) + " column partition available");
+
+    shared->users++;
+    return shared;
+  }
+
+  void
+  release(partition *part)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (--part->users)
+      return;
+
+    for (auto it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+      if (it->get() == part) {
+        m_partitions.erase(it);
+        return;
+      }
+    }
+  }
+
+private:
+  std::mutex m_lock;
+  std::vector<std::unique_ptr<partition>> m_partitions;
+  std::map<uuid, unsigned int> m_xclbin_columns;
+  std::string m_pmode;
+  bool m_force_preemption = false;
+  std::chrono::steady_clock::time_point m_power_time;
+  uint64_t m_power_energy;
+  std::vector<std::weak_ptr<bo_impl>> m_result_bos;
+};
+
+class xclbin_impl
+{
+public:
+  uuid m_uuid;
+  std::vector<xclbin::kernel> m_kernels;
+  aie_partition m_partition {};
+};
+
+// Buffers start zeroed like driver allocated memory, pages are only
+// populated when first touched.  User pointer buffers use the caller's memory
+// and sub-buffers their parent's.
+class bo_impl
+{
+public:
+  bo_impl(std::shared_ptr<bo_impl> parent, size_t size, size_t offset)
+    : m_data(static_cast<char*>(parent->m_data) + offset)
+    , m_size(size)
+    , m_alloc(0)
+    , m_parent(std::move(parent))
+  {
+    if (size + offset > m_parent->m_size)
+      throw std::runtime_error("mock xrt: sub-buffer out of range");
+  }
+
+  bo_impl(void *userptr, size_t size)
+    : m_data(userptr)
+    , m_size(size)
+    , m_alloc(0)
+  {
+    if (reinterpret_cast<uintptr_t>(userptr) % page_size)
+      throw std::runtime_error("mock xrt: user pointer is not page aligned");
+  }
+
+  explicit bo_impl(size_t size)
+    : m_size(size)
+    , m_alloc(((size ? size : 1) + page_size - 1) / page_size * page_size)
+  {
+#ifndef _WIN32
+    m_data = mmap(nullptr, m_alloc, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_data == MAP_FAILED)
+      throw std::bad_alloc();
+#else
+    m_data = std::aligned_alloc(page_size, m_alloc);
+    if (!m_data)
+      throw std::bad_alloc();
+    std::memset(m_data, 0, m_alloc);
+#endif
+  }
+
+  ~bo_impl()
+  {
+    if (!m_alloc)
+      return;
+#ifndef _WIN32
+    munmap(m_data, m_alloc);
+#else
+    std::free(m_data);
+#endif
+  }
+
+  void *m_data;
+  size_t m_size;
+  size_t m_alloc;
+  std::shared_ptr<bo_impl> m_parent;
+  std::atomic<bool> m_bound {false};     // Set as the argument of a run
+};
+
+class kernel_impl
+{
+public:
+  hw_context m_ctx;
+  std::string m_name;
+  bool m_reconfig = false;               // ELF reconfigures the array
+};
+
+class run_impl
+{
+public:
+  struct arg
+  {
+    bo m_bo;
+    uint64_t m_value = 0;
+  };
+
+  // Returns the modeled time of the run in microseconds, 'scale' is its jitter
+  double
+  execute(const partition &part, bool preempted, bool switched, double scale)
+  {
+    auto &config = mock_config::get();
+    auto begin = std::chrono::steady_clock::now();
+
+    size_t bytes = 0;
+    auto opcode = m_args.count(0) ? m_args[0].m_value : 0;
+    int in_idx = opcode == 3 ? 3 : 1;
+    int out_idx = opcode == 3 ? 5 : 3;
+    auto in = m_args.count(in_idx) ? m_args[in_idx].m_bo : bo();
+    auto out = m_args.count(out_idx) ? m_args[out_idx].m_bo : bo();
+    if (in && out) {
+      bytes = std::min(in.size(), out.size());
+      std::memcpy(out.map<void*>(), in.map<void*>(), bytes);
+    }
+
+    std::vector<tct_sync> syncs;
+    auto instr = m_args.count(5) ? m_args[5].m_bo : bo();
+    if (opcode != 3 && instr)
+      syncs = tct_syncs(instr.map<const uint32_t*>(), std::min<size_t>(m_args[6].m_value, instr.size() / 4));
+
+    // Commands chained behind another one skip the submission part of the
+    // command latency.  Everything but the data movement runs at the clock.
+    auto device = m_kernel.get_hw_context().get_device();
+    double clock_mhz = vtd_mock::aie_clock_mhz(device);
+    double clock_scale = reference_clock_mhz / clock_mhz;
+    double us = m_chained ? std::max(0.0, config.latency_us - config.submit_us) : config.latency_us;
+    if (preempted)
+      us += config.preempt_us;
+    if (switched)
+      us += config.switch_us;
+    if (m_kernel.get_handle()->m_reconfig)
+      us += config.reconfig_us;
+    us *= clock_scale;
+    double dma_us = bytes / (config.shim_gbps * 1e3 * part.ncol);
+
+    // The real copy stands in for the data movement.  When it takes longer
+    // than the modeled DMA the other costs start after it rather than being
+    // absorbed by it, so they stay visible to the apps.
+    auto dma_end = std::max(std::chrono::steady_clock::now(),
+                            begin + std::chrono::nanoseconds(static_cast<int64_t>(dma_us * scale * 1e3)));
+    auto after_dma = [&dma_end](double us) {
+      return dma_end + std::chrono::nanoseconds(static_cast<int64_t>(us * 1e3));
+    };
+
+    auto debug = m_args.count(4) ? m_args[4].m_bo : bo();
+    if (debug && !syncs.empty())
+      record_tokens(debug, syncs, after_dma(us), clock_scale);
+    else if (opcode == 1 && instr && syncs.empty()) {
+      if (auto results = result_bo(device))
+        us += record_cycles(*results, part, after_dma(us), clock_mhz);
+    }
+    us += syncs.size() * config.tct_us * clock_scale;
+    wait_until(after_dma(us * scale));
+    us = (us + dma_us) * scale;
+
+    // The columns draw their active power for the modeled time, W * ns is nJ
+    double watts = config.column_w * part.ncol * std::pow(clock_mhz / reference_clock_mhz, 3);
+    energy_counter() += static_cast<uint64_t>(watts * us * 1e3);
+    return us;
+  }
+
+  // Sync op s completes tct_us, scaled to the clock, after the previous one
+  // with +-10% jitter, all of its tokens arrive then
+  void
+  record_tokens(bo &debug, const std::vector<tct_sync> &syncs, std::chrono::steady_clock::time_point first,
+                double clock_scale)
+  {
+    auto &config = mock_config::get();
+    double ticks_per_ns = vtd_mock::aie_clock_mhz(m_kernel.get_hw_context().get_device()) / 1e3;
+    double ns = std::chrono::duration<double, std::nano>(first.time_since_epoch()).count();
+
+    auto words = debug.map<uint32_t*>();
+    uint32_t capacity = static_cast<uint32_t>(debug.size() / (2 * sizeof(uint32_t))) - 1;
+    uint32_t count = 0;
+    for (auto &sync : syncs) {
+      m_jitter = m_jitter * 6364136223846793005ULL + 1442695040888963407ULL;
+      ns += config.tct_us * clock_scale * 1e3 * (0.9 + 0.2 * static_cast<double>(m_jitter >> 11) / (1ULL << 53));
+      for (uint32_t t = 0; t < sync.col_num * sync.row_num && count < capacity; t++, count++) {
+        words[2 + 2 * count] = sync.column + t % sync.col_num;
+        words[3 + 2 * count] = static_cast<uint32_t>(static_cast<uint64_t>(ns * ticks_per_ns));
+      }
+    }
+    words[0] = count;
+  }
+
+  // Where the firmware puts the GEMM profile results: the latest cacheable BO
+  // of the results size that was never the argument of a run
+  static std::shared_ptr<bo_impl>
+  result_bo(const device &device)
+  {
+    auto bos = device.get_handle()->result_bos();
+    auto it = std::find_if(bos.rbegin(), bos.rend(), [](auto &bo) { return !bo->m_bound; });
+    return it == bos.rend() ? nullptr : *it;
+  }
+
+  // Every core of the partition runs the GEMM for gemm_cycles +-5% and records
+  // its ID and end time, returns the time of the slowest core in microseconds
+  double
+  record_cycles(bo_impl &results, const partition &part, std::chrono::steady_clock::time_point start,
+                double clock_mhz)
+  {
+    auto &config = mock_config::get();
+    double ns = std::chrono::duration<double, std::nano>(start.time_since_epoch()).count();
+    uint64_t start_ticks = static_cast<uint64_t>(ns * clock_mhz / 1e3);
+
+    auto words = static_cast<uint32_t*>(results.m_data);
+    auto cycles = words + results_cycles_offset / sizeof(uint32_t);
+    uint32_t cores = part.ncol * core_rows;
+    uint32_t slowest = 0;
+    for (uint32_t c = 0; c < cores; c++) {
+      m_jitter = m_jitter * 6364136223846793005ULL + 1442695040888963407ULL;
+      cycles[c] = static_cast<uint32_t>(config.gemm_cycles
+                                        * (0.95 + 0.1 * static_cast<double>(m_jitter >> 11) / (1ULL << 53)));
+      cycles[c] = std::max<uint32_t>(cycles[c], 1);
+      words[2 + 2 * c] = c;
+      words[3 + 2 * c] = static_cast<uint32_t>(start_ticks + cycles[c]);
+      slowest = std::max(slowest, cycles[c]);
+    }
+    words[0] = cores;
+    return slowest / clock_mhz;
+  }
+
+  void
+  complete(ert_cmd_state state)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_state = state;
+    m_done.notify_all();
+  }
+
+  kernel m_kernel;
+  std::map<int, arg> m_args;
+  ert_cmd_state m_state = ERT_CMD_STATE_NEW;
+  bool m_chained = false;
+  uint64_t m_jitter = 1;
+  std::mutex m_lock;
+  std::condition_variable m_done;
+};
+
+class hw_context_impl
+{
+public:
+  hw_context_impl(const device &device, const uuid &xclbin_id)
+    : m_device(device)
+    , m_uuid(xclbin_id)
+    , m_partition(device.get_handle()->claim(device.get_handle()->columns(xclbin_id)))
+    , m_stats(stats_report::get().add(m_partition->start_col, m_partition->ncol))
+    , m_worker(&hw_context_impl::worker, this)
+  {}
+
+  ~hw_context_impl()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_stop = true;
+      m_cond.notify_all();
+    }
+
+    // The worker may drop the last reference to its own context, it must not
+    // touch the context after that
+    if (m_worker.get_id() == std::this_thread::get_id()) {
+      *m_destroyed = true;
+      m_worker.detach();
+    }
+    else
+      m_worker.join();
+    m_device.get_handle()->release(m_partition);
+  }
+
+  void
+  submit(std::shared_ptr<run_impl> run)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_queue.push_back(std::move(run));
+    m_cond.notify_all();
+  }
+
+  // The runs of a chain are queued together with one wakeup
+  void
+  submit(const std::vector<std::shared_ptr<run_impl>> &runs)
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_queue.insert(m_queue.end(), runs.begin(), runs.end());
+    m_cond.notify_all();
+  }
+
+  device m_device;
+  uuid m_uuid;
+
+private:
+  // Uniform factor within +-VTD_MOCK_JITTER_PCT
+  double
+  jitter()
+  {
+    auto pct = mock_config::get().jitter_pct;
+    if (pct <= 0)
+      return 1;
+    m_jitter = m_jitter * 6364136223846793005ULL + 1442695040888963407ULL;
+    return 1 + pct / 100 * (2 * static_cast<double>(m_jitter >> 11) / (1ULL << 53) - 1);
+  }
+
+  void
+  worker()
+  {
+    bool destroyed = false;
+    m_destroyed = &destroyed;
+    m_jitter = m_stats->id + 1;
+
+    while (true) {
+      std::shared_ptr<run_impl> run;
+      {
+        // Time without queued commands after the first one counts as idle,
+        // the device waits for the host then
+        std::unique_lock<std::mutex> guard(m_lock);
+        auto wait_start = std::chrono::steady_clock::now();
+        bool starved = m_queue.empty() && m_started;
+        m_cond.wait(guard, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+          return;
+        if (starved) {
+          std::lock_guard<std::mutex> stats_guard(m_stats->lock);
+          m_stats->idle += std::chrono::steady_clock::now() - wait_start;
+        }
+        run = std::move(m_queue.front());
+        m_queue.pop_front();
+      }
+
+      run->complete(ERT_CMD_STATE_RUNNING);
+      {
+        // Contexts time sharing a partition execute one command at a time
+        std::lock_guard<std::mutex> busy(m_partition->busy);
+        bool switched = m_partition->last_context && m_partition->last_context != this;
+        m_partition->last_context = this;
+        auto begin = std::chrono::steady_clock::now();
+        auto modeled_us = run->execute(*m_partition, m_device.get_handle()->force_preemption(), switched, jitter());
+        std::lock_guard<std::mutex> stats_guard(m_stats->lock);
+        m_stats->busy += std::chrono::steady_clock::now() - begin;
+        m_stats->modeled_us += modeled_us;
+        m_stats->commands++;
+        m_started = true;
+      }
+      run->complete(ERT_CMD_STATE_COMPLETED);
+      run.reset();
+      if (destroyed)
+        return;
+    }
+  }
+
+  partition *m_partition;
+  std::shared_ptr<context_stats> m_stats;
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  std::deque<std::shared_ptr<run_impl>> m_queue;
+  bool m_stop = false;
+  bool m_started = false;                // Worker state
+  uint64_t m_jitter = 1;
+
+  bool *m_destroyed = nullptr;
+  std::thread m_worker;
+};
+
+xclbin::
+xclbin(const std::string &filename)
+  : m_impl(std::make_shared<xclbin_impl>())
+{
+  std::ifstream ifs(filename, std::ios::binary);
+  std::string data = filename;
+  if (ifs.is_open())
+    data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+  m_impl->m_uuid = uuid(hash_uuid(data));
+  m_impl->m_kernels.emplace_back("DPU");
+  m_impl->m_partition.info.column_width = static_cast<uint16_t>(xclbin_columns(filename));
+}
+
+const void*
+xclbin::
+get_section(axlf_section_kind kind) const
+{
+  return kind == AIE_PARTITION ? &m_impl->m_partition : nullptr;
+}
+
+std::vector<xclbin::kernel>
+xclbin::
+get_kernels() const
+{
+  return m_impl->m_kernels;
+}
+
+uuid
+xclbin::
+get_uuid() const
+{
+  return m_impl->m_uuid;
+}
+
+device::
+device(unsigned int index)
+  : m_impl(device_impl::open("0000:00:01." + std::to_string(index)))
+{}
+
+device::
+device(const std::string &bdf)
+  : m_impl(device_impl::open(bdf))
+{}
+
+uuid
+device::
+register_xclbin(const xclbin &xclbin)
+{
+  auto partition = xclbin.get_axlf_section<const aie_partition*>(AIE_PARTITION);
+  m_impl->register_columns(xclbin.get_uuid(), partition->info.column_width);
+  return xclbin.get_uuid();
+}
+
+std::string
+device::
+get_info_string(info::device param) const
+{
+  return param == info::device::bdf ? m_impl->m_bdf : "NPU Mock";
+}
+
+hw_context::
+hw_context(const device &device, const uuid &xclbin_id, const qos_type&)
+  : m_impl(std::make_shared<hw_context_impl>(device, xclbin_id))
+{}
+
+hw_context::
+hw_context(const device &device, const uuid &xclbin_id, access_mode)
+  : m_impl(std::make_shared<hw_context_impl>(device, xclbin_id))
+{}
+
+hw_context::
+hw_context(const device &device, const uuid &xclbin_id)
+  : m_impl(std::make_shared<hw_context_impl>(device, xclbin_id))
+{}
+
+hw_context::
+hw_context(const device &device, const elf &program)
+  : m_impl(std::make_shared<hw_context_impl>(device, uuid(hash_uuid(program.get_filename()))))
+{}
+
+device
+hw_context::
+get_device() const
+{
+  return m_impl->m_device;
+}
+
+uuid
+hw_context::
+get_xclbin_uuid() const
+{
+  return m_impl->m_uuid;
+}
+
+bo::
+bo(const device &device, size_t size, xrtBufferFlags flags, xrtMemoryGroup)
+  : m_impl(std::make_shared<bo_impl>(size))
+{
+  if ((flags & XCL_BO_FLAGS_CACHEABLE) && size >= results_size)
+    device.get_handle()->add_result_bo(m_impl);
+}
+
+bo::
+bo(const hw_context &ctx, size_t size, xrtBufferFlags flags, xrtMemoryGroup group)
+  : bo(ctx.get_device(), size, flags, group)
+{}
+
+bo::
+bo(const device&, void *userptr, size_t size, xrtMemoryGroup)
+  : m_impl(std::make_shared<bo_impl>(userptr, size))
+{}
+
+bo::
+bo(const bo &parent, size_t size, size_t offset)
+  : m_impl(std::make_shared<bo_impl>(parent.m_impl, size, offset))
+{}
+
+void*
+bo::
+map_address()
+{
+  return m_impl->m_data;
+}
+
+void
+bo::
+sync(xclBOSyncDirection, size_t size, size_t offset)
+{
+  if (size + offset > m_impl->m_size)
+    throw std::runtime_error("mock xrt: bo sync out of range");
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void
+bo::
+write(const void *src, size_t size, size_t seek)
+{
+  if (size + seek > m_impl->m_size)
+    throw std::runtime_error("mock xrt: bo write out of range");
+  std::memcpy(static_cast<char*>(m_impl->m_data) + seek, src, size);
+}
+
+void
+bo::
+read(void *dst, size_t size, size_t skip)
+{
+  if (size + skip > m_impl->m_size)
+    throw std::runtime_error("mock xrt: bo read out of range");
+  std::memcpy(dst, static_cast<const char*>(m_impl->m_data) + skip, size);
+}
+
+size_t
+bo::
+size() const
+{
+  return m_impl->m_size;
+}
+
+uint64_t
+bo::
+address() const
+{
+  return reinterpret_cast<uint64_t>(m_impl->m_data);
+}
+
+kernel::
+kernel(const hw_context &ctx, const std::string &name)
+  : m_impl(std::make_shared<kernel_impl>())
+{
+  m_impl->m_ctx = ctx;
+  m_impl->m_name = name;
+}
+
+hw_context
+kernel::
+get_hw_context() const
+{
+  return m_impl->m_ctx;
+}
+
+std::string
+kernel::
+get_name() const
+{
+  return m_impl->m_name;
+}
+
+ext::kernel::
+kernel(const hw_context &ctx, const module &mod, const std::string &name)
+  : xrt::kernel(ctx, name)
+{
+  auto elf = std::filesystem::path(mod.get_elf().get_filename()).filename().string();
+  get_handle()->m_reconfig = elf.find("reconfig") != std::string::npos;
+}
+
+ext::kernel::
+kernel(const hw_context &ctx, const std::string &name)
+  : xrt::kernel(ctx, name)
+{}
+
+run::
+run(const kernel &krnl)
+  : m_impl(std::make_shared<run_impl>())
+{
+  m_impl->m_kernel = krnl;
+}
+
+void
+run::
+start()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_impl->m_lock);
+    if (m_impl->m_state == ERT_CMD_STATE_QUEUED || m_impl->m_state == ERT_CMD_STATE_RUNNING)
+      throw std::runtime_error("mock xrt: run started while in flight");
+    m_impl->m_state = ERT_CMD_STATE_QUEUED;
+    m_impl->m_chained = false;
+  }
+  m_impl->m_kernel.get_hw_context().get_handle()->submit(m_impl);
+}
+
+ert_cmd_state
+run::
+wait(const std::chrono::milliseconds &timeout) const
+{
+  std::unique_lock<std::mutex> guard(m_impl->m_lock);
+  auto done = [this] {
+    return m_impl->m_state != ERT_CMD_STATE_QUEUED && m_impl->m_state != ERT_CMD_STATE_RUNNING;
+  };
+  if (timeout.count() == 0)
+    m_impl->m_done.wait(guard, done);
+  else if (!m_impl->m_done.wait_for(guard, timeout, done))
+    return ERT_CMD_STATE_TIMEOUT;
+  return m_impl->m_state;
+}
+
+void
+run::
+wait2() const
+{
+  auto state = wait();
+  if (state != ERT_CMD_STATE_COMPLETED)
+    throw std::runtime_error("mock xrt: run failed with state " + std::to_string(state));
+}
+
+ert_cmd_state
+run::
+state() const
+{
+  std::lock_guard<std::mutex> guard(m_impl->m_lock);
+  return m_impl->m_state;
+}
+
+void
+run::
+set_arg(int index, const bo &bo)
+{
+  if (bo.get_handle())
+    bo.get_handle()->m_bound = true;
+  m_impl->m_args[index].m_bo = bo;
+}
+
+void
+run::
+set_scalar_arg(int index, uint64_t value)
+{
+  m_impl->m_args[index].m_value = value;
+}
+
+class runlist_impl
+{
+public:
+  hw_context m_hwctx;
+  std::vector<run> m_runs;
+  bool m_executed = false;
+};
+
+runlist::
+runlist(const hw_context &hwctx)
+  : m_impl(std::make_shared<runlist_impl>())
+{
+  m_impl->m_hwctx = hwctx;
+}
+
+void
+runlist::
+add(const run &run)
+{
+  if (m_impl->m_executed && state() != ERT_CMD_STATE_COMPLETED)
+    throw std::runtime_error("mock xrt: run added to a runlist in flight");
+  if (run.get_handle()->m_kernel.get_hw_context().get_handle() != m_impl->m_hwctx.get_handle())
+    throw std::runtime_error("mock xrt: run added to a runlist of another hw_context");
+  m_impl->m_runs.push_back(run);
+}
+
+void
+runlist::
+execute()
+{
+  if (m_impl->m_runs.empty())
+    return;
+
+  std::vector<std::shared_ptr<run_impl>> runs;
+  for (auto &r : m_impl->m_runs) {
+    auto impl = r.get_handle();
+    std::lock_guard<std::mutex> guard(impl->m_lock);
+    if (impl->m_state == ERT_CMD_STATE_QUEUED || impl->m_state == ERT_CMD_STATE_RUNNING)
+      throw std::runtime_error("mock xrt: runlist executed while in flight");
+    impl->m_state = ERT_CMD_STATE_QUEUED;
+    impl->m_chained = !runs.empty();
+    runs.push_back(impl);
+  }
+  m_impl->m_executed = true;
+  m_impl->m_hwctx.get_handle()->submit(runs);
+}
+
+void
+runlist::
+wait() const
+{
+  if (wait(std::chrono::milliseconds{0}) == std::cv_status::timeout)
+    throw std::runtime_error("mock xrt: runlist timed out");
+}
+
+std::cv_status
+runlist::
+wait(const std::chrono::milliseconds &timeout) const
+{
+  if (m_impl->m_runs.empty())
+    return std::cv_status::no_timeout;
+
+  // Runs of a chain complete in order, the last one completes the list
+  auto state = m_impl->m_runs.back().wait(timeout);
+  if (state == ERT_CMD_STATE_TIMEOUT)
+    return std::cv_status::timeout;
+  for (auto &r : m_impl->m_runs) {
+    if (r.state() != ERT_CMD_STATE_COMPLETED)
+      throw std::runtime_error("mock xrt: runlist failed with state " + std::to_string(r.state()));
+  }
+  return std::cv_status::no_timeout;
+}
+
+ert_cmd_state
+runlist::
+state() const
+{
+  return m_impl->m_runs.empty() ? ERT_CMD_STATE_NEW : m_impl->m_runs.back().state();
+}
+
+void
+runlist::
+reset()
+{
+  if (m_impl->m_executed && state() != ERT_CMD_STATE_COMPLETED)
+    throw std::runtime_error("mock xrt: runlist reset while in flight");
+  m_impl->m_runs.clear();
+  m_impl->m_executed = false;
+}
+
+} // namespace xrt
+
+namespace vtd_mock {
+
+std::string
+device_id(const xrt::device &)
+{
+  auto id = std::getenv("VTD_MOCK_DEVICE_ID");
+  return id ? id : "17f0_10";
+}
+
+unsigned int
+aie_clock_mhz(const xrt::device &device)
+{
+  if (std::getenv("VTD_MOCK_CLOCK_MHZ"))
+    return static_cast<unsigned int>(env_value("VTD_MOCK_CLOCK_MHZ", 0));
+  return vtd::pmode_clocks().at(device.get_handle()->power_mode());
+}
+
+std::string
+power_mode(const xrt::device &device)
+{
+  return device.get_handle()->power_mode();
+}
+
+void
+set_power_mode(const xrt::device &device, const std::string &mode)
+{
+  device.get_handle()->set_power_mode(mode);
+}
+
+void
+set_force_preemption(const xrt::device &device, bool enable)
+{
+  device.get_handle()->set_force_preemption(enable);
+}
+
+double
+power_watts(const xrt::device &device)
+{
+  return device.get_handle()->power_watts();
+}
+
+} // namespace vtd_mock
@@ -0,0 +1,484 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application runs host tests under every power mode, e.g.
+ *
+ *   pmode_matrix --pmodes default,performance,turbo --tests matrix.txt
+ *   pmode_matrix -- ./tct_tp ../xclbin_prod/validate.xclbin sequences/tct_1col.txt 0
+ *
+ * The tests file holds one command line per test, blank lines and lines
+ * starting with # are skipped.  Every test must accept --results-json, which
+ * pmode_matrix appends.  For each mode the device is switched through its
+ * vtd::device_control, given --settle-ms to settle, and every test runs with
+ * its output in --log-dir.  While a test runs the AIE clock and the power draw
+ * are read every --interval-ms, whichever of them the device reports.
+ *
+ * Reported per mode and result are the value, the mean clock and power, the
+ * value per watt for throughput results, and how value, power and value per
+ * watt compare with the first mode of the list.  That is the cost of a mode
+ * like turbo against what it buys.  --results-json <prefix> writes the
+ * results of every mode to <prefix>_<pmode>.json for bench_compare, with the
+ * power draw of every test (<app>-power, e.g. tct_tp-power) and the
+ * throughput per watt of every result (<result>-per-watt) next to them.  The
+ * power mode the device was in is restored at the end.
+ *
+ * VTD_DEVICE_CONTROL=stub keeps the power mode local, see device_control.h.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+#include "device_control.h"
+#include "power_modes.h"
+#include "results.h"
+#include "sample_stats.h"
+
+struct matrix_test
+{
+  std::string name;
+  std::string command;
+};
+
+// Telemetry of one test run, means over the samples taken
+struct telemetry
+{
+  std::vector<double> clock_mhz;
+  std::vector<double> power_w;
+};
+
+// One result of one test under one mode
+struct matrix_cell
+{
+  std::string pmode;
+  std::string test;
+  std::string metric;
+  std::string unit;
+  double value = 0;
+  double noise_pct = 0;
+  double clock_mhz = 0;                  // 0 when not reported
+  double power_w = 0;
+};
+
+/* Reads the clock and the power draw every 'interval' until stopped.  A
+ * reading the device does not support is not tried again.
+ */
+class telemetry_sampler
+{
+public:
+  telemetry_sampler(vtd::device_control &control, std::chrono::milliseconds interval, bool &has_clock,
+                    bool &has_power)
+    : m_control(control)
+    , m_interval(interval)
+    , m_has_clock(has_clock)
+    , m_has_power(has_power)
+  {
+    // Power is averaged between readings, the first one starts the window
+    read_clock();
+    read_power();
+    m_data.power_w.clear();
+    m_thread = std::thread(&telemetry_sampler::loop, this);
+  }
+
+  ~telemetry_sampler()
+  {
+    if (m_thread.joinable())
+      stop();
+  }
+
+  telemetry
+  stop()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_stop = true;
+      m_cond.notify_all();
+    }
+    m_thread.join();
+
+    // The window since the last reading ends with the test
+    read_power();
+    return m_data;
+  }
+
+private:
+  void
+  loop()
+  {
+    std::unique_lock<std::mutex> guard(m_lock);
+    while (!m_cond.wait_for(guard, m_interval, [this] { return m_stop; })) {
+      guard.unlock();
+      read_clock();
+      read_power();
+      guard.lock();
+    }
+  }
+
+  void
+  read_clock()
+  {
+    if (!m_has_clock)
+      return;
+    try {
+      m_data.clock_mhz.push_back(m_control.aie_clock_mhz());
+    }
+    catch (const std::exception&) {
+      m_has_clock = false;
+    }
+  }
+
+  void
+  read_power()
+  {
+    if (!m_has_power)
+      return;
+    try {
+      m_data.power_w.push_back(m_control.power_watts());
+    }
+    catch (const std::exception&) {
+      m_has_power = false;
+    }
+  }
+
+  vtd::device_control &m_control;
+  std::chrono::milliseconds m_interval;
+  bool &m_has_clock;
+  bool &m_has_power;
+  telemetry m_data;
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  bool m_stop = false;
+  std::thread m_thread;                  // Last, starts once the rest is set up
+};
+
+// Tests named after their executable, numbered when repeated
+std::vector<matrix_test>
+name_tests(const std::vector<std::string> &commands)
+{
+  std::vector<matrix_test> tests;
+  std::map<std::string, int> seen;
+  for (auto &command : commands) {
+    auto name = std::filesystem::path(command.substr(0, command.find(' '))).filename().string();
+    if (seen[name]++)
+      name += "-" + std::to_string(seen[name]);
+    tests.push_back({name, command});
+  }
+  return tests;
+}
+
+// Tests of a file of command lines
+std::vector<matrix_test>
+load_tests(const std::string &fname)
+{
+  std::ifstream ifs(fname);
+  if (!ifs.is_open())
+    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
+
+  std::vector<std::string> commands;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#')
+      continue;
+    commands.push_back(line.substr(first, line.find_last_not_of(" \t\r") + 1 - first));
+  }
+  return name_tests(commands);
+}
+
+double
+mean(const std::vector<double> &values)
+{
+  return values.empty() ? 0 : vtd::summarize_samples(values).mean;
+}
+
+// Throughput per watt, 0 for latencies or without power readings
+double
+per_watt(const matrix_cell &cell)
+{
+  return !vtd::lower_is_better(cell.metric) && cell.power_w > 0 ? cell.value / cell.power_w : 0;
+}
+
+std::string
+known_pmodes()
+{
+  std::string modes;
+  for (auto &mode : vtd::pmode_clocks())
+    modes += (modes.empty() ? "" : ", ") + mode.first;
+  return modes;
+}
+
+// 'str' as one single quoted shell word
+std::string
+shell_quote(const std::string &str)
+{
+  std::string quoted = "'";
+  for (auto c : str)
+    quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+  return quoted + "'";
+}
+
+/* Run 'test' under the current mode and collect its results.  A test that
+ * fails is reported and yields none, the matrix goes on.
+ */
+std::vector<matrix_cell>
+run_test(vtd::device_control &control, const matrix_test &test, const std::string &pmode,
+         const std::filesystem::path &log_dir, std::chrono::milliseconds interval, bool &has_clock, bool &has_power)
+{
+  auto base = (log_dir / (pmode + "_" + test.name)).string();
+  auto json = base + ".json";
+  auto log = base + ".log";
+  std::error_code ec;
+  std::filesystem::remove(json, ec);
+
+  auto cmd = test.command + " --results-json " + shell_quote(json) + " > " + shell_quote(log) + " 2>&1";
+  std::cout << "  " << test.name << "..." << std::flush;
+  auto start = std::chrono::steady_clock::now();
+  telemetry_sampler sampler(control, interval, has_clock, has_power);
+  int status = std::system(cmd.c_str());
+  auto data = sampler.stop();
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (status != 0 || !std::filesystem::exists(json)) {
+    std::cout << " FAILED, see " << log << std::endl;
+    return {};
+  }
+  std::cout << " " << std::fixed << std::setprecision(1) << secs << " s" << std::defaultfloat << std::endl;
+
+  std::vector<matrix_cell> cells;
+  for (auto &metric : vtd::load_results(json).metrics) {
+    matrix_cell cell;
+    cell.pmode = pmode;
+    cell.test = test.name;
+    cell.metric = metric.test;
+    cell.unit = metric.unit;
+    cell.value = mean(metric.samples);
+    cell.noise_pct = metric.noise_pct;
+    cell.clock_mhz = mean(data.clock_mhz);
+    cell.power_w = mean(data.power_w);
+    cells.push_back(cell);
+  }
+  return cells;
+}
+
+// Every result under every mode, and how it compares with the first mode
+void
+report(const std::vector<matrix_cell> &cells, const std::string &baseline)
+{
+  std::map<std::pair<std::string, std::string>, const matrix_cell*> base;
+  for (auto &cell : cells) {
+    if (cell.pmode == baseline)
+      base[{cell.test, cell.metric}] = &cell;
+  }
+
+  std::cout << "         Mode  Result                            Value  Unit       Clock (MHz)  Power (W)"
+               "     Value/W   vs " << baseline << ": value   power   value/W\n";
+  std::cout << std::fixed;
+  for (auto &cell : cells) {
+    std::cout << std::setw(13) << cell.pmode << "  " << std::left << std::setw(28) << cell.metric << std::right
+              << std::setprecision(3) << std::setw(11) << cell.value << "  " << std::left << std::setw(10)
+              << cell.unit << std::right << std::setprecision(0) << std::setw(12) << cell.clock_mhz
+              << std::setprecision(3) << std::setw(11) << cell.power_w;
+    if (per_watt(cell) > 0)
+      std::cout << std::setw(12) << per_watt(cell);
+    else
+      std::cout << std::setw(12) << "-";
+
+    auto it = base.find({cell.test, cell.metric});
+    if (it != base.end() && cell.pmode != baseline && it->second->value) {
+      auto &b = *it->second;
+      auto change = [](double value, double ref) { return ref ? (value / ref - 1) * 100 : 0.0; };
+      std::cout << std::showpos << std::setprecision(1) << std::setw(17) << change(cell.value, b.value) << "%"
+                << std::setw(7) << change(cell.power_w, b.power_w) << "%";
+      if (per_watt(cell) > 0 && per_watt(b) > 0)
+        std::cout << std::setw(9) << change(per_watt(cell), per_watt(b)) << "%";
+      std::cout << std::noshowpos;
+    }
+    std::cout << "\n";
+  }
+  std::cout << std::defaultfloat;
+}
+
+// Results of every mode as <prefix>_<pmode>.json
+void
+write_results(const std::string &prefix, const xrt::device &device, const std::vector<std::string> &pmodes,
+              const std::vector<matrix_cell> &cells)
+{
+  for (auto &pmode : pmodes) {
+    vtd::result_set results;
+    results.app = "pmode_matrix";
+    vtd::set_result_device(results, device);
+    results.pmode = pmode;
+    for (auto &cell : cells) {
+      if (cell.pmode != pmode)
+        continue;
+      results.add(cell.metric, cell.unit, cell.value, cell.noise_pct);
+      bool first = std::none_of(results.metrics.begin(), results.metrics.end(), [&cell](auto &metric) {
+        return metric.test == cell.test + "-power";
+      });
+      if (cell.power_w > 0 && first)
+        results.add(cell.test + "-power", "W", cell.power_w);
+      if (per_watt(cell) > 0)
+        results.add(cell.metric + "-per-watt", cell.unit + "/W", per_watt(cell));
+    }
+    vtd::write_results_json(prefix + "_" + pmode + ".json", results);
+  }
+}
+
+void
+run(int argc, char **argv)
+{
+  std::vector<std::string> pmodes = {"default", "performance", "turbo"};
+  std::string tests_file;
+  std::string log_dir = "pmode_matrix_logs";
+  std::string results_prefix;
+  int interval_ms = 500;
+  int settle_ms = 1000;
+  std::vector<std::string> commands;
+
+  const std::string usage = "Usage: " + std::string(argv[0]) + " [--pmodes <mode>[,<mode>...]] [--tests <file>]"
+                            " [--interval-ms <ms>] [--settle-ms <ms>] [--log-dir <dir>]"
+                            " [--results-json <prefix>] [-- <command> [args...]]\n";
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--pmodes" && i + 1 < argc) {
+      pmodes.clear();
+      std::string list = argv[++i];
+      for (size_t pos = 0; pos <= list.size();) {
+        auto comma = std::min(list.find(',', pos), list.size());
+        if (comma > pos)
+          pmodes.push_back(list.substr(pos, comma - pos));
+        pos = comma + 1;
+      }
+      // The modes end up in xrt-smi arguments and file names, only known ones pass
+      for (auto &pmode : pmodes) {
+        if (!vtd::pmode_clocks().count(pmode))
+          throw std::runtime_error("Error: Unknown power mode " + pmode + ", expected one of " + known_pmodes() + "\n");
+      }
+    }
+    else if (arg == "--tests" && i + 1 < argc)
+      tests_file = argv[++i];
+    else if (arg == "--interval-ms" && i + 1 < argc)
+      interval_ms = std::stoi(argv[++i]);
+    else if (arg == "--settle-ms" && i + 1 < argc)
+      settle_ms = std::stoi(argv[++i]);
+    else if (arg == "--log-dir" && i + 1 < argc)
+      log_dir = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_prefix = argv[++i];
+    else if (arg == "--" && i + 1 < argc) {
+      std::string command;
+      for (i++; i < argc; i++)
+        command += (command.empty() ? "" : " ") + std::string(argv[i]);
+      commands.push_back(command);
+    }
+    else
+      throw std::runtime_error(usage);
+  }
+
+  auto tests = tests_file.empty() ? std::vector<matrix_test>() : load_tests(tests_file);
+  for (auto &test : name_tests(commands))
+    tests.push_back(test);
+  if (tests.empty() || pmodes.empty() || interval_ms < 1 || settle_ms < 0)
+    throw std::runtime_error(usage);
+  std::filesystem::create_directories(log_dir);
+
+  auto device = xrt::device(0);
+  auto control = vtd::make_device_control(device);
+  std::string original;
+  try {
+    original = control->power_mode();
+  }
+  catch (const std::exception &ex) {
+    std::cout << "The current power mode is unknown and is not restored, " << ex.what();
+  }
+
+  // The device goes back to its mode however the matrix ends
+  struct restore_pmode
+  {
+    vtd::device_control &control;
+    const std::string &mode;
+
+    ~restore_pmode()
+    {
+      try {
+        if (!mode.empty())
+          control.set_power_mode(mode);
+      }
+      catch (const std::exception &ex) {
+        std::cout << "Failed to restore power mode " << mode << ", " << ex.what();
+      }
+    }
+  } restore {*control, original};
+
+  std::cout << "Power mode matrix: " << pmodes.size() << " modes x " << tests.size() << " tests, logs in "
+            << log_dir << std::endl;
+  bool has_clock = true;
+  bool has_power = true;
+  std::vector<matrix_cell> cells;
+  for (auto &pmode : pmodes) {
+    control->set_power_mode(pmode);
+    std::string reported = pmode;
+    try {
+      reported = control->power_mode();
+    }
+    catch (const std::exception&) {
+    }
+    std::cout << "Power mode " << pmode;
+    if (reported != pmode)
+      std::cout << " (the device reports " << reported << ")";
+    std::cout << ":" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(settle_ms));
+
+    for (auto &test : tests) {
+      auto result = run_test(*control, test, pmode, log_dir, std::chrono::milliseconds(interval_ms), has_clock,
+                             has_power);
+      cells.insert(cells.end(), result.begin(), result.end());
+    }
+  }
+  if (!has_clock)
+    std::cout << "The device does not report its AIE clock\n";
+  if (!has_power)
+    std::cout << "The device does not report its power draw, no per watt results\n";
+
+  report(cells, pmodes[0]);
+  if (!results_prefix.empty())
+    write_results(results_prefix, device, pmodes, cells);
+
+  size_t failed = 0;
+  for (auto &test : tests) {
+    for (auto &pmode : pmodes) {
+      failed += std::none_of(cells.begin(), cells.end(), [&](const matrix_cell &c) {
+        return c.pmode == pmode && c.test == test.name;
+      });
+    }
+  }
+  if (failed)
+    throw std::runtime_error("Error: " + std::to_string(failed) + " test run(s) failed\nTEST FAILED!");
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
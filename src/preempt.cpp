@@ -1,112 +1,303 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
 
+/* Measures the cost of a preemption.  The preemption ELFs are run with force
+ * preemption disabled and enabled, and the difference in run latency divided
+ * by the number of preemption points of the ELF is the per preemption overhead.
+ *
+ * Every partition width with both an xclbin and an ELF on disk is measured.
+ * Each configuration sets up its hw_context, kernel, BOs and run object once
+ * and then alternates between the two modes, off/on and on/off in turn, so
+ * that drift of the device cancels out of the per sample differences.  The
+ * force preemption switch goes through vtd::device_control.
+ *
+ * The xclbin, hw_context and kernels come from a vtd::setup_cache, so the two
+ * ELFs of a width share one xclbin registration and context.  The startup
+ * breakdown of the first configuration and the setup time of every one are
+ * printed.
+ */
+
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <unistd.h>
+#include <vector>
 
 // XRT includes
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_hw_context.h"
 #include "xrt/xrt_bo.h"
-#include "experimental/xrt_elf.h"
-#include "experimental/xrt_module.h"
-#include "experimental/xrt_ext.h"
+
+#include "cmdline.h"
+#include "device_control.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "sample_stats.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
 
 constexpr unsigned long int host_app = 3;
 static constexpr size_t buffer_size = 20;
 
-double
-run_preempt_test(const std::string &xclbinFileName, const std::string &elfFileName, xrt::device &device)
+// Preemption ELF and the xclbin of its partition
+struct preempt_config
+{
+  std::string name;
+  std::string xclbin;
+  std::string elf;
+};
+
+// Configurations of the requested widths that are present on disk
+std::vector<preempt_config>
+find_configs(const std::string &xclbin_dir, const std::string &elf_dir, const std::vector<int> &columns)
 {
-  auto xclbin = xrt::xclbin(xclbinFileName);
-
-  // Determine The DPU Kernel Name
-  auto xkernels = xclbin.get_kernels();
-  auto xkernel = *std::find_if(xkernels.begin(), xkernels.end(), [](xrt::xclbin::kernel& k) {
-    auto name = k.get_name();
-    // Starts with "DPU"
-    return name.rfind("DPU", 0) == 0;
-  });
-
-  if (!xkernel)
-    throw std::runtime_error("Error: Failure to find DPU kernel in the XCLBIN!\n");
-
-  auto kernelName = xkernel.get_name();
-
-  device.register_xclbin(xclbin);
-  xrt::elf elf(elfFileName);
-  xrt::module mod(elf);
-  xrt::hw_context context(device, xclbin.get_uuid());
-
-  auto dpu = xrt::ext::kernel(context, mod, kernelName);
-
-  auto bo_ifm = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(5));
-  auto bo_ofm = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(6));
-  auto bo_wts1 = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(3));
-  auto bo_wts2 = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(4));
-
-  // Set kernel argument and trigger it to run
-  auto start = std::chrono::high_resolution_clock::now();
-  auto run = dpu(host_app, 0, 0, bo_ifm, bo_ofm, bo_wts1, bo_wts2, 0);
-  run.wait2();
-  auto end = std::chrono::high_resolution_clock::now();
-
-  double elapsedSecs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-  std::cout << "Time taken: " << elapsedSecs << " us\n";
-  return elapsedSecs;
+  std::vector<preempt_config> configs;
+  for (auto ncol : columns) {
+    auto shape = "4x" + std::to_string(ncol);
+    std::string xclbin;
+    for (auto &name : {"preemption_" + shape + "_npu4.xclbin", "validate_npu4_elf_" + shape + ".xclbin"}) {
+      auto path = std::filesystem::path(xclbin_dir) / name;
+      if (std::filesystem::exists(path)) {
+        xclbin = path.string();
+        break;
+      }
+    }
+    if (xclbin.empty())
+      continue;
+
+    for (auto kind : {"noop", "memtile"}) {
+      auto elf = std::filesystem::path(elf_dir) / ("preemption_" + std::string(kind) + "_" + shape + ".elf");
+      if (std::filesystem::exists(elf))
+        configs.push_back({std::string(kind) + " " + shape, xclbin, elf.string()});
+    }
+  }
+  return configs;
 }
 
-void
-run(int argc, char **argv)
+// Buffers and run of one configuration, kept for all samples.  The xclbin,
+// context and kernel come from the setup cache.
+class preempt_test
 {
-  const int preemptions = 500;
-  std::string BDF = argv[1];
-  std:: string force_off = "sudo xrt-smi configure --force-preemption disable -d " + BDF;
-  std:: string force_on = "sudo xrt-smi configure --force-preemption enable -d " + BDF;
+public:
+  preempt_test(xrt::device &device, vtd::setup_cache &cache, vtd::startup_profile &profile,
+               const preempt_config &config)
+  {
+    auto dpu = cache.elf_kernel(config.xclbin, config.elf);
+    profile.time("BO allocation", [&] {
+      m_bo_ifm = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(5));
+      m_bo_ofm = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(6));
+      m_bo_wts1 = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(3));
+      m_bo_wts2 = xrt::bo(device, buffer_size, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(4));
+    });
 
-  const unsigned int columns[] = {1, 2, 4};
-  for (auto ncol : columns) {
-    std::string xclbinFileName = "../xclbin_prod/validate_npu4_elf_4x" + std::to_string(ncol) + ".xclbin";
-    std::string elfFileName = "../sequences/preempt_4x" + std::to_string(ncol) + ".elf";
-    auto device = xrt::device(0);
-
-    // Make sure force preemption is disabled
-    int result = system(force_off.c_str());
-    if (result == -1) {
-        throw std::runtime_error("Failed to disable force preemtion\n");
+    m_run = xrt::run(dpu);
+    m_run.set_arg(0, host_app);
+    m_run.set_arg(1, 0);
+    m_run.set_arg(2, 0);
+    m_run.set_arg(3, m_bo_ifm);
+    m_run.set_arg(4, m_bo_ofm);
+    m_run.set_arg(5, m_bo_wts1);
+    m_run.set_arg(6, m_bo_wts2);
+    m_run.set_arg(7, 0);
+  }
+
+  // Mean latency in us over 'iterations' runs, each run is also recorded in 'latency'
+  double
+  sample(int iterations, vtd::latency_histogram &latency)
+  {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      auto start = std::chrono::steady_clock::now();
+      m_run.start();
+      m_run.wait2();
+      latency.record(std::chrono::steady_clock::now() - start);
     }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / iterations;
+  }
 
-    double noop_exec_time = run_preempt_test(xclbinFileName, elfFileName, std::ref(device));
+private:
+  xrt::bo m_bo_ifm;
+  xrt::bo m_bo_ofm;
+  xrt::bo m_bo_wts1;
+  xrt::bo m_bo_wts2;
+  xrt::run m_run;
+};
 
-    result = system(force_on.c_str());
-    if (result == -1) {
-        throw std::runtime_error("Failed to disable force preemtion\n");
+// Leaves force preemption disabled however the measurement ends
+class force_preemption_guard
+{
+public:
+  explicit force_preemption_guard(vtd::device_control &control)
+    : m_control(control)
+  {
+    m_control.set_force_preemption(false);
+  }
+
+  ~force_preemption_guard()
+  {
+    try {
+      m_control.set_force_preemption(false);
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Failed to disable force preemption: " << ex.what();
     }
+  }
+
+private:
+  vtd::device_control &m_control;
+};
+
+struct preempt_result
+{
+  vtd::latency_histogram off;
+  vtd::latency_histogram on;
+  std::vector<double> overhead_us;                  // Per preemption overhead of every sample
+};
+
+// The startup breakdown is printed once the first configuration is set up
+preempt_result
+measure_preemption(xrt::device &device, vtd::setup_cache &cache, vtd::startup_profile &profile,
+                   vtd::device_control &control, const preempt_config &config, int samples, int iterations,
+                   int warmup, int preemptions, bool first)
+{
+  auto setup_start = std::chrono::steady_clock::now();
+  preempt_test test(device, cache, profile, config);
+  auto setup = std::chrono::steady_clock::now() - setup_start;
+  if (first)
+    profile.print(std::cout);
+  std::cout << "  Setup time: " << std::chrono::duration<double, std::milli>(setup).count() << " ms" << std::endl;
+  force_preemption_guard guard(control);
+  preempt_result result;
 
-    double noop_preempt_exec_time = run_preempt_test(xclbinFileName, elfFileName, std::ref(device));
+  vtd::latency_histogram discard;
+  for (int i = 0; i < warmup; i++) {
+    test.sample(iterations, discard);
+    control.set_force_preemption(true);
+    test.sample(iterations, discard);
+    control.set_force_preemption(false);
+  }
 
-    result = system(force_off.c_str());
-    if (result == -1) {
-        throw std::runtime_error("Failed to disable force preemtion\n");
+  bool enabled = false;
+  for (int s = 0; s < samples; s++) {
+    // Alternate the order of the modes, the mode left over from the previous
+    // sample goes first to halve the switches
+    double latency_us[2];
+    for (int k = 0; k < 2; k++) {
+      if (k)
+        control.set_force_preemption(enabled = !enabled);
+      latency_us[enabled] = test.sample(iterations, enabled ? result.on : result.off);
     }
+    result.overhead_us.push_back((latency_us[1] - latency_us[0]) / preemptions);
+  }
+  return result;
+}
+
+void
+run(int argc, char **argv)
+{
+  vtd::startup_profile profile;
+  int preemptions = 500;
+  int samples = 10;
+  int iterations = 10;
+  int warmup = 1;
+  std::vector<int> columns = {1, 2, 4, 8};
+  std::string xclbin_dir = "../xclbin_prod";
+  std::string elf_dir = "../elf";
+  std::string histogram_json;
+  std::string results_json;
+  std::string BDF;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc)
+      iterations = std::stoi(argv[++i]);
+    else if (arg == "--samples" && i + 1 < argc)
+      samples = std::stoi(argv[++i]);
+    else if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::stoi(argv[++i]);
+    else if (arg == "--preemptions" && i + 1 < argc)
+      preemptions = std::stoi(argv[++i]);
+    else if (arg == "--columns" && i + 1 < argc)
+      columns = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--xclbin-dir" && i + 1 < argc)
+      xclbin_dir = argv[++i];
+    else if (arg == "--elf-dir" && i + 1 < argc)
+      elf_dir = argv[++i];
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else if (i == 1 && arg.rfind("--", 0) != 0)
+      BDF = arg;
+    else
+      throw std::runtime_error("Usage: " + std::string(argv[0]) + " [<BDF>] [--samples <n>] [--iterations <n>]"
+                               " [--warmup <n>] [--preemptions <n>] [--columns <n>[,<n>...]] [--xclbin-dir <dir>]"
+                               " [--elf-dir <dir>] [--histogram-json <file>] [--results-json <file>]\n");
+  }
+  if (samples < 1 || iterations < 1 || preemptions < 1)
+    throw std::runtime_error("Error: --samples, --iterations and --preemptions must be positive\n");
+
+  auto configs = find_configs(xclbin_dir, elf_dir, columns);
+  if (configs.empty())
+    throw std::runtime_error("Error: No preemption xclbin and ELF pair found in " + xclbin_dir + " and " + elf_dir
+                             + "\n");
+
+  auto device = profile.time("device open", [&BDF] { return BDF.empty() ? xrt::device(0) : xrt::device(BDF); });
+  auto control = profile.time("device control", [&device] { return vtd::make_device_control(device); });
+  vtd::setup_cache cache(device, &profile);
+
+  std::vector<std::pair<std::string, vtd::latency_histogram>> histograms;
+  vtd::result_set results;
+  results.app = "preempt";
+  for (size_t c = 0; c < configs.size(); c++) {
+    auto &config = configs[c];
+    std::cout << "Preemption " << config.name << ": " << samples << " samples of " << iterations
+              << " runs per mode, " << preemptions << " preemptions per run" << std::endl;
+    auto result = measure_preemption(device, cache, profile, *control, config, samples, iterations, warmup,
+                                     preemptions, c == 0);
+
+    // The ELFs of one width share the context, it is closed before the next
+    // width needs the columns
+    if (c + 1 == configs.size() || configs[c + 1].xclbin != config.xclbin)
+      cache.release(config.xclbin);
+    auto overhead = vtd::summarize_samples(result.overhead_us);
+
+    result.off.print(std::cout, "  Force preemption off");
+    result.on.print(std::cout, "  Force preemption on");
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  Per preemption overhead (us): mean " << overhead.mean << " +/- " << overhead.ci95
+              << " (95% CI) p50 " << vtd::sample_percentile(result.overhead_us, 0.5) << " p90 "
+              << vtd::sample_percentile(result.overhead_us, 0.9) << " p99 "
+              << vtd::sample_percentile(result.overhead_us, 0.99) << " min " << overhead.min << " max "
+              << overhead.max << std::endl;
+    std::cout << std::defaultfloat;
 
-    double overhead = (noop_preempt_exec_time - noop_exec_time) / preemptions;
-    std::cout << "Average preemption overhead for 4x" << ncol << " design: " << overhead << "us\n";
+    histograms.emplace_back("preempt " + config.name + " off", result.off);
+    histograms.emplace_back("preempt " + config.name + " on", result.on);
+    auto test = "preemption-overhead-" + config.name;
+    std::replace(test.begin(), test.end(), ' ', '-');
+    for (auto sample : result.overhead_us)
+      results.add(test, "us", sample);
+  }
+
+  cache.print_stats(std::cout);
+
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, histograms);
+  if (!results_json.empty()) {
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
   }
 }
 
 int
 main(int argc, char **argv)
 {
-  if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <BDF>" << std::endl;
-    return EXIT_FAILURE;
-  }
-
   try {
     run(argc, argv);
     std::cout << "TEST PASSED!\n";
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application measures how long a recipe takes to load and set up
+ * in each of its forms: the expanded JSON as shipped in archive/ with one
+ * entry per command, the same recipe loaded into run templates, written with
+ * "repeat" run templates, and the binary form.  The expanded baseline loads
+ * without folding and binds one xrt::run per entry, the way the runner worked
+ * before templates.  The templates are bound as the runner binds the cmd-chain
+ * tests, one chain of at most the default chain length.  Setup is the
+ * recipe_engine constructor: hw_context, buffers and runs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+#include "recipe.h"
+
+template <typename Func>
+double
+time_us(Func &&func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+double
+median(std::vector<double> samples)
+{
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+struct form_timing
+{
+  double load_us;
+  double setup_us;
+
+  double
+  total_us() const
+  {
+    return load_us + setup_us;
+  }
+};
+
+// Median load and setup time over 'rounds', the last load is left in 'rcp'
+template <typename Load>
+form_timing
+time_form(const xrt::device &device, int rounds, vtd::recipe &rcp, Load &&load)
+{
+  std::vector<double> load_us;
+  std::vector<double> setup_us;
+  vtd::profile prf;
+  for (int i = 0; i < rounds; i++) {
+    load_us.push_back(time_us([&] { rcp = load(); }));
+    vtd::recipe_engine engine(device, rcp, prf);
+    setup_us.push_back(std::chrono::duration<double, std::micro>(engine.setup_time()).count());
+  }
+  return {median(load_us), median(setup_us)};
+}
+
+bool
+same_recipe(const vtd::recipe &a, const vtd::recipe &b)
+{
+  if (a.runs.size() != b.runs.size() || a.buffers.size() != b.buffers.size())
+    return false;
+  for (size_t i = 0; i < a.runs.size(); i++) {
+    if (a.runs[i].kernel != b.runs[i].kernel || a.runs[i].repeat != b.runs[i].repeat
+        || a.runs[i].chain != b.runs[i].chain || a.runs[i].arguments.size() != b.runs[i].arguments.size())
+      return false;
+  }
+  return true;
+}
+
+void
+report(const std::string &name, const std::string &fname, size_t entries, const form_timing &t,
+       const form_timing &baseline)
+{
+  std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(11) << t.load_us << " us" << std::setw(11) << t.setup_us << " us" << std::setw(11)
+            << std::filesystem::file_size(fname) << " bytes" << std::setw(7) << entries << " runs" << std::setw(9)
+            << baseline.total_us() / t.total_us() << "x\n";
+}
+
+void
+run(int argc, char **argv)
+{
+  if (argc != 2 && !(argc == 4 && std::string(argv[2]) == "--rounds"))
+    throw std::runtime_error("Usage: " + std::string(argv[0]) + " <recipe.json> [--rounds <n>]");
+
+  std::string fname = argv[1];
+  int rounds = argc == 4 ? std::stoi(argv[3]) : 9;
+  if (rounds < 1)
+    throw std::runtime_error("Error: --rounds must be positive\n");
+  auto device = xrt::device(0);
+
+  // Baseline: one template and one bound run per entry of the expanded JSON
+  vtd::recipe expanded;
+  auto expanded_t = time_form(device, rounds, expanded, [&] { return vtd::load_recipe(fname, false); });
+
+  vtd::recipe templated;
+  auto json_t = time_form(device, rounds, templated, [&] {
+    auto rcp = vtd::load_recipe(fname);
+    for (auto &run : rcp.runs)
+      run.chain = run.repeat > 1;
+    return rcp;
+  });
+
+  std::string compact_name = "recipe_load_bench.json";
+  vtd::save_recipe_json(templated, compact_name);
+  vtd::recipe compact;
+  auto compact_t = time_form(device, rounds, compact, [&] { return vtd::load_recipe(compact_name); });
+
+  std::string binary_name = "recipe_load_bench.bin";
+  vtd::save_recipe(templated, binary_name);
+  vtd::recipe binary;
+  auto binary_t = time_form(device, rounds, binary, [&] { return vtd::load_recipe(binary_name); });
+
+  if (!same_recipe(templated, compact) || !same_recipe(templated, binary)
+      || expanded.runs.size() != vtd::recipe_commands(templated))
+    throw std::runtime_error("Error: Recipe forms do not load to the same runs\n");
+
+  std::cout << "Recipe: " << fname << " (" << expanded.runs.size() << " commands, " << templated.runs.size()
+            << " run templates)\n";
+  std::cout << std::left << std::setw(16) << "Form" << std::right << std::setw(14) << "Load" << std::setw(14)
+            << "Setup" << "\n";
+  report("expanded JSON", fname, expanded.runs.size(), expanded_t, expanded_t);
+  report("templated JSON", fname, templated.runs.size(), json_t, expanded_t);
+  report("repeat JSON", compact_name, compact.runs.size(), compact_t, expanded_t);
+  report("binary", binary_name, binary.runs.size(), binary_t, expanded_t);
+
+  std::remove(compact_name.c_str());
+  std::remove(binary_name.c_str());
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* This host application runs a test described by a recipe/profile pair from
+ * archive/, e.g.
+ *
+ *   recipe_runner archive/strx/latency/recipe_latency.json archive/strx/latency/profile_latency.json
+ *
+ * All buffers are allocated and every run in execution.runs is bound once up
+ * front.  An iteration starts the runs in order and waits for all of them, so
+ * the timed loop carries no per-test host code.  The time per iteration, the
+ * command rate and the iteration latency percentiles are reported.
+ *
+ * Runs with an explicit repeat count are submitted as xrt::runlist command
+ * chains of up to --chain-length runs, and so are the repeated runs of the
+ * cmd-chain tests, whose recipes list every run.  The identical runs of other
+ * expanded recipes are submitted one by one as written.  --compile <file>
+ * writes the recipe in its binary form, which later runs load in place of the
+ * JSON file.
+ *
+ * --results-json records the result under --test, by default the name of the
+ * recipe directory with dashes (cmd_chain_latency -> cmd-chain-latency).
+ * Throughput tests record the command rate with --queue-depth (default 64)
+ * commands in flight.  All others record the time per command, by default
+ * with one command in flight so that it is the command latency rather than
+ * the inverse of the throughput; a chain still runs its commands back to back.
+ *
+ * --repeat N sets the test up and runs it N times in a row, as a test session
+ * would.  Buffers come from a vtd::bo_pool shared by the repeats, so later
+ * setups reuse the BOs of earlier ones; --bo-backing and --prefault select
+ * huge page backed and prefaulted buffers.  The pool reports the allocation
+ * costs and what the reuse saved.
+ */
+
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+#include "bo_pool.h"
+#include "latency_histogram.h"
+#include "recipe.h"
+#include "results.h"
+
+void
+usage(const std::string &prog)
+{
+  throw std::runtime_error("Usage: " + prog + " <recipe.json> <profile.json> [--device <index|bdf>]"
+                           " [--iterations <n>] [--queue-depth <k>] [--chain-length <n>] [--histogram-json <file>]"
+                           " [--compile <file>] [--results-json <file>] [--test <name>] [--repeat <n>]"
+                           " [--bo-backing driver|thp|2m|1g] [--prefault]\n");
+}
+
+void
+run(int argc, char **argv)
+{
+  if (argc < 3)
+    usage(argv[0]);
+
+  std::string recipe_file = argv[1];
+  std::string profile_file = argv[2];
+  std::string device_id = "0";
+  uint64_t iterations = 0;
+  unsigned int queue_depth = 0;                // Depends on the test
+  unsigned int chain_length = vtd::recipe_engine::default_chain_length;
+  std::string histogram_json;
+  std::string compiled;
+  std::string results_json;
+  std::string test;
+  int repeat = 1;
+  auto backing = vtd::bo_backing::driver;
+  bool prefault = false;
+
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--device" && i + 1 < argc)
+      device_id = argv[++i];
+    else if (arg == "--iterations" && i + 1 < argc)
+      iterations = std::stoull(argv[++i]);
+    else if (arg == "--queue-depth" && i + 1 < argc)
+      queue_depth = std::stoul(argv[++i]);
+    else if (arg == "--chain-length" && i + 1 < argc)
+      chain_length = std::stoul(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--compile" && i + 1 < argc)
+      compiled = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else if (arg == "--test" && i + 1 < argc)
+      test = argv[++i];
+    else if (arg == "--repeat" && i + 1 < argc)
+      repeat = std::stoi(argv[++i]);
+    else if (arg == "--bo-backing" && i + 1 < argc)
+      backing = vtd::parse_bo_backing(argv[++i]);
+    else if (arg == "--prefault")
+      prefault = true;
+    else
+      usage(argv[0]);
+  }
+  if (repeat < 1)
+    usage(argv[0]);
+
+  auto rcp = vtd::load_recipe(recipe_file);
+  auto prf = vtd::load_profile(profile_file, rcp);
+  if (!compiled.empty()) {
+    vtd::save_recipe(rcp, compiled);
+    std::cout << "Binary recipe written to " << compiled << "\n";
+  }
+
+  auto device = device_id.find(':') == std::string::npos ? xrt::device(std::stoul(device_id)) : xrt::device(device_id);
+  if (test.empty()) {
+    test = std::filesystem::absolute(recipe_file).parent_path().filename().string();
+    std::replace(test.begin(), test.end(), '_', '-');
+  }
+  // The cmd-chain recipes describe a chain by listing all of its runs
+  if (test.rfind("cmd-chain", 0) == 0) {
+    for (auto &run : rcp.runs)
+      run.chain = run.repeat > 1;
+  }
+  auto suffix = std::string("throughput");
+  bool throughput = test.size() >= suffix.size() && test.compare(test.size() - suffix.size(), suffix.size(), suffix) == 0;
+  if (!queue_depth)
+    queue_depth = throughput ? vtd::recipe_engine::default_queue_depth : 1;
+
+  // Every repeat sets the test up from scratch except for the pooled buffers
+  vtd::bo_pool pool(device, backing, prefault);
+  vtd::result_set results;
+  results.app = "recipe_runner";
+  vtd::recipe_result result;
+  std::vector<long long> setup_us;
+  for (int r = 0; r < repeat; r++) {
+    vtd::recipe_engine engine(device, rcp, prf, queue_depth, chain_length, &pool);
+    auto pass = engine.execute(iterations);
+    setup_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(engine.setup_time()).count());
+
+    auto pass_us = std::chrono::duration_cast<std::chrono::microseconds>(pass.elapsed).count();
+    if (repeat > 1)
+      std::cout << "Repeat " << r << ": setup " << setup_us.back() << " us, " << (double)pass_us / pass.iterations
+                << " us per iteration\n";
+    if (throughput)
+      results.add(test, "op/s", pass.commands * 1e6 / pass_us);
+    else
+      results.add(test, "us", static_cast<double>(pass_us) / pass.commands);
+
+    result.iterations += pass.iterations;
+    result.commands += pass.commands;
+    result.elapsed += pass.elapsed;
+    result.latency.merge(pass.latency);
+  }
+
+  auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(result.elapsed).count();
+  std::cout << "Setup time: " << setup_us.front() << " us";
+  if (repeat > 1) {
+    long long later = 0;
+    for (size_t r = 1; r < setup_us.size(); r++)
+      later += setup_us[r];
+    std::cout << " first, " << (double)later / (setup_us.size() - 1) << " us on average after";
+  }
+  std::cout << "\n";
+  pool.print_stats(std::cout);
+  std::cout << "Iteration count: " << result.iterations << "\n";
+  auto chained = std::count_if(rcp.runs.begin(), rcp.runs.end(), [](auto &r) { return r.chain; });
+  std::cout << "Commands per iteration: " << vtd::recipe_commands(rcp) << " (" << rcp.runs.size()
+            << " run templates, " << chained << " chained)\n";
+  std::cout << "Time taken: " << elapsed_us << " us\n";
+  std::cout << "Average time per iteration: " << (double)elapsed_us / result.iterations << " us\n";
+  std::cout << "Command throughput: " << result.commands * 1e6 / elapsed_us << " op/s\n";
+  result.latency.print(std::cout, "Iteration latency");
+
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, {{"recipe " + recipe_file, result.latency}});
+
+  if (!results_json.empty()) {
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}
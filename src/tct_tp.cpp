@@ -1,17 +1,48 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
 
-/* This host application measures the average TCT latency and TCT throughput 
+/* This host application measures the average TCT latency and TCT throughput
  * for single column and all columns tests.
- * The DPU sequence loopback the small chunk of input data from DDR through 
+ * The DPU sequence loopback the small chunk of input data from DDR through
  * a AIE MM2S Shim DMA channel back to DDR through a S2MM Shim DMA channel.
  * TCT is used for dma transfer completion. Host app measures the time for
  * predefined number of Tokens and calculate the latency and throughput.
+ *
+ * The number of tokens per run is counted from the TCT sync ops of the
+ * sequence (transaction format), as are the columns it covers, which select
+ * the one column or all column test.  --tokens overrides the count for
+ * sequences that cannot be scanned.
+ *
+ * With --iterations N the sequence is submitted N times, and --queue-depth K
+ * keeps K commands in flight so the host round trip between commands does not
+ * show up in the TCT rate.  --contexts 1,2,4 runs that many independent
+ * hw_contexts concurrently, one thread each, and reports the aggregate TCT/s
+ * and its scaling against the first count.  A list of depths reports every
+ * depth in turn.  Command latency percentiles are printed and
+ * --histogram-json dumps the raw histograms.
+ *
+ * After the timed runs --timestamp-runs runs are repeated with a debug BO in
+ * argument 4 that receives a record timer entry per token.  The differences
+ * between consecutive tokens of a column give the device side inter-token
+ * latency, free of host overhead.
+ *
+ * The setup of all contexts is timed phase by phase and printed as a startup
+ * breakdown before the first run.
+ *
+ * --cpus 2,4-5 pins the thread of context c to the c-th CPU of the list,
+ * wrapping around.  Before the runs the clock read cost and the OS jitter are
+ * calibrated for --calibrate-ms on every CPU used (0 skips it), and each
+ * TCT/s result carries the resulting host noise floor.
  */
 
-#include <fstream>
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <map>
 #include <string>
 #include <thread>
 #include <vector>
@@ -20,149 +51,345 @@
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_kernel.h"
 
-constexpr int dpu_instr_str_len = 8;
+#include "cmdline.h"
+#include "device_control.h"
+#include "dpu_sequence.h"
+#include "host_timing.h"
+#include "latency_histogram.h"
+#include "results.h"
+#include "run_pipeline.h"
+#include "setup_cache.h"
+#include "startup_profile.h"
+#include "thread_barrier.h"
+
 constexpr int host_app = 1;
 constexpr int tnx_len = 4;
 constexpr int tnx_word_count = tnx_len / 4;
 
-//Number of Sample Tokens to measure the throughtput
-int samples = 10000;
-
+// Debug BO layout as for the host_hal record timers: the entry count in the
+// first word, then one {ID, AIE timer low} pair per token from the third word
+constexpr size_t debug_size = 0x1000;
 
-/* Copy values from text file into buff, expecting values are ASCII encoded
- * 4-Byte hexadecimal values.
- */
-void
-init_instr_buf(const std::string &file_name, xrt::bo &bo_instr)
+struct record_timer
 {
-  auto instr = bo_instr.map<int*>();
-  std::string line;
-  std::ifstream ifs(file_name);
+  uint32_t id;
+  uint32_t timestamp;
+};
 
-  if (!ifs.is_open())
-    throw std::runtime_error("Error: Failure opening file " + file_name + " for reading!!\n");
+// One independent TCT stream with its own hw_context, columns and buffers
+struct tct_context
+{
+  xrt::hw_context hwctx;
+  xrt::kernel dpu;
+  vtd::dpu_instr instr;
+  xrt::bo in;
+  xrt::bo out;
+  std::vector<xrt::run> runs;
+  vtd::latency_histogram latency;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+  int cpu = -1;                          // Unpinned
+  std::exception_ptr error;
+};
 
-  // Copy 4-Byte hex values to the instruction buffer, ignoring comments
-  while (getline(ifs, line)) {
-    if (line.at(0) == '#')
-      continue;
+xrt::run
+create_run(const tct_context &ctx, const xrt::bo *debug)
+{
+  auto run = xrt::run(ctx.dpu);
+  run.set_arg(0, host_app);
+  run.set_arg(1, ctx.in);
+  run.set_arg(2, NULL);
+  run.set_arg(3, ctx.out);
+  if (debug)
+    run.set_arg(4, *debug);
+  else
+    run.set_arg(4, NULL);
+  run.set_arg(5, ctx.instr.bo);
+  run.set_arg(6, ctx.instr.size);
+  run.set_arg(7, NULL);
+  return run;
+}
 
-    std::stringstream ss(line);
-    unsigned int word = 0;
+void
+run_test_iterations(tct_context &ctx, vtd::thread_barrier &barrier, int it_max)
+{
+  try {
+    if (ctx.cpu >= 0)
+      vtd::pin_thread(ctx.cpu);
 
-    ss.seekp(0, std::ios::end);
-    if (ss.tellp() != dpu_instr_str_len)
-      throw std::runtime_error("Error: Invalid DPU instruction size\n");
+    // All contexts start submitting together
+    barrier.arrive_and_wait();
 
-    ss >> std::hex >> word;
-    *(instr++) = word;
+    ctx.start = std::chrono::steady_clock::now();
+    vtd::run_pipelined(ctx.runs, it_max, [&ctx](auto latency) { ctx.latency.record(latency); });
+    ctx.end = std::chrono::steady_clock::now();
+  } catch (...) {
+    ctx.error = std::current_exception();
   }
 }
 
-size_t
-get_instr_size(const std::string &fname)
+/* Run the sequence 'runs' times with the debug BO attached and record the
+ * time between consecutive tokens of every column.  Returns the number of
+ * timestamps of the last run, zero when the sequence records none.
+ */
+uint32_t
+measure_token_latency(const xrt::device &device, const tct_context &ctx, int runs, unsigned int clock_mhz,
+                      vtd::latency_histogram &token_latency)
 {
-  std::string line;
-  size_t size = 0;
-
-  std::ifstream file(fname);
-  if (!file.is_open())
-    throw std::runtime_error("Error: Failure opening file " + fname + " for reading!!\n");
-
-  // DPU sequence text file is list of 32-bit hex values separated by newline
-  // Comments within the file are identified by a '#' prefix
-  while (getline(file, line)) {
-    if (line.at(0) != '#')
-      size++;
-  }
+  auto debug = xrt::bo(device, debug_size, XCL_BO_FLAGS_CACHEABLE, ctx.dpu.group_id(4));
+  auto run = create_run(ctx, &debug);
+  auto words = debug.map<uint32_t*>();
+  uint32_t capacity = debug_size / sizeof(record_timer) - 1;
 
-  if (size == 0)
-    throw std::runtime_error("Error: Invalid DPU instruction length");
+  uint32_t count = 0;
+  for (int r = 0; r < runs; r++) {
+    words[0] = 0;
+    debug.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    run.start();
+    run.wait2();
+    debug.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
 
-  return size;
-}
-
-void
-run_test_iterations(const std::string &xclbinFileName, const std::string &dpuSequenceFileName, xrt::device &device, int tid)
-{
-  auto xclbin = xrt::xclbin(xclbinFileName);
-  // Determine The DPU Kernel Name
-  auto xkernels = xclbin.get_kernels();
-  auto xkernel = *std::find_if(xkernels.begin(), xkernels.end(), [](xrt::xclbin::kernel& k) {
-    auto name = k.get_name();
-    // Starts with "DPU"
-    return name.rfind("DPU", 0) == 0;
-  });
-
-  if (!xkernel)
-    throw std::runtime_error("Error: Failure to find DPU kernel in the XCLBIN!\n");
-  
-  auto kernelName = xkernel.get_name();
-  device.register_xclbin(xclbin);
-  xrt::hw_context context(device, xclbin.get_uuid());
-  auto dpu = xrt::kernel(context, kernelName);
-
-  size_t instr_size = get_instr_size(dpuSequenceFileName);
-
-  auto instr = xrt::bo(device, instr_size * sizeof(int), XCL_BO_FLAGS_CACHEABLE, dpu.group_id(5));
-  auto in = xrt::bo(device, tnx_len, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(1));
-  auto out = xrt::bo(device, 4*tnx_len, XRT_BO_FLAGS_HOST_ONLY, dpu.group_id(3));
-
-  init_instr_buf(dpuSequenceFileName, instr);
-
-  instr.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-  auto in_mapped = in.map<int*>();
-  for (int i = 0; i < tnx_word_count; i++)
-  in_mapped[i] = rand() % 4096;
-  in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-
-  auto start = std::chrono::high_resolution_clock::now();
-  auto run = dpu(host_app, in, NULL, out, NULL, instr, instr_size, NULL);
-  run.wait2();
-  auto end = std::chrono::high_resolution_clock::now();
-
-  out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-  auto out_mapped = out.map<int*>();
-  for (int i = 0; i < tnx_word_count; i++) {
-    if (out_mapped[i] == in_mapped[i])
-      continue;
-    std::runtime_error("Error: Output data mismatch!\nTEST FAILED!\n");
+    count = std::min(words[0], capacity);
+    auto entries = reinterpret_cast<const record_timer*>(words + 2);
+    std::map<uint32_t, uint32_t> last;   // ID -> previous timestamp
+    for (uint32_t i = 0; i < count; i++) {
+      auto prev = last.find(entries[i].id);
+      if (prev != last.end()) {
+        // AIE timer low values wrap, unsigned differences stay correct
+        uint32_t cycles = entries[i].timestamp - prev->second;
+        token_latency.record_ns(static_cast<uint64_t>(cycles * 1e3 / clock_mhz));
+      }
+      last[entries[i].id] = entries[i].timestamp;
+    }
   }
-
-  long long elapsedMicroSecs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-  std::cout << "Average Time for TCT (us): " << elapsedMicroSecs/(float)samples << std::endl;
-  std::cout << "Average TCT/s: " << samples * (1000000/(float)elapsedMicroSecs) << std::endl;
-  
+  return count;
 }
 
 void
 run(int argc, char **argv)
 {
-  int num_thread;
-
-  // Set the number of threads and iterations
-  // Default: 1 thread, 1 iteration
-  if (argc == 4) {
-    num_thread = 1;
-  } else {
-    throw std::runtime_error("Usage: " + std::string(argv[0]) + " <XCLBIN File> <DPU Sequence File> <BDF of IPU device>\n");
+  vtd::startup_profile profile;
+  int it_max = 1;
+  std::vector<int> depths = {1};
+  std::vector<int> context_counts = {1};
+  long long tokens_override = 0;
+  int timestamp_runs = 10;
+  unsigned int clock_override = 0;
+  std::vector<int> cpus;
+  int calibrate_ms = 100;
+  std::string histogram_json;
+  std::string results_json;
+  const std::string usage = "Usage: " + std::string(argv[0]) + " <XCLBIN File> <DPU Sequence File> <BDF of IPU device>"
+                            " [--iterations <n>] [--queue-depth <k>[,<k>...]] [--contexts <n>[,<n>...]]"
+                            " [--tokens <n>] [--timestamp-runs <n>] [--clock-mhz <MHz>] [--cpus <list>]"
+                            " [--calibrate-ms <ms>] [--histogram-json <file>] [--results-json <file>]\n";
+
+  // Default: 1 context, 1 iteration
+  if (argc < 4)
+    throw std::runtime_error(usage);
+
+  for (int i = 4; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc)
+      it_max = std::stoi(argv[++i]);
+    else if (arg == "--queue-depth" && i + 1 < argc)
+      depths = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--contexts" && i + 1 < argc)
+      context_counts = vtd::parse_int_list(argv[++i]);
+    else if (arg == "--tokens" && i + 1 < argc)
+      tokens_override = std::stoll(argv[++i]);
+    else if (arg == "--timestamp-runs" && i + 1 < argc)
+      timestamp_runs = std::stoi(argv[++i]);
+    else if (arg == "--clock-mhz" && i + 1 < argc)
+      clock_override = std::stoul(argv[++i]);
+    else if (arg == "--cpus" && i + 1 < argc)
+      cpus = vtd::parse_cpu_list(argv[++i]);
+    else if (arg == "--calibrate-ms" && i + 1 < argc)
+      calibrate_ms = std::stoi(argv[++i]);
+    else if (arg == "--histogram-json" && i + 1 < argc)
+      histogram_json = argv[++i];
+    else if (arg == "--results-json" && i + 1 < argc)
+      results_json = argv[++i];
+    else
+      throw std::runtime_error(usage);
   }
+
+  if (it_max < 1 || tokens_override < 0 || timestamp_runs < 0 || calibrate_ms < 0
+      || *std::min_element(context_counts.begin(), context_counts.end()) < 1
+      || *std::min_element(depths.begin(), depths.end()) < 1)
+    throw std::runtime_error(usage);
   std::string xclbinFileName = argv[1];
   std::string dpuSequenceFileName = argv[2];
   std::string index = argv[3];
 
-  if (strstr(argv[2], "4col")) {
-      samples = 20000;
+  auto device = profile.time("device open", [&index] { return xrt::device(index); });
+  vtd::setup_cache cache(device, &profile);
+
+  // Every context is opened up front in a cache slot of its own, the first n
+  // of them run concurrently
+  int max_contexts = *std::max_element(context_counts.begin(), context_counts.end());
+  std::vector<tct_context> contexts(max_contexts);
+  for (int c = 0; c < max_contexts; c++) {
+    auto &ctx = contexts[c];
+    ctx.cpu = cpus.empty() ? -1 : cpus[c % cpus.size()];
+    ctx.hwctx = cache.hw_context(xclbinFileName, c);
+    ctx.dpu = cache.kernel(xclbinFileName, c);
+    ctx.instr = profile.time("DPU sequence", [&] {
+      return vtd::load_dpu_sequence(device, ctx.dpu, dpuSequenceFileName);
+    });
+    profile.time("BO allocation", [&] {
+      ctx.in = xrt::bo(device, tnx_len, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(1));
+      ctx.out = xrt::bo(device, 4*tnx_len, XRT_BO_FLAGS_HOST_ONLY, ctx.dpu.group_id(3));
+    });
+
+    profile.time("data init", [&] {
+      auto in_mapped = ctx.in.map<int*>();
+      for (int i = 0; i < tnx_word_count; i++)
+        in_mapped[i] = rand() % 4096;
+      ctx.in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    });
+  }
+  profile.print(std::cout);
+
+  // Calibrate on the CPUs the context threads are pinned to, or unpinned
+  vtd::host_calibration calibration;
+  if (calibrate_ms) {
+    std::vector<int> used;
+    for (auto &ctx : contexts) {
+      if (ctx.cpu >= 0 && std::find(used.begin(), used.end(), ctx.cpu) == used.end())
+        used.push_back(ctx.cpu);
+    }
+    calibration = vtd::calibrate_host(used, std::chrono::milliseconds(calibrate_ms));
+    calibration.print(std::cout);
+  }
+
+  // The tokens of a run are what the sync ops of the sequence wait for
+  auto syncs = vtd::scan_dpu_sequence_syncs(contexts[0].instr.bo.map<const uint32_t*>(), contexts[0].instr.size);
+  long long tokens_per_run = tokens_override ? tokens_override : static_cast<long long>(syncs.tokens);
+  if (tokens_per_run == 0)
+    throw std::runtime_error("Error: No TCT sync ops found in " + dpuSequenceFileName
+                             + ", pass --tokens <n> for sequences that are not in transaction format\n");
+  auto columns = std::bitset<64>(syncs.column_mask).count();
+  std::string test = columns > 1 ? "tct-all-col" : "tct-one-col";
+  std::cout << "Tokens per run: " << tokens_per_run;
+  if (syncs.valid)
+    std::cout << " (" << syncs.ops << " sync ops over " << columns << (columns == 1 ? " column)" : " columns)");
+  std::cout << std::endl;
+
+  vtd::result_set results;
+  results.app = "tct_tp";
+  std::vector<std::pair<std::string, vtd::latency_histogram>> histograms;
+  std::map<int, double> base_rate;   // Per context rate of the first count, by depth
+  for (auto count : context_counts) {
+    for (auto depth : depths) {
+      // Every in-flight command gets its own run object
+      for (int c = 0; c < count; c++) {
+        auto &ctx = contexts[c];
+        ctx.runs.clear();
+        for (int k = 0; k < depth; k++)
+          ctx.runs.push_back(create_run(ctx, nullptr));
+        ctx.latency.reset();
+      }
+
+      vtd::thread_barrier barrier(count);
+      std::vector<std::thread> threads;
+      for (int c = 0; c < count; c++)
+        threads.emplace_back(run_test_iterations, std::ref(contexts[c]), std::ref(barrier), it_max);
+
+      for (auto& th : threads)
+        th.join();
+
+      auto first_start = contexts[0].start;
+      auto last_end = contexts[0].end;
+      vtd::latency_histogram latency;
+      for (int c = 0; c < count; c++) {
+        auto &ctx = contexts[c];
+        if (ctx.error)
+          std::rethrow_exception(ctx.error);
+        first_start = std::min(first_start, ctx.start);
+        last_end = std::max(last_end, ctx.end);
+        latency.merge(ctx.latency);
+      }
+
+      double elapsedMicroSecs = std::chrono::duration<double, std::micro>(last_end - first_start).count();
+      long long tokens = tokens_per_run * it_max * count;
+      double rate = tokens * 1e6 / elapsedMicroSecs;
+      double noise_pct = calibration.noise_pct(elapsedMicroSecs / it_max);
+      if (context_counts.size() > 1 || count > 1)
+        std::cout << "Contexts: " << count << std::endl;
+      if (depths.size() > 1 || depth > 1)
+        std::cout << "Queue depth: " << depth << std::endl;
+      std::cout << "Average Time for TCT (us): " << elapsedMicroSecs / tokens << std::endl;
+      std::cout << (count > 1 ? "Aggregate TCT/s: " : "Average TCT/s: ") << std::fixed << std::setprecision(0) << rate
+                << std::defaultfloat << std::endl;
+      if (calibrate_ms)
+        std::cout << "Host noise floor: " << std::fixed << std::setprecision(3) << noise_pct << "%"
+                  << std::defaultfloat << std::endl;
+
+      // Scaling against the first context count of the list at this depth
+      if (!base_rate.count(depth))
+        base_rate[depth] = rate / count;
+      else
+        std::cout << "Scaling: " << std::fixed << std::setprecision(2) << rate / (base_rate[depth] * count) * 100
+                  << "% of linear" << std::defaultfloat << std::endl;
+      latency.print(std::cout, "Command latency");
+
+      std::string name = test;
+      if (context_counts.size() > 1)
+        name += "-ctx" + std::to_string(count);
+      if (depths.size() > 1)
+        name += "-qd" + std::to_string(depth);
+      histograms.emplace_back("tct_tp " + std::to_string(count) + " contexts depth " + std::to_string(depth),
+                              latency);
+      results.add(name, "TCT/s", rate, noise_pct);
+    }
+  }
+
+  // Every context must have looped back its own input
+  for (int c = 0; c < max_contexts; c++) {
+    auto &ctx = contexts[c];
+    ctx.out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto in_mapped = ctx.in.map<int*>();
+    auto out_mapped = ctx.out.map<int*>();
+    for (int i = 0; i < tnx_word_count; i++) {
+      if (out_mapped[i] != in_mapped[i])
+        throw std::runtime_error("Error: Output data mismatch in context " + std::to_string(c)
+                                 + "!\nTEST FAILED!\n");
+    }
+  }
+
+  if (timestamp_runs) {
+    unsigned int clock_mhz = clock_override;
+    if (!clock_mhz) {
+      try {
+        clock_mhz = vtd::make_device_control(device)->aie_clock_mhz();
+      }
+      catch (const std::exception &ex) {
+        std::cout << "Skipping device token timestamps, " << ex.what() << "Pass --clock-mhz to set the AIE clock\n";
+      }
+    }
+
+    if (clock_mhz) {
+      vtd::latency_histogram token_latency;
+      auto recorded = measure_token_latency(device, contexts[0], timestamp_runs, clock_mhz, token_latency);
+      if (!recorded)
+        std::cout << "No device token timestamps, the sequence records no timers" << std::endl;
+      else {
+        if (recorded != tokens_per_run)
+          std::cout << "WARNING: " << recorded << " token timestamps for " << tokens_per_run << " tokens per run"
+                    << std::endl;
+        token_latency.print(std::cout, "Device inter-token latency");
+        histograms.emplace_back("tct_tp inter-token", token_latency);
+      }
+    }
+  }
+
+  if (!histogram_json.empty())
+    vtd::write_histograms_json(histogram_json, histograms);
+  if (!results_json.empty()) {
+    vtd::set_result_device(results, device);
+    vtd::write_results_json(results_json, results);
   }
-  
-  auto device = xrt::device(index);
-  
-  std::vector<std::thread> threads;
-  for (int i = 0; i < num_thread; i++)
-    threads.emplace_back(std::thread(run_test_iterations, xclbinFileName, dpuSequenceFileName, std::ref(device), i));
-
-  for (auto& th : threads)
-    th.join();
 }
 
 int
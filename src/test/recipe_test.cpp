@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+/* Off-hardware checks of the recipe loader and engine, built with the mock
+ * XRT device and run by ctest:
+ *
+ *   recipe_test <archive/strx>
+ *
+ * Every archive recipe must load with one command per run entry and the
+ * buffer bindings it names, folded and unfolded alike.  Explicit repeat and
+ * count entries become command chains and are never folded, "chain": false
+ * and the error cases are honored, and the binary and templated JSON forms
+ * load back to the same recipe.  Finally the engine runs a few recipes on the
+ * mock and submits the expected number of commands.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// XRT includes
+#include "xrt/xrt_device.h"
+
+#include "json.h"
+#include "recipe.h"
+
+void
+check(bool condition, const std::string &what)
+{
+  if (!condition)
+    throw std::runtime_error("Error: " + what + "\n");
+}
+
+bool
+same_recipe(const vtd::recipe &a, const vtd::recipe &b)
+{
+  if (a.xclbin != b.xclbin || a.program != b.program || a.buffers.size() != b.buffers.size()
+      || a.kernels.size() != b.kernels.size() || a.runs.size() != b.runs.size())
+    return false;
+  for (size_t i = 0; i < a.buffers.size(); i++) {
+    if (a.buffers[i].name != b.buffers[i].name || a.buffers[i].type != b.buffers[i].type
+        || a.buffers[i].size != b.buffers[i].size)
+      return false;
+  }
+  for (size_t i = 0; i < a.kernels.size(); i++) {
+    if (a.kernels[i].name != b.kernels[i].name || a.kernels[i].instance != b.kernels[i].instance
+        || a.kernels[i].ctrlcode != b.kernels[i].ctrlcode)
+      return false;
+  }
+  for (size_t i = 0; i < a.runs.size(); i++) {
+    auto &x = a.runs[i];
+    auto &y = b.runs[i];
+    if (x.kernel != y.kernel || x.repeat != y.repeat || x.chain != y.chain || x.arguments.size() != y.arguments.size()
+        || x.constants.size() != y.constants.size())
+      return false;
+    for (size_t j = 0; j < x.arguments.size(); j++) {
+      if (x.arguments[j].buffer != y.arguments[j].buffer || x.arguments[j].argidx != y.arguments[j].argidx)
+        return false;
+    }
+    for (size_t j = 0; j < x.constants.size(); j++) {
+      if (x.constants[j].argidx != y.constants[j].argidx || x.constants[j].type != y.constants[j].type
+          || x.constants[j].value != y.constants[j].value)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Load 'fname' in every form and compare with what its JSON spells out
+void
+check_archive_recipe(const std::string &fname)
+{
+  auto doc = vtd::load_json(fname);
+  auto &entries = doc.at("execution").at("runs").as_array();
+
+  auto unfolded = vtd::load_recipe(fname, false);
+  check(unfolded.runs.size() == entries.size(), fname + ": unfolded load has " + std::to_string(unfolded.runs.size())
+                                                + " templates for " + std::to_string(entries.size()) + " entries");
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto &run = unfolded.runs[i];
+    auto &args = entries[i].at("arguments").as_array();
+    check(unfolded.kernels[run.kernel].name == entries[i].at("name").as_string(), fname + ": wrong kernel");
+    check(run.arguments.size() == args.size(), fname + ": wrong argument count");
+    for (size_t j = 0; j < args.size(); j++) {
+      check(unfolded.buffers[run.arguments[j].buffer].name == args[j].at("name").as_string()
+              && run.arguments[j].argidx == args[j].at("argidx").as_int(),
+            fname + ": wrong binding of argument " + std::to_string(j));
+    }
+  }
+
+  auto rcp = vtd::load_recipe(fname);
+  check(vtd::recipe_commands(rcp) == vtd::recipe_commands(unfolded), fname + ": folding changed the command count");
+  check(rcp.runs.size() <= unfolded.runs.size(), fname + ": folding added templates");
+  for (auto &run : rcp.runs)
+    check(!run.chain, fname + ": expanded entries must not be chained");
+
+  auto binary = std::filesystem::temp_directory_path() / "recipe_test.bin";
+  auto json = std::filesystem::temp_directory_path() / "recipe_test.json";
+  vtd::save_recipe(rcp, binary.string());
+  vtd::save_recipe_json(rcp, json.string());
+  auto from_binary = vtd::load_recipe(binary.string());
+  auto from_json = vtd::load_recipe(json.string());
+  std::filesystem::remove(binary);
+  std::filesystem::remove(json);
+
+  // Paths are stored absolute
+  auto expected = rcp;
+  if (!expected.xclbin.empty())
+    expected.xclbin = std::filesystem::absolute(expected.xclbin).string();
+  if (!expected.program.empty())
+    expected.program = std::filesystem::absolute(expected.program).string();
+  for (auto &kernel : expected.kernels) {
+    if (!kernel.ctrlcode.empty())
+      kernel.ctrlcode = std::filesystem::absolute(kernel.ctrlcode).string();
+  }
+  check(same_recipe(expected, from_binary), fname + ": binary round trip differs");
+  check(same_recipe(expected, from_json), fname + ": JSON round trip differs");
+}
+
+std::string
+write_recipe(const std::string &runs)
+{
+  auto fname = (std::filesystem::temp_directory_path() / "recipe_test_runs.json").string();
+  std::ofstream ofs(fname);
+  ofs << R"({ "version": "1.0", "header": { "xclbin": "validate.xclbin" },
+  "resources": { "buffers": [ { "name": "a", "size": 64 }, { "name": "b", "size": 64 } ],
+                 "kernels": [ { "name": "k1", "instance": "DPU" } ] },
+  "execution": { "runs": [ )" << runs << " ] } }\n";
+  return fname;
+}
+
+// Runs binding 'a' or 'b' to argument 3
+std::string
+entry(const std::string &buffer, const std::string &extra = "")
+{
+  return R"({ "name": "k1", )" + extra + R"( "arguments": [ { "name": ")" + buffer + R"(", "argidx": 3 } ] })";
+}
+
+bool
+load_fails(const std::string &runs)
+{
+  auto fname = write_recipe(runs);
+  try {
+    vtd::load_recipe(fname);
+  }
+  catch (const std::runtime_error&) {
+    std::filesystem::remove(fname);
+    return true;
+  }
+  std::filesystem::remove(fname);
+  return false;
+}
+
+void
+check_repeat_rules()
+{
+  auto load = [](const std::string &runs) {
+    auto fname = write_recipe(runs);
+    auto rcp = vtd::load_recipe(fname);
+    std::filesystem::remove(fname);
+    return rcp;
+  };
+
+  // Identical entries fold into one template that is not chained
+  auto rcp = load(entry("a") + "," + entry("a") + "," + entry("a") + "," + entry("b"));
+  check(rcp.runs.size() == 2 && rcp.runs[0].repeat == 3 && !rcp.runs[0].chain && rcp.runs[1].repeat == 1,
+        "identical entries are not folded into one template");
+
+  // Explicit counts chain and are kept apart from identical neighbours
+  rcp = load(entry("a", R"("repeat": 4,)") + "," + entry("a") + "," + entry("a", R"("count": 5,)"));
+  check(rcp.runs.size() == 3 && rcp.runs[0].repeat == 4 && rcp.runs[0].chain && rcp.runs[1].repeat == 1
+          && !rcp.runs[1].chain && rcp.runs[2].repeat == 5 && rcp.runs[2].chain,
+        "explicit repeat and count entries are not chained templates of their own");
+  check(vtd::recipe_commands(rcp) == 10, "wrong command count of repeated entries");
+
+  // Chained and folded templates survive both saved forms
+  auto binary = (std::filesystem::temp_directory_path() / "recipe_test_runs.bin").string();
+  vtd::save_recipe(rcp, binary);
+  auto from_binary = vtd::load_recipe(binary);
+  std::filesystem::remove(binary);
+  auto json = (std::filesystem::temp_directory_path() / "recipe_test_saved.json").string();
+  vtd::save_recipe_json(rcp, json);
+  auto from_json = vtd::load_recipe(json);
+  std::filesystem::remove(json);
+  rcp.xclbin = from_binary.xclbin;
+  check(same_recipe(rcp, from_binary) && same_recipe(rcp, from_json), "repeated templates do not round trip");
+
+  rcp = load(entry("a", R"("repeat": 4, "chain": false,)") + "," + entry("b", R"("repeat": 1,)"));
+  check(rcp.runs.size() == 2 && !rcp.runs[0].chain && !rcp.runs[1].chain,
+        "\"chain\": false or a repeat of 1 still makes a chain");
+
+  check(load_fails(entry("a", R"("repeat": 0,)")), "a repeat of 0 is accepted");
+  check(load_fails(entry("a", R"("repeat": 2, "count": 2,)")), "repeat together with count is accepted");
+  check(load_fails(entry("c")), "an unknown buffer is accepted");
+}
+
+// Commands the engine submits for 'iterations' passes over the recipe
+void
+check_engine(const xrt::device &device, const std::string &dir, const std::string &test, bool chain,
+             uint64_t commands)
+{
+  auto rcp = vtd::load_recipe(dir + "/" + test + "/recipe_" + test + ".json");
+  for (auto &run : rcp.runs)
+    run.chain = chain && run.repeat > 1;
+  auto prf = vtd::load_profile(dir + "/" + test + "/profile_" + test + ".json", rcp);
+  vtd::recipe_engine engine(device, rcp, prf, 4, 16);
+  auto result = engine.execute(2);
+  check(result.iterations == 2 && result.commands == 2 * commands && result.latency.count() == 2,
+        test + ": engine submitted " + std::to_string(result.commands) + " commands");
+}
+
+void
+run(int argc, char **argv)
+{
+  if (argc != 2)
+    throw std::runtime_error("Usage: " + std::string(argv[0]) + " <archive/strx>\n");
+  std::string dir = argv[1];
+
+  int recipes = 0;
+  for (auto &test : std::filesystem::directory_iterator(dir)) {
+    for (auto &file : std::filesystem::directory_iterator(test.path())) {
+      auto name = file.path().filename().string();
+      if (name.rfind("recipe_", 0) == 0 && file.path().extension() == ".json") {
+        check_archive_recipe(file.path().string());
+        recipes++;
+      }
+    }
+  }
+  check(recipes > 0, "no recipes under " + dir);
+  std::cout << "Loaded " << recipes << " archive recipes in every form\n";
+
+  auto throughput = vtd::load_recipe(dir + "/throughput/recipe_throughput.json");
+  check(throughput.runs.size() == 1 && throughput.runs[0].repeat == 9, "throughput is not 9 folded runs");
+  auto chain = vtd::load_recipe(dir + "/cmd_chain_throughput/recipe_cmd_chain_throughput.json");
+  check(chain.runs.size() == 1 && chain.runs[0].repeat == 1000, "cmd_chain_throughput is not 1000 folded runs");
+
+  check_repeat_rules();
+  std::cout << "Repeat, count and folding rules hold\n";
+
+  auto device = xrt::device(0);
+  check_engine(device, dir, "latency", false, 1);
+  check_engine(device, dir, "throughput", false, 9);
+  check_engine(device, dir, "cmd_chain_latency", true, 1000);
+  std::cout << "Engine submitted the expected commands\n";
+}
+
+int
+main(int argc, char **argv)
+{
+  try {
+    run(argc, argv);
+    std::cout << "TEST PASSED!\n";
+    return EXIT_SUCCESS;
+  } catch (const std::exception& ex) {
+    std::cout << ex.what() << '\n';
+  }
+
+  return EXIT_FAILURE;
+}